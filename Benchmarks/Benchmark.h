@@ -0,0 +1,282 @@
+// Benchmark.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_BENCHMARK_BENCHMARK_H_
+#define _IC_BENCHMARK_BENCHMARK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Prevents a function from being inlined, so that benchmarks measure the cost of a
+/// real call and return.
+///
+#if defined(__GNUC__) || defined(__clang__)
+#define IC_BENCHMARK_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define IC_BENCHMARK_NOINLINE __declspec(noinline)
+#else
+#define IC_BENCHMARK_NOINLINE
+#endif
+
+namespace IC
+{
+	namespace Benchmark
+	{
+		/// The allocation statistics for the current thread. These are updated by the
+		/// replacement global operator new which is defined at the bottom of this file.
+		///
+		struct AllocationCounters final
+		{
+			std::uint64_t m_allocations = 0;
+			std::uint64_t m_bytes = 0;
+		};
+
+		/// @return The allocation counters for the calling thread.
+		///
+		inline AllocationCounters& getAllocationCounters() noexcept
+		{
+			static thread_local AllocationCounters s_counters;
+			return s_counters;
+		}
+
+		/// The output of a single benchmark case. All values are averaged over the number
+		/// of iterations.
+		///
+		struct Measurement final
+		{
+			std::string m_name;
+			std::uint64_t m_iterations = 0;
+			double m_nsPerOp = 0.0;
+			double m_allocationsPerOp = 0.0;
+			double m_bytesPerOp = 0.0;
+		};
+
+		/// Prevents the compiler from optimising away the computation of the given value.
+		///
+		/// @param in_value - The value which should be considered used.
+		///
+		template <typename TValue> inline void doNotOptimise(const TValue& in_value) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			asm volatile("" : : "g"(&in_value) : "memory");
+#else
+			static volatile const void* s_sink;
+			s_sink = &in_value;
+#endif
+		}
+
+		/// Runs the given function the requested number of times, measuring the time taken
+		/// and the number of allocations made on the calling thread.
+		///
+		/// @param in_name - The name of the benchmark case.
+		/// @param in_iterations - The number of times the function should be called.
+		/// @param in_function - The function to benchmark. This is passed the iteration index.
+		///
+		/// @return The measurement.
+		///
+		template <typename TFunction> Measurement measure(const std::string& in_name, std::uint64_t in_iterations, TFunction&& in_function) noexcept
+		{
+			auto& counters = getAllocationCounters();
+			auto allocationsBefore = counters.m_allocations;
+			auto bytesBefore = counters.m_bytes;
+			auto start = std::chrono::steady_clock::now();
+
+			for (std::uint64_t i = 0; i < in_iterations; ++i)
+			{
+				in_function(i);
+			}
+
+			auto end = std::chrono::steady_clock::now();
+			auto allocations = counters.m_allocations - allocationsBefore;
+			auto bytes = counters.m_bytes - bytesBefore;
+
+			Measurement measurement;
+			measurement.m_name = in_name;
+			measurement.m_iterations = in_iterations;
+			measurement.m_nsPerOp = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / double(in_iterations);
+			measurement.m_allocationsPerOp = double(allocations) / double(in_iterations);
+			measurement.m_bytesPerOp = double(bytes) / double(in_iterations);
+			return measurement;
+		}
+
+		/// Runs the given function on the requested number of threads at once, each
+		/// calling it the requested number of times. The time is measured from when all
+		/// threads start to when the last finishes, and allocations made by every thread
+		/// are counted. The per op values are averaged over the total number of calls.
+		///
+		/// @param in_name - The name of the benchmark case.
+		/// @param in_threads - The number of threads to run.
+		/// @param in_iterations - The number of times each thread should call the function.
+		/// @param in_function - The function to benchmark. This is passed the iteration index.
+		///
+		/// @return The measurement.
+		///
+		template <typename TFunction> Measurement measureThreads(const std::string& in_name, std::uint32_t in_threads, std::uint64_t in_iterations, TFunction&& in_function) noexcept
+		{
+			std::atomic<std::uint32_t> ready(0);
+			std::atomic<bool> start(false);
+			std::atomic<std::uint64_t> allocations(0);
+			std::atomic<std::uint64_t> bytes(0);
+
+			std::vector<std::thread> threads;
+			threads.reserve(in_threads);
+			for (std::uint32_t thread = 0; thread < in_threads; ++thread)
+			{
+				threads.emplace_back([&]()
+				{
+					auto& counters = getAllocationCounters();
+					auto allocationsBefore = counters.m_allocations;
+					auto bytesBefore = counters.m_bytes;
+
+					ready.fetch_add(1);
+					while (!start.load(std::memory_order_acquire))
+					{
+						std::this_thread::yield();
+					}
+
+					for (std::uint64_t i = 0; i < in_iterations; ++i)
+					{
+						in_function(i);
+					}
+
+					allocations.fetch_add(counters.m_allocations - allocationsBefore);
+					bytes.fetch_add(counters.m_bytes - bytesBefore);
+				});
+			}
+
+			while (ready.load() != in_threads)
+			{
+				std::this_thread::yield();
+			}
+
+			auto startTime = std::chrono::steady_clock::now();
+			start.store(true, std::memory_order_release);
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+			auto endTime = std::chrono::steady_clock::now();
+
+			auto totalIterations = in_iterations * in_threads;
+
+			Measurement measurement;
+			measurement.m_name = in_name;
+			measurement.m_iterations = totalIterations;
+			measurement.m_nsPerOp = double(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count()) / double(totalIterations);
+			measurement.m_allocationsPerOp = double(allocations.load()) / double(totalIterations);
+			measurement.m_bytesPerOp = double(bytes.load()) / double(totalIterations);
+			return measurement;
+		}
+
+		/// Prints the measurement to stdout as a single line of JSON.
+		///
+		/// @param in_measurement - The measurement to print.
+		///
+		inline void report(const Measurement& in_measurement) noexcept
+		{
+			std::printf("{\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, \"allocations_per_op\": %.3f, \"bytes_per_op\": %.3f}\n",
+				in_measurement.m_name.c_str(), static_cast<unsigned long long>(in_measurement.m_iterations), in_measurement.m_nsPerOp,
+				in_measurement.m_allocationsPerOp, in_measurement.m_bytesPerOp);
+		}
+
+		/// Prints a single named value to stdout as a line of JSON. This is used for
+		/// measurements which aren't timed, such as type sizes.
+		///
+		/// @param in_name - The name of the benchmark case.
+		/// @param in_key - The name of the value.
+		/// @param in_value - The value.
+		///
+		inline void reportValue(const std::string& in_name, const std::string& in_key, std::uint64_t in_value) noexcept
+		{
+			std::printf("{\"name\": \"%s\", \"%s\": %llu}\n", in_name.c_str(), in_key.c_str(), static_cast<unsigned long long>(in_value));
+		}
+	}
+}
+
+// The replacement global allocation functions used to count allocations. As these are
+// replacements they cannot be inline, so this header must be included in exactly one
+// translation unit per benchmark executable.
+
+//-----------------------------------------------------------------------------
+void* operator new(std::size_t in_size)
+{
+	auto& counters = IC::Benchmark::getAllocationCounters();
+	++counters.m_allocations;
+	counters.m_bytes += in_size;
+
+	if (auto memory = std::malloc(in_size == 0 ? 1 : in_size))
+	{
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+//-----------------------------------------------------------------------------
+void* operator new[](std::size_t in_size)
+{
+	return ::operator new(in_size);
+}
+
+//-----------------------------------------------------------------------------
+void* operator new(std::size_t in_size, const std::nothrow_t&) noexcept
+{
+	auto& counters = IC::Benchmark::getAllocationCounters();
+	++counters.m_allocations;
+	counters.m_bytes += in_size;
+
+	return std::malloc(in_size == 0 ? 1 : in_size);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete(void* in_memory) noexcept
+{
+	std::free(in_memory);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete[](void* in_memory) noexcept
+{
+	std::free(in_memory);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete(void* in_memory, std::size_t) noexcept
+{
+	std::free(in_memory);
+}
+
+//-----------------------------------------------------------------------------
+void operator delete[](void* in_memory, std::size_t) noexcept
+{
+	std::free(in_memory);
+}
+
+#endif
@@ -0,0 +1,235 @@
+// CodeSizeBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Reports the bytes of machine code added to the calling function by each use of a
+// Result, compared with returning an error code. Each case is compiled into two
+// functions, one with a single call site and one with nine, and each function is placed
+// in its own section so that its size can be read from the section bounds provided by
+// the linker. The size per call site is the difference divided by eight, so it includes
+// everything which was inlined at the call site, but not the out of line failure paths.
+//
+// This requires GCC or Clang and an ELF target; elsewhere nothing is reported.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -DNDEBUG -I.. CodeSizeBenchmark.cpp -o CodeSizeBenchmark
+//     ./CodeSizeBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__ELF__)
+#define IC_CODE_SIZE_SUPPORTED 1
+
+/// Declares a function with the given number of call sites, in a section of its own, and
+/// the linker provided symbols which mark the bounds of that section.
+///
+#define IC_CODE_SIZE_FUNCTION(in_section) \
+	extern "C" const char __start_##in_section[]; \
+	extern "C" const char __stop_##in_section[]; \
+	__attribute__((noinline, section(#in_section)))
+
+/// @return The size of the given section in bytes.
+///
+#define IC_CODE_SIZE_OF(in_section) (static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(__stop_##in_section) - reinterpret_cast<std::uintptr_t>(__start_##in_section)))
+
+/// Forces a call site to be inlined into the measured function.
+///
+#define IC_CODE_SIZE_INLINE inline __attribute__((always_inline))
+#else
+#define IC_CODE_SIZE_INLINE inline
+#endif
+
+namespace
+{
+	enum class LookupError
+	{
+		k_success,
+		k_notFound
+	};
+
+	using LookupResult = IC::Result<int, LookupError>;
+
+	constexpr int k_callSites = 9;
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LookupResult lookup(int in_key) noexcept
+	{
+		if (in_key < 0)
+		{
+			return LookupResult(LookupError::k_notFound, IC::StaticMessage("The key was not found."));
+		}
+		return in_key * 2;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE bool lookupCode(int in_key, int& out_value) noexcept
+	{
+		if (in_key < 0)
+		{
+			return false;
+		}
+		out_value = in_key * 2;
+		return true;
+	}
+
+	/// Each of these is a single call site, which is inlined as many times as needed into
+	/// the measured functions below.
+	///
+	struct ErrorCodeCase final
+	{
+		//-----------------------------------------------------------------------------
+		static IC_CODE_SIZE_INLINE int run(const int* in_keys, int in_index) noexcept
+		{
+			int value;
+			return lookupCode(in_keys[in_index], value) ? value : 0;
+		}
+	};
+
+	//-----------------------------------------------------------------------------
+	struct CheckCase final
+	{
+		static IC_CODE_SIZE_INLINE int run(const int* in_keys, int in_index) noexcept
+		{
+			auto result = lookup(in_keys[in_index]);
+			return result ? result.getValue() : 0;
+		}
+	};
+
+	//-----------------------------------------------------------------------------
+	struct FailCase final
+	{
+		static IC_CODE_SIZE_INLINE LookupResult run(const int* in_keys, int in_index) noexcept
+		{
+			if (in_keys[in_index] < 0)
+			{
+				return LookupResult(LookupError::k_notFound, "A key was negative.");
+			}
+			return in_keys[in_index];
+		}
+	};
+
+	//-----------------------------------------------------------------------------
+	struct WrapCase final
+	{
+		static IC_CODE_SIZE_INLINE LookupResult run(const int* in_keys, int in_index) noexcept
+		{
+			auto result = lookup(in_keys[in_index]);
+			if (!result)
+			{
+				return LookupResult(LookupError::k_notFound, IC::StaticMessage("The lookup failed."), result);
+			}
+			return result.getValue();
+		}
+	};
+
+	//-----------------------------------------------------------------------------
+	struct CopyCase final
+	{
+		static IC_CODE_SIZE_INLINE int run(const LookupResult* in_results, int in_index) noexcept
+		{
+			auto copy = in_results[in_index];
+			return copy ? copy.getValue() : 0;
+		}
+	};
+
+	//-----------------------------------------------------------------------------
+	struct RenderCase final
+	{
+		static IC_CODE_SIZE_INLINE int run(const LookupResult* in_results, int in_index) noexcept
+		{
+			return in_results[in_index] ? 0 : int(in_results[in_index].getFullErrorMessage().size());
+		}
+	};
+
+	/// Runs a single call site of the given case. Results are converted to bool here, so
+	/// that each is destroyed before the next call site, and so that a failure case
+	/// measures both the construction and destruction of the failure.
+	///
+	template <typename TCase, typename TInput> IC_CODE_SIZE_INLINE int runCallSite(const TInput* in_inputs, int in_index) noexcept
+	{
+		return TCase::run(in_inputs, in_index) ? 1 : 0;
+	}
+
+	/// Sums the given case over one input per index.
+	///
+	template <typename TCase, typename TInput, int... TIndices> IC_CODE_SIZE_INLINE int sumCallSites(const TInput* in_inputs, std::integer_sequence<int, TIndices...>) noexcept
+	{
+		return (0 + ... + runCallSite<TCase>(in_inputs, TIndices));
+	}
+}
+
+#ifdef IC_CODE_SIZE_SUPPORTED
+#define IC_CODE_SIZE_CASE(in_name, in_case, in_input) \
+	IC_CODE_SIZE_FUNCTION(ic_size_##in_name##_1) int in_name##One(const in_input* in_inputs) noexcept \
+	{ \
+		return sumCallSites<in_case>(in_inputs, std::make_integer_sequence<int, 1>()); \
+	} \
+	IC_CODE_SIZE_FUNCTION(ic_size_##in_name##_n) int in_name##Many(const in_input* in_inputs) noexcept \
+	{ \
+		return sumCallSites<in_case>(in_inputs, std::make_integer_sequence<int, k_callSites>()); \
+	}
+
+IC_CODE_SIZE_CASE(errorCode, ErrorCodeCase, int)
+IC_CODE_SIZE_CASE(check, CheckCase, int)
+IC_CODE_SIZE_CASE(fail, FailCase, int)
+IC_CODE_SIZE_CASE(wrap, WrapCase, int)
+IC_CODE_SIZE_CASE(copy, CopyCase, LookupResult)
+IC_CODE_SIZE_CASE(render, RenderCase, LookupResult)
+
+// Reports the bytes per call site for the given case.
+#define IC_CODE_SIZE_REPORT(in_name, in_inputs) \
+	IC::Benchmark::doNotOptimise(in_name##One(in_inputs) + in_name##Many(in_inputs)); \
+	IC::Benchmark::reportValue("code_size/" #in_name, "text_bytes_per_call_site", (IC_CODE_SIZE_OF(ic_size_##in_name##_n) - IC_CODE_SIZE_OF(ic_size_##in_name##_1)) / (k_callSites - 1))
+#endif
+
+int main()
+{
+#ifdef IC_CODE_SIZE_SUPPORTED
+	int keys[k_callSites];
+	LookupResult results[k_callSites] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+	for (int i = 0; i < k_callSites; ++i)
+	{
+		keys[i] = i % 2 == 0 ? i : -i;
+		if (i % 2 != 0)
+		{
+			results[i] = lookup(-1);
+		}
+	}
+
+	IC_CODE_SIZE_REPORT(errorCode, keys);
+	IC_CODE_SIZE_REPORT(check, keys);
+	IC_CODE_SIZE_REPORT(fail, keys);
+	IC_CODE_SIZE_REPORT(wrap, keys);
+	IC_CODE_SIZE_REPORT(copy, results);
+	IC_CODE_SIZE_REPORT(render, results);
+#endif
+
+	return 0;
+}
@@ -0,0 +1,378 @@
+// ComparisonBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Compares Result, BoolResult, Error and BoolError with the common alternatives: hand
+// written error codes, std::optional and exceptions. Every mechanism performs the same
+// lookup through a number of nested calls, and the failure ratio, the depth of the
+// calls, the size of the value and the number of threads are varied. Results add a cause
+// at every level of the call chain, while error codes, optionals and exceptions simply
+// propagate the failure.
+//
+// Each case is printed as a line of JSON named:
+//
+//     compare/<mechanism>/value:<size>/failure:<percent>/depth:<depth>/threads:<threads>
+//
+// A filter can be passed as the first argument, in which case only cases whose name
+// contains it are run.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -pthread -I.. ComparisonBenchmark.cpp -o ComparisonBenchmark
+//     ./ComparisonBenchmark [filter]
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+	enum class LookupError
+	{
+		k_success,
+		k_notFound,
+		k_failed
+	};
+
+	/// A value which fits in a register.
+	///
+	using SmallValue = std::uint32_t;
+
+	/// A value which is returned through memory.
+	///
+	struct LargeValue final
+	{
+		std::uint64_t m_data[32];
+	};
+
+	/// The exception thrown when a lookup fails.
+	///
+	class LookupException final : public std::runtime_error
+	{
+	public:
+		explicit LookupException(std::uint64_t in_key)
+			: std::runtime_error("Key " + std::to_string(in_key) + " was not found.")
+		{
+		}
+	};
+
+	/// The number of levels of calls made by a case, and the ratio of calls which fail.
+	///
+	struct Scenario final
+	{
+		std::size_t m_depth;
+		std::uint32_t m_failurePercent;
+	};
+
+	//-----------------------------------------------------------------------------
+	bool shouldFail(const Scenario& in_scenario, std::uint64_t in_key) noexcept
+	{
+		return in_key % 100 < in_scenario.m_failurePercent;
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue> TValue makeValue(std::uint64_t in_key) noexcept;
+
+	//-----------------------------------------------------------------------------
+	template <> SmallValue makeValue<SmallValue>(std::uint64_t in_key) noexcept
+	{
+		return SmallValue(in_key);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <> LargeValue makeValue<LargeValue>(std::uint64_t in_key) noexcept
+	{
+		LargeValue value;
+		std::fill(std::begin(value.m_data), std::end(value.m_data), in_key);
+		return value;
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess> IC_BENCHMARK_NOINLINE IC::Result<TValue, TError, TErrorSuccess> resultLookup(const Scenario& in_scenario, std::size_t in_depth, std::uint64_t in_key) noexcept
+	{
+		using ResultType = IC::Result<TValue, TError, TErrorSuccess>;
+		constexpr TError k_failure = TError(!bool(TErrorSuccess));
+
+		if (in_depth == 0)
+		{
+			if (shouldFail(in_scenario, in_key))
+			{
+				return ResultType(k_failure, IC::deferMessage("Key {} was not found.", in_key));
+			}
+			if constexpr (std::is_void<TValue>::value)
+			{
+				return ResultType();
+			}
+			else
+			{
+				return ResultType(makeValue<TValue>(in_key));
+			}
+		}
+
+		auto result = resultLookup<TValue, TError, TErrorSuccess>(in_scenario, in_depth - 1, in_key);
+		if (!result)
+		{
+			return ResultType(k_failure, IC::StaticMessage("The lookup failed."), result);
+		}
+		return result;
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue> IC_BENCHMARK_NOINLINE LookupError codeLookup(const Scenario& in_scenario, std::size_t in_depth, std::uint64_t in_key, TValue& out_value) noexcept
+	{
+		if (in_depth == 0)
+		{
+			if (shouldFail(in_scenario, in_key))
+			{
+				return LookupError::k_notFound;
+			}
+			out_value = makeValue<TValue>(in_key);
+			return LookupError::k_success;
+		}
+
+		auto error = codeLookup(in_scenario, in_depth - 1, in_key, out_value);
+		if (error != LookupError::k_success)
+		{
+			return LookupError::k_failed;
+		}
+		return LookupError::k_success;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LookupError codeCheck(const Scenario& in_scenario, std::size_t in_depth, std::uint64_t in_key) noexcept
+	{
+		if (in_depth == 0)
+		{
+			return shouldFail(in_scenario, in_key) ? LookupError::k_notFound : LookupError::k_success;
+		}
+
+		auto error = codeCheck(in_scenario, in_depth - 1, in_key);
+		if (error != LookupError::k_success)
+		{
+			return LookupError::k_failed;
+		}
+		return LookupError::k_success;
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue> IC_BENCHMARK_NOINLINE std::optional<TValue> optionalLookup(const Scenario& in_scenario, std::size_t in_depth, std::uint64_t in_key) noexcept
+	{
+		if (in_depth == 0)
+		{
+			if (shouldFail(in_scenario, in_key))
+			{
+				return std::nullopt;
+			}
+			return makeValue<TValue>(in_key);
+		}
+
+		auto value = optionalLookup<TValue>(in_scenario, in_depth - 1, in_key);
+		if (!value)
+		{
+			return std::nullopt;
+		}
+		return value;
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue> IC_BENCHMARK_NOINLINE TValue throwingLookup(const Scenario& in_scenario, std::size_t in_depth, std::uint64_t in_key)
+	{
+		if (in_depth == 0)
+		{
+			if (shouldFail(in_scenario, in_key))
+			{
+				throw LookupException(in_key);
+			}
+			return makeValue<TValue>(in_key);
+		}
+
+		auto value = throwingLookup<TValue>(in_scenario, in_depth - 1, in_key);
+		IC::Benchmark::doNotOptimise(value);
+		return value;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE void throwingCheck(const Scenario& in_scenario, std::size_t in_depth, std::uint64_t in_key)
+	{
+		if (in_depth == 0)
+		{
+			if (shouldFail(in_scenario, in_key))
+			{
+				throw LookupException(in_key);
+			}
+			return;
+		}
+
+		throwingCheck(in_scenario, in_depth - 1, in_key);
+		IC::Benchmark::doNotOptimise(in_key);
+	}
+
+	/// Runs a case on the given number of threads and reports it, unless it is excluded
+	/// by the filter.
+	///
+	class CaseRunner final
+	{
+	public:
+		explicit CaseRunner(std::string in_filter) noexcept
+			: m_filter(std::move(in_filter))
+		{
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TFunction> void run(const std::string& in_mechanism, const std::string& in_valueSize, const Scenario& in_scenario, std::uint32_t in_threads, TFunction&& in_function) noexcept
+		{
+			auto name = "compare/" + in_mechanism + "/value:" + in_valueSize + "/failure:" + std::to_string(in_scenario.m_failurePercent) +
+				"/depth:" + std::to_string(in_scenario.m_depth) + "/threads:" + std::to_string(in_threads);
+			if (name.find(m_filter) == std::string::npos)
+			{
+				return;
+			}
+
+			std::uint64_t iterations = std::max<std::uint64_t>(2000, 1000000 / (in_scenario.m_depth + 1));
+			if (in_mechanism == "exception" && in_scenario.m_failurePercent >= 10)
+			{
+				iterations = std::max<std::uint64_t>(1000, iterations / 10);
+			}
+
+			if (in_threads == 1)
+			{
+				IC::Benchmark::report(IC::Benchmark::measure(name, iterations, in_function));
+			}
+			else
+			{
+				IC::Benchmark::report(IC::Benchmark::measureThreads(name, in_threads, iterations / in_threads, in_function));
+			}
+		}
+
+	private:
+		std::string m_filter;
+	};
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue> void runValueCases(CaseRunner& in_runner, const std::string& in_valueSize, const Scenario& in_scenario, std::uint32_t in_threads) noexcept
+	{
+		in_runner.run("Result", in_valueSize, in_scenario, in_threads, [&in_scenario](std::uint64_t in_key)
+		{
+			auto result = resultLookup<TValue, LookupError, LookupError::k_success>(in_scenario, in_scenario.m_depth, in_key);
+			IC::Benchmark::doNotOptimise(result);
+		});
+
+		in_runner.run("BoolResult", in_valueSize, in_scenario, in_threads, [&in_scenario](std::uint64_t in_key)
+		{
+			auto result = resultLookup<TValue, bool, true>(in_scenario, in_scenario.m_depth, in_key);
+			IC::Benchmark::doNotOptimise(result);
+		});
+
+		in_runner.run("error_code", in_valueSize, in_scenario, in_threads, [&in_scenario](std::uint64_t in_key)
+		{
+			TValue value;
+			auto error = codeLookup(in_scenario, in_scenario.m_depth, in_key, value);
+			IC::Benchmark::doNotOptimise(error);
+			IC::Benchmark::doNotOptimise(value);
+		});
+
+		in_runner.run("optional", in_valueSize, in_scenario, in_threads, [&in_scenario](std::uint64_t in_key)
+		{
+			auto value = optionalLookup<TValue>(in_scenario, in_scenario.m_depth, in_key);
+			IC::Benchmark::doNotOptimise(value);
+		});
+
+		in_runner.run("exception", in_valueSize, in_scenario, in_threads, [&in_scenario](std::uint64_t in_key)
+		{
+			try
+			{
+				auto value = throwingLookup<TValue>(in_scenario, in_scenario.m_depth, in_key);
+				IC::Benchmark::doNotOptimise(value);
+			}
+			catch (const LookupException& in_exception)
+			{
+				IC::Benchmark::doNotOptimise(in_exception.what());
+			}
+		});
+	}
+
+	//-----------------------------------------------------------------------------
+	void runNoValueCases(CaseRunner& in_runner, const Scenario& in_scenario, std::uint32_t in_threads) noexcept
+	{
+		in_runner.run("Error", "none", in_scenario, in_threads, [&in_scenario](std::uint64_t in_key)
+		{
+			auto result = resultLookup<void, LookupError, LookupError::k_success>(in_scenario, in_scenario.m_depth, in_key);
+			IC::Benchmark::doNotOptimise(result);
+		});
+
+		in_runner.run("BoolError", "none", in_scenario, in_threads, [&in_scenario](std::uint64_t in_key)
+		{
+			auto result = resultLookup<void, bool, true>(in_scenario, in_scenario.m_depth, in_key);
+			IC::Benchmark::doNotOptimise(result);
+		});
+
+		in_runner.run("error_code", "none", in_scenario, in_threads, [&in_scenario](std::uint64_t in_key)
+		{
+			auto error = codeCheck(in_scenario, in_scenario.m_depth, in_key);
+			IC::Benchmark::doNotOptimise(error);
+		});
+
+		in_runner.run("exception", "none", in_scenario, in_threads, [&in_scenario](std::uint64_t in_key)
+		{
+			try
+			{
+				throwingCheck(in_scenario, in_scenario.m_depth, in_key);
+			}
+			catch (const LookupException& in_exception)
+			{
+				IC::Benchmark::doNotOptimise(in_exception.what());
+			}
+		});
+	}
+}
+
+int main(int in_argc, char** in_argv)
+{
+	CaseRunner runner(in_argc > 1 ? in_argv[1] : "");
+
+	const std::uint32_t k_threadCounts[] = { 1, std::max(2u, std::thread::hardware_concurrency()) };
+	const std::uint32_t k_failurePercents[] = { 0, 1, 10, 100 };
+	const std::size_t k_depths[] = { 0, 1, 8, 32, 128 };
+
+	for (auto threads : k_threadCounts)
+	{
+		for (auto failurePercent : k_failurePercents)
+		{
+			for (auto depth : k_depths)
+			{
+				Scenario scenario{ depth, failurePercent };
+				runValueCases<SmallValue>(runner, "small", scenario, threads);
+				runValueCases<LargeValue>(runner, "large", scenario, threads);
+				runNoValueCases(runner, scenario, threads);
+			}
+		}
+	}
+
+	return 0;
+}
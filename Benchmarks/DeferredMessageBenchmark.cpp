@@ -0,0 +1,157 @@
+// DeferredMessageBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures the "fail, then handle silently" path, where a failure is created and then
+// handled without the message ever being read. An eagerly formatted message is compared
+// against a deferred message. The cost of reading a deferred message is also measured.
+//
+// Both kinds of message allocate one error node per failure. Nodes come from the error
+// node pool, which the global allocation counts don't see once it is warm, so the
+// number of nodes allocated is also reported for each case. The benchmark exits with a
+// failure code if a deferred failure allocates anything other than its node.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. DeferredMessageBenchmark.cpp -o DeferredMessageBenchmark
+//     ./DeferredMessageBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	/// An error node allocator which counts the nodes allocated from the pool.
+	///
+	struct CountingErrorAllocator final
+	{
+		static std::uint64_t s_allocations;
+
+		/// @param in_size - The number of bytes to allocate.
+		///
+		/// @return The allocated memory, or null if it couldn't be allocated.
+		///
+		static void* allocate(std::size_t in_size) noexcept
+		{
+			++s_allocations;
+			return IC::PoolErrorAllocator::allocate(in_size);
+		}
+
+		/// @param in_memory - The memory to free.
+		/// @param in_size - The size that was passed to allocate().
+		///
+		static void deallocate(void* in_memory, std::size_t in_size) noexcept
+		{
+			IC::PoolErrorAllocator::deallocate(in_memory, in_size);
+		}
+	};
+
+	std::uint64_t CountingErrorAllocator::s_allocations = 0;
+
+	/// The default policy, with error node allocations counted.
+	///
+	struct CountingPolicy : IC::DefaultResultPolicy
+	{
+		using Allocator = CountingErrorAllocator;
+	};
+
+	using LookupResult = IC::BoolResult<int, CountingPolicy>;
+
+	const std::string k_path = "/var/lib/service/registry/primary.db";
+	const std::uint64_t k_iterations = 2000000;
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LookupResult lookupEager(std::uint64_t in_key) noexcept
+	{
+		return LookupResult(false, "Key " + std::to_string(in_key) + " was not found in '" + k_path + "'.");
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LookupResult lookupDeferred(std::uint64_t in_key) noexcept
+	{
+		return LookupResult(false, IC::deferMessage("Key {} was not found in '{}'.", in_key, k_path.c_str()));
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TFunction> int lookupOrDefault(TFunction in_lookup, std::uint64_t in_key) noexcept
+	{
+		auto result = in_lookup(in_key);
+		return result ? result.getValue() : -1;
+	}
+
+	/// Measures and reports the given case, along with the number of error nodes it
+	/// allocated per op.
+	///
+	/// @param in_name - The name of the benchmark case.
+	/// @param in_function - The function to benchmark. This is passed the iteration index.
+	///
+	/// @return The measurement.
+	///
+	template <typename TFunction> IC::Benchmark::Measurement measureNodes(const std::string& in_name, TFunction&& in_function) noexcept
+	{
+		auto nodesBefore = CountingErrorAllocator::s_allocations;
+		auto measurement = IC::Benchmark::measure(in_name, k_iterations, in_function);
+		IC::Benchmark::report(measurement);
+		IC::Benchmark::reportValue(in_name, "error_nodes_per_op", (CountingErrorAllocator::s_allocations - nodesBefore) / k_iterations);
+		return measurement;
+	}
+}
+
+int main()
+{
+	int exitCode = 0;
+
+	measureNodes("handle-silently/eager", [](std::uint64_t in_index)
+	{
+		IC::Benchmark::doNotOptimise(lookupOrDefault(lookupEager, in_index));
+	});
+
+	auto nodesBefore = CountingErrorAllocator::s_allocations;
+	auto deferred = measureNodes("handle-silently/deferred", [](std::uint64_t in_index)
+	{
+		IC::Benchmark::doNotOptimise(lookupOrDefault(lookupDeferred, in_index));
+	});
+	if (CountingErrorAllocator::s_allocations - nodesBefore != k_iterations || deferred.m_allocationsPerOp != 0.0)
+	{
+		std::fprintf(stderr, "Expected each deferred failure to allocate only its error node, from the pool.\n");
+		exitCode = 1;
+	}
+
+	measureNodes("read-message/eager", [](std::uint64_t in_index)
+	{
+		auto result = lookupEager(in_index);
+		IC::Benchmark::doNotOptimise(result.getErrorMessage().size());
+	});
+
+	measureNodes("read-message/deferred", [](std::uint64_t in_index)
+	{
+		auto result = lookupDeferred(in_index);
+		IC::Benchmark::doNotOptimise(result.getErrorMessage().size());
+	});
+
+	return exitCode;
+}
@@ -0,0 +1,165 @@
+// ErrorAggregatorBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures fingerprinting and aggregating a flood of repeated failures, compared with
+// rendering the full error message of each one. Fingerprinting, and recording a repeat
+// of a failure already seen in the window, must make no allocation; this is checked, as
+// are the fingerprints and counts produced, including that failures with different
+// dynamic messages are kept apart, and the benchmark exits with a failure code if any
+// don't hold.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -pthread -I.. ErrorAggregatorBenchmark.cpp -o ErrorAggregatorBenchmark
+//     ./ErrorAggregatorBenchmark
+
+#include "Benchmark.h"
+#include "../ErrorAggregator.h"
+#include "../Result.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace
+{
+	constexpr std::size_t k_depth = 8;
+	constexpr std::uint64_t k_iterations = 2000000;
+	constexpr std::uint64_t k_threadIterations = 1000000;
+
+	/// @param in_error - The error at the bottom of the chain.
+	/// @param in_key - The key which couldn't be found, which differs between repeats.
+	///
+	/// @return A chain of the requested depth describing a failed lookup.
+	///
+	IC::Error<int> makeChain(int in_error, std::uint64_t in_key) noexcept
+	{
+		IC::Error<int> error(in_error, IC::deferMessage("Key {} was not found.", in_key));
+		for (std::size_t i = 1; i < k_depth; ++i)
+		{
+			error = IC::Error<int>(1, IC::deferMessage("Could not complete step {} of the request.", i), error);
+		}
+		return error;
+	}
+
+	/// Checks a condition, printing the message if it doesn't hold.
+	///
+	/// @return The condition.
+	///
+	bool check(bool in_condition, const char* in_message) noexcept
+	{
+		if (!in_condition)
+		{
+			std::fprintf(stderr, "%s\n", in_message);
+		}
+		return in_condition;
+	}
+}
+
+int main()
+{
+	bool passed = true;
+
+	auto chain = makeChain(2, 0);
+	auto fingerprint = IC::Benchmark::measure("fingerprint/depth:8", k_iterations, [&chain](std::uint64_t)
+	{
+		IC::Benchmark::doNotOptimise(chain.getFingerprint());
+	});
+	IC::Benchmark::report(fingerprint);
+	passed &= check(fingerprint.m_allocationsPerOp == 0.0, "Fingerprinting should not allocate.");
+
+	IC::Benchmark::report(IC::Benchmark::measure("render/depth:8", k_iterations, [&chain](std::uint64_t)
+	{
+		IC::Benchmark::doNotOptimise(chain.getFullErrorMessage());
+	}));
+
+	IC::ErrorAggregator aggregator;
+	aggregator.record(chain);
+	auto repeat = IC::Benchmark::measure("record/repeat/depth:8", k_iterations, [&aggregator, &chain](std::uint64_t)
+	{
+		IC::Benchmark::doNotOptimise(aggregator.record(chain));
+	});
+	IC::Benchmark::report(repeat);
+	passed &= check(repeat.m_allocationsPerOp == 0.0, "Recording a repeated failure should not allocate.");
+
+	auto window = aggregator.flush();
+	passed &= check(window.m_errors.size() == 1 && window.m_errors[0].m_count == k_iterations + 1, "Every repeat should be counted against one fingerprint.");
+
+	auto threads = std::max(2u, std::thread::hardware_concurrency());
+	std::vector<IC::Error<int>> chains;
+	for (std::uint32_t thread = 0; thread < threads; ++thread)
+	{
+		chains.push_back(makeChain(2 + static_cast<int>(thread), thread));
+	}
+
+	IC::Benchmark::report(IC::Benchmark::measureThreads("record/repeat/depth:8/threads:" + std::to_string(threads), threads, k_threadIterations, [&aggregator, &chain](std::uint64_t)
+	{
+		IC::Benchmark::doNotOptimise(aggregator.record(chain));
+	}));
+
+	window = aggregator.flush();
+	passed &= check(window.m_errors.size() == 1 && window.m_errors[0].m_count == threads * k_threadIterations, "Repeats from every thread should be counted against one fingerprint.");
+
+	std::atomic<std::uint32_t> nextThread(0);
+	IC::Benchmark::report(IC::Benchmark::measureThreads("record/distinct/depth:8/threads:" + std::to_string(threads), threads, k_threadIterations, [&aggregator, &chains, &nextThread](std::uint64_t in_index)
+	{
+		static thread_local std::uint32_t s_thread = 0;
+		if (in_index == 0)
+		{
+			s_thread = nextThread.fetch_add(1);
+		}
+		IC::Benchmark::doNotOptimise(aggregator.record(chains[s_thread]));
+	}));
+
+	window = aggregator.flush();
+	passed &= check(window.m_errors.size() == threads, "Each thread's failure should have its own fingerprint.");
+	for (auto& error : window.m_errors)
+	{
+		passed &= check(error.m_count == k_threadIterations, "Each thread's failures should be counted separately.");
+	}
+
+	passed &= check(makeChain(2, 1).getFingerprint() == makeChain(2, 2).getFingerprint(), "Repeats with different arguments should have the same fingerprint.");
+	passed &= check(makeChain(2, 1).getFingerprint() != makeChain(3, 1).getFingerprint(), "Failures with different errors should have different fingerprints.");
+	passed &= check(chain.getFingerprint() == chain.shareError()->getFingerprint(), "A result and its error node should have the same fingerprint.");
+
+	IC::Error<int> staticError(2, IC::StaticMessage("The key was not found."));
+	passed &= check(staticError.getFingerprint() == staticError.shareError()->getFingerprint(), "A static message should have the same fingerprint once promoted to a node.");
+
+	IC::Error<int> diskFull(2, std::string("The disk is full."));
+	IC::Error<int> permissionDenied(2, std::string("Permission was denied."));
+	IC::Error<int, 0, IC::InlineMessageResultPolicy<32>> inlineDiskFull(2, std::string("The disk is full."));
+	passed &= check(diskFull.getFingerprint() != permissionDenied.getFingerprint(), "Failures with different dynamic messages should have different fingerprints.");
+	passed &= check(diskFull.getFingerprint() == IC::Error<int>(2, std::string("The disk is full.")).getFingerprint(), "Failures with the same dynamic message should have the same fingerprint.");
+	passed &= check(inlineDiskFull.getFingerprint() == inlineDiskFull.shareError()->getFingerprint(), "An inline message should have the same fingerprint once promoted to a node.");
+	passed &= check(IC::Error<int>(1, "Could not write.", diskFull).getFingerprint() != IC::Error<int>(1, "Could not write.", permissionDenied).getFingerprint(), "Causes with different dynamic messages should have different fingerprints.");
+
+	aggregator.record(diskFull);
+	aggregator.record(permissionDenied);
+	aggregator.record(diskFull);
+	window = aggregator.flush();
+	passed &= check(window.m_errors.size() == 2, "Failures with different dynamic messages should be aggregated separately.");
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// ErrorAllocatorBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures a storm of failures on many threads at once, where every call fails, with the
+// error nodes allocated from the global heap, the thread local pool and a per request
+// arena. Once warm, the pool should make almost no allocations; this is checked, and the
+// benchmark exits with a failure code if it does not hold.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -pthread -I.. ErrorAllocatorBenchmark.cpp -o ErrorAllocatorBenchmark
+//     ./ErrorAllocatorBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	enum class RequestError
+	{
+		k_success,
+		k_notFound,
+		k_failed
+	};
+
+	struct GlobalPolicy : IC::DefaultResultPolicy
+	{
+		using Allocator = IC::GlobalErrorAllocator;
+	};
+
+	constexpr std::uint64_t k_iterationsPerThread = 200000;
+	constexpr std::uint64_t k_callsPerRequest = 64;
+
+	//-----------------------------------------------------------------------------
+	template <typename TPolicy> IC_BENCHMARK_NOINLINE IC::Result<int, RequestError, RequestError::k_success, TPolicy> lookup(std::uint64_t in_key) noexcept
+	{
+		char message[64];
+		auto length = std::snprintf(message, sizeof(message), "Record %llu was not found in the table.", static_cast<unsigned long long>(in_key));
+		return IC::Result<int, RequestError, RequestError::k_success, TPolicy>(RequestError::k_notFound, std::string_view(message, length));
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TPolicy> IC_BENCHMARK_NOINLINE IC::Result<int, RequestError, RequestError::k_success, TPolicy> handle(std::uint64_t in_key) noexcept
+	{
+		auto result = lookup<TPolicy>(in_key);
+		if (!result)
+		{
+			return IC::Result<int, RequestError, RequestError::k_success, TPolicy>(RequestError::k_failed, IC::StaticMessage("Could not handle the request."), result);
+		}
+		return result;
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TPolicy> IC::Benchmark::Measurement measureStorm(const std::string& in_name, std::uint32_t in_threads) noexcept
+	{
+		return IC::Benchmark::measureThreads(in_name + "/threads:" + std::to_string(in_threads), in_threads, k_iterationsPerThread, [](std::uint64_t in_index)
+		{
+			auto result = handle<TPolicy>(in_index);
+			IC::Benchmark::doNotOptimise(result.getError());
+		});
+	}
+
+	//-----------------------------------------------------------------------------
+	IC::Benchmark::Measurement measureArenaStorm(std::uint32_t in_threads) noexcept
+	{
+		return IC::Benchmark::measureThreads("storm/arena/threads:" + std::to_string(in_threads), in_threads, k_iterationsPerThread, [](std::uint64_t in_index)
+		{
+			static thread_local IC::ErrorArena s_arena(16384);
+
+			{
+				IC::ErrorArena::Scope scope(s_arena);
+				auto result = handle<IC::ArenaResultPolicy>(in_index);
+				IC::Benchmark::doNotOptimise(result.getError());
+			}
+
+			if ((in_index + 1) % k_callsPerRequest == 0)
+			{
+				s_arena.reset();
+			}
+		});
+	}
+}
+
+int main()
+{
+	int exitCode = 0;
+
+	const std::uint32_t k_threadCounts[] = { 1, 4, 16, 64 };
+	for (auto threads : k_threadCounts)
+	{
+		IC::Benchmark::report(measureStorm<GlobalPolicy>("storm/global", threads));
+
+		auto pool = measureStorm<IC::DefaultResultPolicy>("storm/pool", threads);
+		IC::Benchmark::report(pool);
+		if (pool.m_allocationsPerOp > 0.01)
+		{
+			std::fprintf(stderr, "The pool made %.3f allocations per failure with %u threads.\n", pool.m_allocationsPerOp, threads);
+			exitCode = 1;
+		}
+
+		IC::Benchmark::report(measureArenaStorm(threads));
+	}
+
+	return exitCode;
+}
@@ -0,0 +1,116 @@
+// ErrorCatalogBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Compares the cost of creating a failed Error<> with an allocated message, a static
+// message and an error catalog against returning the bare enum.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. ErrorCatalogBenchmark.cpp -o ErrorCatalogBenchmark
+//     ./ErrorCatalogBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+namespace
+{
+	enum class StoreError
+	{
+		k_success,
+		k_notFound,
+		k_readOnly
+	};
+}
+
+template <> struct IC::ErrorCatalog<StoreError>
+{
+	static constexpr IC::ErrorCatalogEntry<StoreError> k_entries[] =
+	{
+		{ StoreError::k_notFound, "The requested item was not found in the store.", IC::ErrorSeverity::k_warning, "store" },
+		{ StoreError::k_readOnly, "The store is read only and cannot be modified.", IC::ErrorSeverity::k_error, "store" },
+	};
+};
+
+namespace
+{
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE StoreError findEnum() noexcept
+	{
+		return StoreError::k_notFound;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::Error<StoreError> findAllocated() noexcept
+	{
+		return IC::Error<StoreError>(StoreError::k_notFound, "The requested item was not found in the store.");
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::Error<StoreError> findStatic() noexcept
+	{
+		return IC::Error<StoreError>(StoreError::k_notFound, IC::StaticMessage("The requested item was not found in the store."));
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::Error<StoreError> findCatalog() noexcept
+	{
+		return IC::Error<StoreError>(StoreError::k_notFound);
+	}
+}
+
+int main()
+{
+	const std::uint64_t k_iterations = 10000000;
+
+	IC::Benchmark::report(IC::Benchmark::measure("fail/enum", k_iterations, [](std::uint64_t)
+	{
+		IC::Benchmark::doNotOptimise(findEnum());
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("fail/allocated-message", k_iterations / 10, [](std::uint64_t)
+	{
+		auto result = findAllocated();
+		IC::Benchmark::doNotOptimise(result.getError());
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("fail/static-message", k_iterations, [](std::uint64_t)
+	{
+		auto result = findStatic();
+		IC::Benchmark::doNotOptimise(result.getError());
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("fail/catalog", k_iterations, [](std::uint64_t)
+	{
+		auto result = findCatalog();
+		IC::Benchmark::doNotOptimise(result.getError());
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("read-message/catalog", k_iterations, [](std::uint64_t)
+	{
+		auto result = findCatalog();
+		IC::Benchmark::doNotOptimise(result.getErrorMessage().size());
+	}));
+
+	return 0;
+}
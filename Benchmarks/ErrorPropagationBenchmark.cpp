@@ -0,0 +1,94 @@
+// ErrorPropagationBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures the cost of propagating a failure up through a number of layers, with each
+// layer wrapping the error below it as its cause. As cause chains are shared rather than
+// cloned, each layer should cost a single node allocation regardless of depth.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. ErrorPropagationBenchmark.cpp -o ErrorPropagationBenchmark
+//     ./ErrorPropagationBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <string>
+
+namespace
+{
+	enum class LayerError
+	{
+		k_success,
+		k_failed
+	};
+
+	//-----------------------------------------------------------------------------
+	template <typename TPolicy> IC::Error<LayerError, LayerError::k_success, TPolicy> propagate(int in_depth) noexcept
+	{
+		if (in_depth <= 1)
+		{
+			return IC::Error<LayerError, LayerError::k_success, TPolicy>(LayerError::k_failed, "The lowest layer failed.");
+		}
+
+		auto result = propagate<TPolicy>(in_depth - 1);
+		if (result)
+		{
+			return result;
+		}
+
+		return IC::Error<LayerError, LayerError::k_success, TPolicy>(LayerError::k_failed, "A layer failed.", result);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TPolicy> void benchmarkPolicy(const std::string& in_policyName) noexcept
+	{
+		const int k_depths[] = { 1, 8, 32, 128 };
+
+		for (auto depth : k_depths)
+		{
+			auto name = "propagate/" + in_policyName + "/depth:" + std::to_string(depth);
+			IC::Benchmark::report(IC::Benchmark::measure(name, 2000000 / depth, [depth](std::uint64_t)
+			{
+				auto result = propagate<TPolicy>(depth);
+				IC::Benchmark::doNotOptimise(result);
+			}));
+		}
+
+		auto deepResult = propagate<TPolicy>(128);
+		IC::Benchmark::report(IC::Benchmark::measure("copy/" + in_policyName + "/depth:128", 1000000, [&deepResult](std::uint64_t)
+		{
+			auto copy = deepResult;
+			IC::Benchmark::doNotOptimise(copy);
+		}));
+	}
+}
+
+int main()
+{
+	benchmarkPolicy<IC::DefaultResultPolicy>("atomic");
+	benchmarkPolicy<IC::SingleThreadedResultPolicy>("non-atomic");
+
+	return 0;
+}
@@ -0,0 +1,301 @@
+// ErrorReserveBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures creating failures from the emergency error reserve, which is used when the
+// allocator of a result policy fails, compared with creating them normally. Failures are
+// made to use the reserve by injecting an allocator which fails on demand. Every failure
+// must still be reported with its error, its cause and as much of its message as fits,
+// failures with several causes must keep as many as fit and report how many didn't, the
+// reserve must be returned once the failures are destroyed, and rendering them into a
+// fixed buffer must not allocate; these are checked, and the benchmark exits with a
+// failure code if they don't hold.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. ErrorReserveBenchmark.cpp -o ErrorReserveBenchmark -ldl
+//     ./ErrorReserveBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	enum class LoadError
+	{
+		k_success,
+		k_notFound,
+		k_failed
+	};
+
+	/// An allocator which delegates to the pool allocator, or fails every allocation
+	/// while s_failing is set.
+	///
+	struct FailingErrorAllocator final
+	{
+		static bool s_failing;
+
+		//-----------------------------------------------------------------------------
+		static void* allocate(std::size_t in_size) noexcept
+		{
+			return s_failing ? nullptr : IC::PoolErrorAllocator::allocate(in_size);
+		}
+
+		//-----------------------------------------------------------------------------
+		static void deallocate(void* in_memory, std::size_t in_size) noexcept
+		{
+			IC::PoolErrorAllocator::deallocate(in_memory, in_size);
+		}
+	};
+
+	bool FailingErrorAllocator::s_failing = false;
+
+	/// Fails every allocation made while it's in scope.
+	///
+	class FailAllocations final
+	{
+	public:
+		//-----------------------------------------------------------------------------
+		FailAllocations() noexcept
+		{
+			FailingErrorAllocator::s_failing = true;
+		}
+
+		//-----------------------------------------------------------------------------
+		~FailAllocations() noexcept
+		{
+			FailingErrorAllocator::s_failing = false;
+		}
+	};
+
+	struct FailingPolicy : IC::DefaultResultPolicy
+	{
+		using Allocator = FailingErrorAllocator;
+	};
+
+	struct FailingDiagnosticPolicy : IC::DiagnosticResultPolicy
+	{
+		using Allocator = FailingErrorAllocator;
+	};
+
+	using LoadResult = IC::Result<int, LoadError, LoadError::k_success, FailingPolicy>;
+	using DiagnosticLoadResult = IC::Result<int, LoadError, LoadError::k_success, FailingDiagnosticPolicy>;
+
+	constexpr std::uint64_t k_iterations = 2000000;
+
+	//-----------------------------------------------------------------------------
+	template <typename TResult> IC_BENCHMARK_NOINLINE TResult load(int in_key) noexcept
+	{
+		if (in_key < 0)
+		{
+			return TResult(in_key);
+		}
+
+		char message[64];
+		auto length = std::snprintf(message, sizeof(message), "Key %d was not found.", in_key);
+		return TResult(LoadError::k_notFound, std::string_view(message, std::size_t(length)));
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TResult> IC_BENCHMARK_NOINLINE TResult loadAll(int in_key) noexcept
+	{
+		auto result = load<TResult>(in_key);
+		if (!result)
+		{
+			return TResult(LoadError::k_failed, IC::StaticMessage("Could not load everything."), result);
+		}
+		return result;
+	}
+
+	//-----------------------------------------------------------------------------
+	bool check(bool in_condition, const std::string& in_message) noexcept
+	{
+		if (!in_condition)
+		{
+			std::fprintf(stderr, "%s\n", in_message.c_str());
+		}
+		return in_condition;
+	}
+
+	/// Checks that failures created while the allocator fails are reported in full,
+	/// except for long messages which are truncated, and that the reserve is returned
+	/// once they're destroyed.
+	///
+	/// @return Whether the checks passed.
+	///
+	bool checkReported() noexcept
+	{
+		bool passed = true;
+		auto before = IC::getErrorReserveStats();
+
+		{
+			FailAllocations failAllocations;
+
+			auto failure = loadAll<LoadResult>(7);
+			passed &= check(!failure && failure.getError() == LoadError::k_failed, "A failure should keep its error.");
+			passed &= check(failure.getFullErrorMessage() == "Could not load everything.\nCaused by:\nKey 7 was not found.", "A failure should keep its cause and messages.");
+
+			std::string longMessage(1000, 'x');
+			LoadResult truncated(LoadError::k_notFound, longMessage);
+			auto message = truncated.getErrorMessage();
+			passed &= check(!message.empty() && message.size() < longMessage.size() && longMessage.compare(0, message.size(), message) == 0, "A long message should be truncated to a prefix.");
+
+			LoadResult deferred(LoadError::k_notFound, IC::deferMessage("Key {} was not found in '{}'.", 7, "/etc/items"));
+			passed &= check(deferred.getErrorMessage() == "Key {} was not found in '{}'." && deferred.getError() == LoadError::k_notFound, "A deferred message should fall back to its template.");
+
+			const std::uint32_t line = __LINE__ + 1;
+			DiagnosticLoadResult located(LoadError::k_failed, "Located.");
+#ifdef IC_RESULT_HAS_SOURCE_LOCATION
+			passed &= check(located.getSourceLocation().getLine() == line, "A failure from the reserve should keep its location.");
+#else
+			(void)line;
+#endif
+			passed &= check(located.getErrorMessage() == "Located.", "A failure with diagnostics should keep its message.");
+
+			auto during = IC::getErrorReserveStats();
+			passed &= check(during.m_allocations - before.m_allocations == 5, "Each failure should be counted as an allocation from the reserve.");
+			passed &= check(during.m_truncatedMessages - before.m_truncatedMessages == 1, "The long message should be counted as truncated.");
+			passed &= check(during.m_blocksInUse == before.m_blocksInUse + 5, "Each failure should hold one block.");
+		}
+
+		passed &= check(IC::getErrorReserveStats().m_blocksInUse == before.m_blocksInUse, "Every block should be returned to the reserve.");
+
+		auto normal = loadAll<LoadResult>(7);
+		passed &= check(IC::getErrorReserveStats().m_allocations == before.m_allocations + 5, "The reserve should not be used once allocation succeeds again.");
+
+		return passed;
+	}
+
+	/// Checks that failures with several causes created while the allocator fails keep
+	/// as many of their causes as fit in a block, and report how many were dropped.
+	///
+	/// @return Whether the checks passed.
+	///
+	bool checkTrees() noexcept
+	{
+		bool passed = true;
+		auto before = IC::getErrorReserveStats();
+
+		IC::ErrorCauses fewCauses;
+		for (int key = 0; key < 3; ++key)
+		{
+			fewCauses.add(load<LoadResult>(key));
+		}
+
+		constexpr std::size_t k_manyCauses = 40;
+		IC::ErrorCauses manyCauses;
+		for (int key = 0; key < int(k_manyCauses); ++key)
+		{
+			manyCauses.add(load<LoadResult>(key));
+		}
+
+		{
+			FailAllocations failAllocations;
+
+			LoadResult few(LoadError::k_failed, "Every replica failed.", fewCauses);
+			passed &= check(few.getErrorMessage() == "Every replica failed." && few.getCauses().getSize() == 3, "A failure whose causes fit in a block should keep all of them.");
+
+			LoadResult many(LoadError::k_failed, "Every replica failed.", manyCauses);
+			auto kept = many.getCauses().getSize();
+			auto note = " (" + std::to_string(k_manyCauses - kept) + " further causes were dropped.)";
+			auto message = many.getErrorMessage();
+			passed &= check(kept > 0 && kept < k_manyCauses, "A failure whose causes don't fit in a block should keep some of them.");
+			passed &= check(message.size() > note.size() && message.substr(message.size() - note.size()) == note && message.substr(0, 21) == "Every replica failed.", "A failure should report how many causes were dropped.");
+			passed &= check(many.getCausedBy() && many.getCausedBy()->getErrorMessage() == "Key 0 was not found.", "A failure should keep its first cause.");
+			passed &= check(IC::getErrorReserveStats().m_droppedCauses - before.m_droppedCauses == k_manyCauses - kept, "The dropped causes should be counted.");
+
+			LoadResult deferred(LoadError::k_failed, IC::deferMessage("{} replicas failed.", 3), fewCauses);
+			passed &= check(deferred.getErrorMessage() == "{} replicas failed." && deferred.getCauses().getSize() == 3, "A deferred message should fall back to its template.");
+		}
+
+		passed &= check(IC::getErrorReserveStats().m_blocksInUse == before.m_blocksInUse, "Every block should be returned to the reserve.");
+		return passed;
+	}
+
+	/// Checks that a failure from the reserve can be rendered into a fixed buffer
+	/// without allocating.
+	///
+	/// @return Whether the check passed.
+	///
+	bool checkRender() noexcept
+	{
+		auto failure = []()
+		{
+			FailAllocations failAllocations;
+			return loadAll<LoadResult>(7);
+		}();
+
+		char buffer[256];
+		auto measurement = IC::Benchmark::measure("render/reserve", 100000, [&failure, &buffer](std::uint64_t)
+		{
+			IC::FixedBufferErrorSink sink(buffer);
+			failure.writeFullErrorMessage(sink);
+			IC::Benchmark::doNotOptimise(sink.getMessage());
+		});
+		IC::Benchmark::report(measurement);
+		return check(measurement.m_allocationsPerOp == 0.0, "Rendering a failure from the reserve into a fixed buffer should not allocate.");
+	}
+
+	/// Measures creating and destroying a failure wrapped in another.
+	///
+	/// @param in_name - The name of the case.
+	///
+	/// @return The measurement.
+	///
+	IC::Benchmark::Measurement measureFailure(const std::string& in_name) noexcept
+	{
+		for (int i = 0; i < 1000; ++i)
+		{
+			IC::Benchmark::doNotOptimise(loadAll<LoadResult>(i));
+		}
+
+		auto measurement = IC::Benchmark::measure(in_name, k_iterations, [](std::uint64_t in_index)
+		{
+			IC::Benchmark::doNotOptimise(loadAll<LoadResult>(int(in_index & 0xffff)));
+		});
+		IC::Benchmark::report(measurement);
+		return measurement;
+	}
+}
+
+int main()
+{
+	bool passed = true;
+
+	passed &= checkReported();
+	passed &= checkTrees();
+	passed &= checkRender();
+
+	measureFailure("failure/allocator");
+	{
+		FailAllocations failAllocations;
+		auto reserve = measureFailure("failure/reserve");
+		passed &= check(reserve.m_allocationsPerOp == 0.0, "A failure from the reserve should not allocate.");
+	}
+	passed &= check(IC::getErrorReserveStats().m_blocksInUse == 0, "Every block should be returned to the reserve.");
+
+	return passed ? 0 : 1;
+}
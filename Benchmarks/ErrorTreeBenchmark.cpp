@@ -0,0 +1,293 @@
+// ErrorTreeBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures failures with several causes, which store every error beneath them as one
+// flat array, compared with representing the same failures as a chain with one wrapper
+// per cause. The causes must be iterated in order, getCausedBy() must return the first
+// cause, a deferred message must not be formatted until it's read, the tree must render
+// and pass through the wire format unchanged, creating a failure from existing causes
+// must make a single allocation, and walking or rendering it into a fixed buffer must
+// make none; these are checked, and the benchmark exits with a failure code if any don't
+// hold.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. ErrorTreeBenchmark.cpp -o ErrorTreeBenchmark
+//     ./ErrorTreeBenchmark
+
+#include "Benchmark.h"
+#include "../ErrorWire.h"
+
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	enum class FetchError
+	{
+		k_success,
+		k_failed,
+		k_timedOut
+	};
+
+	/// Nodes are allocated from the global heap rather than the pool, so that every
+	/// node created shows up in the allocation counts.
+	///
+	struct GlobalPolicy : IC::DefaultResultPolicy
+	{
+		using Allocator = IC::GlobalErrorAllocator;
+	};
+
+	using FetchResult = IC::Result<void, FetchError, FetchError::k_success, GlobalPolicy>;
+
+	constexpr std::uint64_t k_iterations = 200000;
+
+	/// An argument to a deferred message which counts how many times it's formatted.
+	///
+	struct CountedArgument final
+	{
+		static int s_formatCount;
+	};
+
+	int CountedArgument::s_formatCount = 0;
+
+	//-----------------------------------------------------------------------------
+	std::ostream& operator<<(std::ostream& io_stream, const CountedArgument&)
+	{
+		++CountedArgument::s_formatCount;
+		return io_stream << "counted";
+	}
+
+	/// @param in_shard - The shard the request was sent to.
+	///
+	/// @return A failed request, caused by a timeout.
+	///
+	FetchResult makeRequestFailure(int in_shard) noexcept
+	{
+		FetchResult timeout(FetchError::k_timedOut, IC::deferMessage("Shard {} timed out.", in_shard));
+		return FetchResult(FetchError::k_failed, IC::deferMessage("The request to shard {} failed.", in_shard), timeout);
+	}
+
+	/// @param in_count - The number of causes.
+	///
+	/// @return The causes of a failed fan out to the given number of shards.
+	///
+	IC::ErrorCauses makeCauses(int in_count) noexcept
+	{
+		IC::ErrorCauses causes;
+		causes.reserve(std::size_t(in_count));
+		for (int shard = 0; shard < in_count; ++shard)
+		{
+			causes.add(makeRequestFailure(shard));
+		}
+		return causes;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE FetchResult makeTree(const IC::ErrorCauses& in_causes) noexcept
+	{
+		return FetchResult(FetchError::k_failed, IC::StaticMessage("The fan out failed."), in_causes);
+	}
+
+	/// @param in_causes - The causes.
+	///
+	/// @return The same failure as makeTree(), with the causes represented as a chain of
+	/// wrappers, as they would be without support for several causes. Only the last
+	/// cause keeps its own cause.
+	///
+	IC_BENCHMARK_NOINLINE FetchResult makeChain(const std::vector<FetchResult>& in_causes) noexcept
+	{
+		FetchResult chain(in_causes.back().getError(), IC::StaticMessage("A request failed."), in_causes.back());
+		for (auto cause = in_causes.rbegin() + 1; cause != in_causes.rend(); ++cause)
+		{
+			chain = FetchResult(cause->getError(), IC::StaticMessage("A request failed."), chain);
+		}
+		return FetchResult(FetchError::k_failed, IC::StaticMessage("The fan out failed."), chain);
+	}
+
+	/// @param in_result - The failure.
+	///
+	/// @return The total length of the messages of every error beneath the failure.
+	///
+	IC_BENCHMARK_NOINLINE std::size_t walkTree(const FetchResult& in_result) noexcept
+	{
+		std::size_t length = 0;
+		for (auto& cause : in_result.getCauses())
+		{
+			for (auto entry : cause.getErrorTree())
+			{
+				length += entry.m_node->getErrorMessage().size();
+			}
+		}
+		return length;
+	}
+
+	/// @param in_result - The failure.
+	///
+	/// @return The total length of the messages of every error in the cause chain.
+	///
+	IC_BENCHMARK_NOINLINE std::size_t walkChain(const FetchResult& in_result) noexcept
+	{
+		std::size_t length = 0;
+		for (auto node = in_result.getCausedBy(); node; node = node->getCausedBy())
+		{
+			length += node->getErrorMessage().size();
+		}
+		return length;
+	}
+
+	//-----------------------------------------------------------------------------
+	bool check(bool in_condition, const std::string& in_message) noexcept
+	{
+		if (!in_condition)
+		{
+			std::fprintf(stderr, "%s\n", in_message.c_str());
+		}
+		return in_condition;
+	}
+
+	/// Checks the structure and rendering of a small tree with a nested fan out.
+	///
+	/// @return Whether every check passed.
+	///
+	bool checkTree() noexcept
+	{
+		bool passed = true;
+
+		IC::ErrorCauses inner;
+		inner.add(FetchResult(FetchError::k_timedOut, IC::StaticMessage("Replica a timed out.")));
+		inner.add(FetchResult(FetchError::k_timedOut, IC::StaticMessage("Replica b timed out.")));
+
+		IC::ErrorCauses causes;
+		causes.add(makeRequestFailure(0));
+		causes.add(FetchResult(FetchError::k_failed, IC::StaticMessage("Shard 1 failed."), inner));
+		causes.add(FetchResult(FetchError::k_timedOut, IC::deferMessage("Shard {} timed out.", 2)));
+		auto tree = makeTree(causes);
+
+		std::string causeMessages;
+		for (auto& cause : tree.getCauses())
+		{
+			causeMessages += std::string(cause.getErrorMessage()) + "|";
+		}
+		passed &= check(tree.getCauses().getSize() == 3 && causeMessages == "The request to shard 0 failed.|Shard 1 failed.|Shard 2 timed out.|", "The causes should be iterated in order.");
+		passed &= check(tree.getCausedBy() && tree.getCausedBy()->getErrorMessage() == "The request to shard 0 failed.", "getCausedBy() should return the first cause.");
+
+		std::string depths;
+		for (auto entry : tree.getCausedBy()->getErrorTree())
+		{
+			depths += std::to_string(entry.m_depth);
+		}
+		passed &= check(depths == "01", "The tree of a cause with a single cause should be its chain.");
+
+		auto expectedTree = std::string("The fan out failed.\n")
+			+ "- The request to shard 0 failed.\n"
+			+ "  - Shard 0 timed out.\n"
+			+ "- Shard 1 failed.\n"
+			+ "  - Replica a timed out.\n"
+			+ "  - Replica b timed out.\n"
+			+ "- Shard 2 timed out.";
+		passed &= check(tree.getFullErrorMessage(IC::ErrorMessageFormat::k_tree) == expectedTree, "The tree should render with one indented line per error.");
+
+		auto expectedChain = std::string("The fan out failed.\nCaused by:\nThe request to shard 0 failed.\nCaused by:\nShard 0 timed out.\nCaused by:\nShard 1 failed.\n")
+			+ "Caused by:\nReplica a timed out.\nCaused by:\nReplica b timed out.\nCaused by:\nShard 2 timed out.";
+		passed &= check(tree.getFullErrorMessage() == expectedChain, "The chain format should list every error in pre-order.");
+
+		FetchResult deferred(FetchError::k_failed, IC::deferMessage("The {} fan out failed.", CountedArgument()), causes);
+		passed &= check(CountedArgument::s_formatCount == 0 && deferred.getFingerprint() != 0, "A deferred message with several causes should not be formatted until it's read.");
+		passed &= check(deferred.getErrorMessage() == "The counted fan out failed." && deferred.getErrorMessage().size() > 0 && CountedArgument::s_formatCount == 1, "A deferred message with several causes should be formatted once.");
+
+		std::vector<unsigned char> buffer;
+		IC::writeErrorWire(tree, buffer);
+		auto view = IC::ErrorWireView::read(buffer.data(), buffer.size());
+		passed &= check(view && view.getValue().getCauseCount() == 3 && view.getValue().getCause(1).getCauseCount() == 2, "The wire format should keep every cause.");
+		passed &= check(view && view.getValue().toResult<FetchError>().getValue().getFullErrorMessage(IC::ErrorMessageFormat::k_tree) == expectedTree, "A tree should pass through the wire format unchanged.");
+
+		return passed;
+	}
+}
+
+int main()
+{
+	bool passed = checkTree();
+
+	const int k_causeCounts[] = { 2, 8, 32 };
+	for (auto causeCount : k_causeCounts)
+	{
+		auto suffix = "/causes:" + std::to_string(causeCount);
+
+		auto causes = makeCauses(causeCount);
+		std::vector<FetchResult> causeResults;
+		for (int shard = 0; shard < causeCount; ++shard)
+		{
+			causeResults.push_back(makeRequestFailure(shard));
+		}
+
+		auto buildTree = IC::Benchmark::measure("build/tree" + suffix, k_iterations, [&causes](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(makeTree(causes));
+		});
+		IC::Benchmark::report(buildTree);
+		passed &= check(buildTree.m_allocationsPerOp == 1.0, "Creating a failure from existing causes should make a single allocation" + suffix + ".");
+
+		IC::Benchmark::report(IC::Benchmark::measure("build/chain" + suffix, k_iterations, [&causeResults](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(makeChain(causeResults));
+		}));
+
+		auto tree = makeTree(causes);
+		auto chain = makeChain(causeResults);
+		std::size_t expectedLength = 0;
+		for (auto& cause : causeResults)
+		{
+			expectedLength += cause.getErrorMessage().size() + cause.getCausedBy()->getErrorMessage().size();
+		}
+		passed &= check(walkTree(tree) == expectedLength, "Walking the tree should visit every error" + suffix + ".");
+
+		auto walk = IC::Benchmark::measure("walk/tree" + suffix, k_iterations, [&tree](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(walkTree(tree));
+		});
+		IC::Benchmark::report(walk);
+		passed &= check(walk.m_allocationsPerOp == 0.0, "Walking the tree should not allocate" + suffix + ".");
+
+		IC::Benchmark::report(IC::Benchmark::measure("walk/chain" + suffix, k_iterations, [&chain](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(walkChain(chain));
+		}));
+
+		char buffer[4096];
+		auto render = IC::Benchmark::measure("render/tree" + suffix, k_iterations, [&tree, &buffer](std::uint64_t)
+		{
+			IC::FixedBufferErrorSink sink(buffer);
+			tree.writeFullErrorMessage(sink, IC::ErrorMessageFormat::k_tree);
+			IC::Benchmark::doNotOptimise(buffer);
+		});
+		IC::Benchmark::report(render);
+		passed &= check(render.m_allocationsPerOp == 0.0, "Rendering the tree into a fixed buffer should not allocate" + suffix + ".");
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,393 @@
+// ErrorWireBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures passing an error chain to another process through a pipe, using the binary
+// wire format compared with sending getFullErrorMessage(). Each operation writes the
+// chain to a local pipe, reads it back and inspects every error in it. The received
+// chain must match the original, writing to a reused buffer and reading through an
+// ErrorWireView must make no allocation, every truncated copy of a chain must be
+// rejected, and a chain in which an error has the success value must not be converted
+// to a Result; these are checked, and the benchmark exits with a failure code if any
+// don't hold.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. ErrorWireBenchmark.cpp -o ErrorWireBenchmark
+//     ./ErrorWireBenchmark
+
+#include "Benchmark.h"
+#include "../ErrorWire.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	enum class LayerError
+	{
+		k_success,
+		k_failed,
+		k_timedOut
+	};
+
+	constexpr std::uint64_t k_iterations = 200000;
+
+	/// A local pipe, standing in for the connection to another process.
+	///
+	class Pipe final
+	{
+	public:
+		//-----------------------------------------------------------------------------
+		Pipe() noexcept
+		{
+#ifdef _WIN32
+			m_isOpen = _pipe(m_fds, 65536, _O_BINARY) == 0;
+#else
+			m_isOpen = pipe(m_fds) == 0;
+#endif
+		}
+
+		Pipe(const Pipe&) = delete;
+		Pipe& operator=(const Pipe&) = delete;
+
+		//-----------------------------------------------------------------------------
+		bool isOpen() const noexcept
+		{
+			return m_isOpen;
+		}
+
+		/// @param in_data - The data to write. This must fit in the pipe's buffer, as
+		/// it's read back on the same thread.
+		/// @param in_size - The size of the data.
+		///
+		/// @return Whether all of the data was written.
+		///
+		bool write(const void* in_data, std::size_t in_size) noexcept
+		{
+			auto bytes = static_cast<const unsigned char*>(in_data);
+			while (in_size > 0)
+			{
+				auto written = ::write(m_fds[1], bytes, static_cast<unsigned int>(in_size));
+				if (written <= 0)
+				{
+					return false;
+				}
+				bytes += written;
+				in_size -= std::size_t(written);
+			}
+			return true;
+		}
+
+		/// @param out_data - The buffer to read into.
+		/// @param in_size - The number of bytes to read.
+		///
+		/// @return Whether all of the data was read.
+		///
+		bool read(void* out_data, std::size_t in_size) noexcept
+		{
+			auto bytes = static_cast<unsigned char*>(out_data);
+			while (in_size > 0)
+			{
+				auto received = ::read(m_fds[0], bytes, static_cast<unsigned int>(in_size));
+				if (received <= 0)
+				{
+					return false;
+				}
+				bytes += received;
+				in_size -= std::size_t(received);
+			}
+			return true;
+		}
+
+		//-----------------------------------------------------------------------------
+		~Pipe() noexcept
+		{
+			if (m_isOpen)
+			{
+				::close(m_fds[0]);
+				::close(m_fds[1]);
+			}
+		}
+
+	private:
+		int m_fds[2];
+		bool m_isOpen = false;
+	};
+
+	/// @param in_depth - The number of errors in the chain.
+	///
+	/// @return A failure with a chain of the given depth, alternating between two error
+	/// types.
+	///
+	IC::Result<int, LayerError> makeChain(int in_depth) noexcept
+	{
+		IC::Result<int, LayerError> result(LayerError::k_timedOut, IC::deferMessage("The request to shard {} timed out after {}ms.", 7, 250));
+		for (int i = 1; i < in_depth; ++i)
+		{
+			if (i + 1 < in_depth)
+			{
+				IC::BoolError operation(false, IC::StaticMessage("The operation could not be completed."), result);
+				result = IC::Result<int, LayerError>(LayerError::k_failed, IC::deferMessage("Layer {} failed.", i), operation);
+				++i;
+			}
+			else
+			{
+				result = IC::Result<int, LayerError>(LayerError::k_failed, IC::deferMessage("Layer {} failed.", i), result);
+			}
+		}
+		return result;
+	}
+
+	/// Sends a chain through the pipe in the wire format, then reads it back.
+	///
+	/// @param in_chain - The chain to send.
+	/// @param io_pipe - The pipe.
+	/// @param io_sendBuffer - The reused buffer the chain is written to.
+	/// @param io_receiveBuffer - The reused buffer the chain is read into.
+	///
+	/// @return A checksum of the received error codes and message lengths, or 0 if
+	/// sending or reading failed.
+	///
+	IC_BENCHMARK_NOINLINE std::uint64_t roundTripWire(const IC::Result<int, LayerError>& in_chain, Pipe& io_pipe, std::vector<unsigned char>& io_sendBuffer, std::vector<unsigned char>& io_receiveBuffer) noexcept
+	{
+		io_sendBuffer.clear();
+		IC::writeErrorWire(in_chain, io_sendBuffer);
+		if (!io_pipe.write(io_sendBuffer.data(), io_sendBuffer.size()))
+		{
+			return 0;
+		}
+
+		io_receiveBuffer.resize(IC::ErrorWireView::k_headerSize);
+		if (!io_pipe.read(io_receiveBuffer.data(), IC::ErrorWireView::k_headerSize))
+		{
+			return 0;
+		}
+		auto size = IC::ErrorWireView::readSize(io_receiveBuffer.data(), io_receiveBuffer.size());
+		if (!size)
+		{
+			return 0;
+		}
+		io_receiveBuffer.resize(size.getValue());
+		if (!io_pipe.read(io_receiveBuffer.data() + IC::ErrorWireView::k_headerSize, size.getValue() - IC::ErrorWireView::k_headerSize))
+		{
+			return 0;
+		}
+
+		auto view = IC::ErrorWireView::read(io_receiveBuffer.data(), io_receiveBuffer.size());
+		if (!view)
+		{
+			return 0;
+		}
+
+		std::uint64_t checksum = 1;
+		for (auto error = std::optional<IC::ErrorWireView>(view.getValue()); error; error = error->getCausedBy())
+		{
+			checksum = checksum * 31 + std::uint64_t(error->getErrorCode()) + error->getErrorMessage().size() + error->getErrorType().size();
+		}
+		return checksum;
+	}
+
+	/// Sends the full error message of a chain through the pipe, then reads it back.
+	///
+	/// @param in_chain - The chain to send.
+	/// @param io_pipe - The pipe.
+	///
+	/// @return The length of the received message, or 0 if sending or reading failed.
+	///
+	IC_BENCHMARK_NOINLINE std::uint64_t roundTripFullMessage(const IC::Result<int, LayerError>& in_chain, Pipe& io_pipe) noexcept
+	{
+		auto message = in_chain.getFullErrorMessage();
+		std::uint32_t size = static_cast<std::uint32_t>(message.size());
+		if (!io_pipe.write(&size, sizeof(size)) || !io_pipe.write(message.data(), message.size()))
+		{
+			return 0;
+		}
+
+		std::uint32_t receivedSize = 0;
+		if (!io_pipe.read(&receivedSize, sizeof(receivedSize)))
+		{
+			return 0;
+		}
+		std::string received(receivedSize, '\0');
+		if (!io_pipe.read(&received[0], receivedSize))
+		{
+			return 0;
+		}
+		return received.size();
+	}
+
+	/// @param in_chain - The original chain.
+	/// @param in_buffer - The chain in the wire format.
+	///
+	/// @return Whether the chain in the buffer matches the original.
+	///
+	bool matches(const IC::Result<int, LayerError>& in_chain, const std::vector<unsigned char>& in_buffer) noexcept
+	{
+		auto view = IC::ErrorWireView::read(in_buffer.data(), in_buffer.size());
+		if (!view || view.getValue().getErrorCode() != std::int64_t(in_chain.getError()) || view.getValue().getErrorMessage() != in_chain.getErrorMessage())
+		{
+			return false;
+		}
+
+		auto error = view.getValue().getCausedBy();
+		for (auto node = in_chain.getCausedBy(); node; node = node->getCausedBy(), error = error->getCausedBy())
+		{
+			if (!error || error->getErrorCode() != node->getErrorCode() || error->getErrorType() != node->getErrorType() || error->getErrorMessage() != node->getErrorMessage())
+			{
+				return false;
+			}
+		}
+
+		auto received = view.getValue().toResult<LayerError>();
+		return !error && received && received.getValue().getFullErrorMessage() == in_chain.getFullErrorMessage();
+	}
+
+	/// Overwrites the error code of an error in a chain in the wire format.
+	///
+	/// @param in_error - A view of the error.
+	/// @param in_errorCode - The new error code.
+	///
+	void setErrorCode(const IC::ErrorWireView& in_error, std::int64_t in_errorCode) noexcept
+	{
+		// The message directly follows the record, which starts with the error code.
+		auto record = const_cast<char*>(in_error.getErrorMessage().data()) - sizeof(IC::Detail::ErrorWireNode);
+		std::memcpy(record, &in_errorCode, sizeof(in_errorCode));
+	}
+
+	/// @param in_chain - A chain with at least two errors.
+	///
+	/// @return Whether a chain whose first error or first cause has been given the
+	/// success value is rejected by toResult().
+	///
+	bool rejectsSuccess(const IC::Result<int, LayerError>& in_chain) noexcept
+	{
+		std::vector<unsigned char> buffer;
+		IC::writeErrorWire(in_chain, buffer);
+		setErrorCode(IC::ErrorWireView::read(buffer.data(), buffer.size()).getValue(), std::int64_t(LayerError::k_success));
+		auto rootRejected = !IC::ErrorWireView::read(buffer.data(), buffer.size()).getValue().toResult<LayerError>();
+
+		buffer.clear();
+		IC::writeErrorWire(in_chain, buffer);
+		setErrorCode(*IC::ErrorWireView::read(buffer.data(), buffer.size()).getValue().getCausedBy(), std::int64_t(LayerError::k_success));
+		auto causeRejected = !IC::ErrorWireView::read(buffer.data(), buffer.size()).getValue().toResult<LayerError>();
+
+		return rootRejected && causeRejected;
+	}
+
+	//-----------------------------------------------------------------------------
+	bool check(bool in_condition, const std::string& in_message) noexcept
+	{
+		if (!in_condition)
+		{
+			std::fprintf(stderr, "%s\n", in_message.c_str());
+		}
+		return in_condition;
+	}
+}
+
+int main()
+{
+	bool passed = true;
+
+	Pipe pipe;
+	if (!check(pipe.isOpen(), "Could not open a pipe."))
+	{
+		return 1;
+	}
+
+	const int k_depths[] = { 1, 4, 16 };
+	for (auto depth : k_depths)
+	{
+		auto suffix = "/depth:" + std::to_string(depth);
+		auto chain = makeChain(depth);
+
+		std::vector<unsigned char> buffer;
+		IC::writeErrorWire(chain, buffer);
+		passed &= check(matches(chain, buffer), "The received chain should match the original" + suffix + ".");
+		IC::Benchmark::reportValue("wire_size" + suffix, "bytes", buffer.size());
+		IC::Benchmark::reportValue("full_message_size" + suffix, "bytes", chain.getFullErrorMessage().size());
+
+		std::size_t rejected = 0;
+		for (std::size_t size = 0; size < buffer.size(); ++size)
+		{
+			rejected += IC::ErrorWireView::read(buffer.data(), size) ? 0 : 1;
+		}
+		passed &= check(rejected == buffer.size(), "Every truncated chain should be rejected" + suffix + ".");
+		passed &= check(depth < 2 || rejectsSuccess(chain), "A chain with an error which has the success value should be rejected" + suffix + ".");
+
+		auto write = IC::Benchmark::measure("write" + suffix, k_iterations, [&chain, &buffer](std::uint64_t)
+		{
+			buffer.clear();
+			IC::writeErrorWire(chain, buffer);
+			IC::Benchmark::doNotOptimise(buffer.data());
+		});
+		IC::Benchmark::report(write);
+		passed &= check(write.m_allocationsPerOp == 0.0, "Writing to a reused buffer should not allocate" + suffix + ".");
+
+		auto read = IC::Benchmark::measure("read" + suffix, k_iterations, [&buffer](std::uint64_t)
+		{
+			auto view = IC::ErrorWireView::read(buffer.data(), buffer.size());
+			std::size_t length = 0;
+			for (auto error = std::optional<IC::ErrorWireView>(view.getValue()); error; error = error->getCausedBy())
+			{
+				length += error->getErrorMessage().size();
+			}
+			IC::Benchmark::doNotOptimise(length);
+		});
+		IC::Benchmark::report(read);
+		passed &= check(read.m_allocationsPerOp == 0.0, "Reading through a view should not allocate" + suffix + ".");
+
+		IC::Benchmark::report(IC::Benchmark::measure("to_result" + suffix, k_iterations, [&buffer](std::uint64_t)
+		{
+			auto view = IC::ErrorWireView::read(buffer.data(), buffer.size());
+			IC::Benchmark::doNotOptimise(view.getValue().toResult<LayerError>().getValue());
+		}));
+
+		std::vector<unsigned char> sendBuffer;
+		std::vector<unsigned char> receiveBuffer;
+		passed &= check(roundTripWire(chain, pipe, sendBuffer, receiveBuffer) != 0, "The wire round trip should succeed" + suffix + ".");
+		auto wireRoundTrip = IC::Benchmark::measure("pipe_round_trip/wire" + suffix, k_iterations, [&](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(roundTripWire(chain, pipe, sendBuffer, receiveBuffer));
+		});
+		IC::Benchmark::report(wireRoundTrip);
+		passed &= check(wireRoundTrip.m_allocationsPerOp == 0.0, "The wire round trip should not allocate" + suffix + ".");
+
+		IC::Benchmark::report(IC::Benchmark::measure("pipe_round_trip/full_message" + suffix, k_iterations, [&](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(roundTripFullMessage(chain, pipe));
+		}));
+	}
+
+	return passed ? 0 : 1;
+}
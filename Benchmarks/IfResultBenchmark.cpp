@@ -0,0 +1,148 @@
+// IfResultBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures checking results with "if (result)" in a tight loop, comparing Result with a
+// type which mirrors the earlier design, in which every result derived from a virtual
+// interface and the check was a virtual call. The virtual call is made through an
+// opaque pointer, as it would be when the compiler cannot devirtualise it, for example
+// across translation units.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. IfResultBenchmark.cpp -o IfResultBenchmark
+//     ./IfResultBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+	/// Mirrors the virtual interface which results used to derive from.
+	///
+	class LegacyInterface
+	{
+	public:
+		explicit operator bool() const noexcept { return wasSuccessful(); }
+
+		virtual bool wasSuccessful() const noexcept = 0;
+
+		virtual ~LegacyInterface() noexcept {}
+	};
+
+	/// Mirrors a result with a vtable pointer.
+	///
+	class LegacyResult final : public LegacyInterface
+	{
+	public:
+		LegacyResult(int in_value, bool in_error) noexcept
+			: m_value(in_value), m_error(in_error)
+		{
+		}
+
+		bool wasSuccessful() const noexcept override { return m_error; }
+
+		int getValue() const noexcept { return m_value; }
+
+	private:
+		int m_value;
+		bool m_error;
+	};
+
+	constexpr std::size_t k_numResults = 4096;
+	constexpr std::uint64_t k_iterations = 20000;
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE std::int64_t sumSuccessful(const std::vector<IC::BoolResult<int>>& in_results) noexcept
+	{
+		std::int64_t sum = 0;
+		for (const auto& result : in_results)
+		{
+			if (result)
+			{
+				sum += result.getValue();
+			}
+		}
+		return sum;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE std::int64_t sumSuccessful(const std::vector<LegacyResult>& in_results) noexcept
+	{
+		std::int64_t sum = 0;
+		for (const auto& legacyResult : in_results)
+		{
+			const LegacyInterface* result = &legacyResult;
+#if defined(__GNUC__) || defined(__clang__)
+			asm volatile("" : "+r"(result));
+#endif
+			if (*result)
+			{
+				sum += legacyResult.getValue();
+			}
+		}
+		return sum;
+	}
+
+	//-----------------------------------------------------------------------------
+	bool shouldSucceed(std::size_t in_index) noexcept
+	{
+		return in_index % 10 != 0;
+	}
+}
+
+int main()
+{
+	std::vector<IC::BoolResult<int>> results;
+	std::vector<LegacyResult> legacyResults;
+	for (std::size_t i = 0; i < k_numResults; ++i)
+	{
+		if (shouldSucceed(i))
+		{
+			results.emplace_back(int(i));
+		}
+		else
+		{
+			results.emplace_back(false, IC::StaticMessage("Failed."));
+		}
+		legacyResults.emplace_back(int(i), shouldSucceed(i));
+	}
+
+	IC::Benchmark::reportValue("sizeof/BoolResult<int>", "bytes", sizeof(IC::BoolResult<int>));
+	IC::Benchmark::reportValue("sizeof/Legacy<int, bool>", "bytes", sizeof(LegacyResult));
+
+	IC::Benchmark::report(IC::Benchmark::measure("if/Result/results:4096", k_iterations, [&results](std::uint64_t)
+	{
+		IC::Benchmark::doNotOptimise(sumSuccessful(results));
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("if/Legacy/results:4096", k_iterations, [&legacyResults](std::uint64_t)
+	{
+		IC::Benchmark::doNotOptimise(sumSuccessful(legacyResults));
+	}));
+
+	return 0;
+}
@@ -0,0 +1,121 @@
+// InlineMessageBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures the creation of failures with short, dynamically built messages, with and
+// without inline message storage. Messages which fit in the inline capacity must make
+// no allocation at all; this is checked, and the benchmark exits with a failure code if
+// any are made.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. InlineMessageBenchmark.cpp -o InlineMessageBenchmark
+//     ./InlineMessageBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	/// Nodes are allocated from the global heap rather than the pool, so that every
+	/// node created shows up in the allocation counts.
+	///
+	struct InlinePolicy : IC::InlineMessageResultPolicy<32>
+	{
+		using Allocator = IC::GlobalErrorAllocator;
+	};
+
+	//-----------------------------------------------------------------------------
+	template <typename TPolicy> IC_BENCHMARK_NOINLINE IC::Result<int, bool, true, TPolicy> lookup(std::uint64_t in_key) noexcept
+	{
+		char message[64];
+		auto length = std::snprintf(message, sizeof(message), "key %llu not found", static_cast<unsigned long long>(in_key));
+		return IC::Result<int, bool, true, TPolicy>(false, std::string_view(message, length));
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TPolicy> IC_BENCHMARK_NOINLINE IC::Result<int, bool, true, TPolicy> fail(const std::string& in_message) noexcept
+	{
+		return IC::Result<int, bool, true, TPolicy>(false, in_message);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TPolicy> IC::Benchmark::Measurement measureLookup(const std::string& in_name) noexcept
+	{
+		return IC::Benchmark::measure(in_name, 5000000, [](std::uint64_t in_index)
+		{
+			auto result = lookup<TPolicy>(in_index);
+			IC::Benchmark::doNotOptimise(result.getErrorMessage().size());
+		});
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TPolicy> IC::Benchmark::Measurement measureLength(const std::string& in_name, std::size_t in_length) noexcept
+	{
+		std::string message(in_length, 'x');
+		return IC::Benchmark::measure(in_name + "/length:" + std::to_string(in_length), 5000000, [&message](std::uint64_t)
+		{
+			auto result = fail<TPolicy>(message);
+			IC::Benchmark::doNotOptimise(result.getError());
+		});
+	}
+}
+
+int main()
+{
+	int exitCode = 0;
+
+	IC::Benchmark::report(measureLookup<IC::DefaultResultPolicy>("lookup/default"));
+
+	auto inlineLookup = measureLookup<InlinePolicy>("lookup/inline:32");
+	IC::Benchmark::report(inlineLookup);
+	if (inlineLookup.m_allocationsPerOp != 0.0)
+	{
+		std::fprintf(stderr, "Inline messages should not allocate.\n");
+		exitCode = 1;
+	}
+
+	const std::size_t k_lengths[] = { 8, 16, 24, 32, 48 };
+	for (auto length : k_lengths)
+	{
+		IC::Benchmark::report(measureLength<IC::DefaultResultPolicy>("fail/default", length));
+
+		auto measurement = measureLength<InlinePolicy>("fail/inline:32", length);
+		IC::Benchmark::report(measurement);
+
+		auto expectedAllocations = length <= InlinePolicy::k_inlineMessageCapacity ? 0.0 : 1.0;
+		if (measurement.m_allocationsPerOp != expectedAllocations)
+		{
+			std::fprintf(stderr, "Expected %.0f allocations for a %zu byte message.\n", expectedAllocations, length);
+			exitCode = 1;
+		}
+	}
+
+	IC::Benchmark::reportValue("sizeof/BoolResult<int>/default", "bytes", sizeof(IC::BoolResult<int>));
+	IC::Benchmark::reportValue("sizeof/BoolResult<int>/inline:32", "bytes", sizeof(IC::BoolResult<int, InlinePolicy>));
+
+	return exitCode;
+}
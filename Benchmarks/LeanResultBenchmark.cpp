@@ -0,0 +1,128 @@
+// LeanResultBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Compares a LeanResult with a std::pair holding the same value and error, returned from
+// the same parsing function. The LeanResult must be trivially copyable and the same size
+// as the pair, which is checked at compile time, so that it is returned in registers in
+// the same way. To compare the generated code of the two functions:
+//
+//     objdump -d --no-show-raw-insn -C LeanResultBenchmark | grep -A20 "parseDigitLean\|parseDigitPair"
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. LeanResultBenchmark.cpp -o LeanResultBenchmark
+//     ./LeanResultBenchmark
+
+#include "Benchmark.h"
+#include "../LeanResult.h"
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace
+{
+	enum class ParseError : std::uint32_t
+	{
+		k_success,
+		k_invalidDigit
+	};
+
+	using LeanDigit = IC::LeanResult<std::uint32_t, ParseError>;
+	using PairDigit = std::pair<std::uint32_t, ParseError>;
+
+	static_assert(std::is_trivially_copyable<LeanDigit>::value, "LeanResult should be trivially copyable.");
+	static_assert(std::is_trivially_destructible<LeanDigit>::value, "LeanResult should be trivially destructible.");
+	static_assert(sizeof(LeanDigit) == sizeof(PairDigit), "LeanResult should be the same size as the equivalent pair.");
+
+	//-----------------------------------------------------------------------------
+	constexpr LeanDigit parseDigit(char in_char) noexcept
+	{
+		if (in_char < '0' || in_char > '9')
+		{
+			return LeanDigit(ParseError::k_invalidDigit);
+		}
+
+		return LeanDigit(std::uint32_t(in_char - '0'));
+	}
+
+	static_assert(parseDigit('7').getValue() == 7, "LeanResult should be usable in constant expressions.");
+	static_assert(parseDigit('x').getError() == ParseError::k_invalidDigit, "LeanResult should be usable in constant expressions.");
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LeanDigit parseDigitLean(char in_char) noexcept
+	{
+		return parseDigit(in_char);
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE PairDigit parseDigitPair(char in_char) noexcept
+	{
+		if (in_char < '0' || in_char > '9')
+		{
+			return PairDigit(0, ParseError::k_invalidDigit);
+		}
+
+		return PairDigit(std::uint32_t(in_char - '0'), ParseError::k_success);
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::Result<std::uint32_t, ParseError> parseDigitFull(char in_char) noexcept
+	{
+		if (in_char < '0' || in_char > '9')
+		{
+			return IC::Result<std::uint32_t, ParseError>(ParseError::k_invalidDigit, IC::StaticMessage("Invalid digit."));
+		}
+
+		return IC::Result<std::uint32_t, ParseError>(std::uint32_t(in_char - '0'));
+	}
+
+	const std::string g_input = "8273645109x8273645109";
+}
+
+int main()
+{
+	const std::uint64_t k_iterations = 20000000;
+
+	IC::Benchmark::report(IC::Benchmark::measure("parse/LeanResult", k_iterations, [](std::uint64_t in_index)
+	{
+		auto result = parseDigitLean(g_input[in_index % g_input.size()]);
+		IC::Benchmark::doNotOptimise(result ? result.getValue() : 0u);
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("parse/std::pair", k_iterations, [](std::uint64_t in_index)
+	{
+		auto result = parseDigitPair(g_input[in_index % g_input.size()]);
+		IC::Benchmark::doNotOptimise(result.second == ParseError::k_success ? result.first : 0u);
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("parse/Result", k_iterations, [](std::uint64_t in_index)
+	{
+		auto result = parseDigitFull(g_input[in_index % g_input.size()]);
+		IC::Benchmark::doNotOptimise(result ? result.getValue() : 0u);
+	}));
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+// RenderBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures rendering the full error message of cause chains of increasing depth. The
+// previous recursive approach, which built a new string at every level, is compared with
+// rendering into sinks. Rendering into a reused string, or into a fixed buffer, must make
+// no allocation at all; this is checked, and the benchmark exits with a failure code if
+// any are made.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. RenderBenchmark.cpp -o RenderBenchmark
+//     ./RenderBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	//-----------------------------------------------------------------------------
+	IC::BoolError makeChain(std::size_t in_depth) noexcept
+	{
+		IC::BoolError error(false, "The connection to the database was reset by the peer.");
+		for (std::size_t i = 1; i < in_depth; ++i)
+		{
+			error = IC::BoolError(false, IC::deferMessage("Could not complete step {} of the request.", i), error);
+		}
+		return error;
+	}
+
+	/// Renders the full error message in the way it was rendered before sinks were
+	/// added, recursing and concatenating a new string at every level.
+	///
+	std::string renderRecursive(const IC::ErrorNode& in_node) noexcept
+	{
+		std::string errorMessage(in_node.getErrorMessage());
+		if (auto causedBy = in_node.getCausedBy())
+		{
+			errorMessage += "\nCaused by:\n" + renderRecursive(*causedBy);
+		}
+		return errorMessage;
+	}
+
+	//-----------------------------------------------------------------------------
+	std::string renderRecursive(const IC::BoolError& in_error) noexcept
+	{
+		std::string errorMessage(in_error.getErrorMessage());
+		if (auto causedBy = in_error.getCausedBy())
+		{
+			errorMessage += "\nCaused by:\n" + renderRecursive(*causedBy);
+		}
+		return errorMessage;
+	}
+}
+
+int main()
+{
+	int exitCode = 0;
+
+	const std::size_t k_depths[] = { 1, 8, 64, 512 };
+	for (auto depth : k_depths)
+	{
+		auto error = makeChain(depth);
+		auto iterations = 2000000 / (depth * 4);
+		auto suffix = "/depth:" + std::to_string(depth);
+
+		IC::Benchmark::report(IC::Benchmark::measure("render/recursive" + suffix, iterations, [&error](std::uint64_t)
+		{
+			auto errorMessage = renderRecursive(error);
+			IC::Benchmark::doNotOptimise(errorMessage.size());
+		}));
+
+		IC::Benchmark::report(IC::Benchmark::measure("render/getFullErrorMessage" + suffix, iterations, [&error](std::uint64_t)
+		{
+			auto errorMessage = error.getFullErrorMessage();
+			IC::Benchmark::doNotOptimise(errorMessage.size());
+		}));
+
+		std::string buffer;
+		auto reused = IC::Benchmark::measure("render/StringErrorSink" + suffix, iterations, [&error, &buffer](std::uint64_t)
+		{
+			buffer.clear();
+			IC::StringErrorSink sink(buffer);
+			error.writeFullErrorMessage(sink);
+			IC::Benchmark::doNotOptimise(buffer.size());
+		});
+		IC::Benchmark::report(reused);
+
+		static char s_fixedBuffer[4096];
+		auto fixed = IC::Benchmark::measure("render/FixedBufferErrorSink" + suffix, iterations, [&error](std::uint64_t)
+		{
+			IC::FixedBufferErrorSink sink(s_fixedBuffer);
+			error.writeFullErrorMessage(sink);
+			IC::Benchmark::doNotOptimise(sink.getMessage().size());
+		});
+		IC::Benchmark::report(fixed);
+
+		if (reused.m_allocationsPerOp > 1.0 / double(iterations) || fixed.m_allocationsPerOp != 0.0)
+		{
+			std::fprintf(stderr, "Rendering into a reused string or a fixed buffer should not allocate.\n");
+			exitCode = 1;
+		}
+	}
+
+	return exitCode;
+}
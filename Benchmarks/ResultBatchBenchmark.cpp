@@ -0,0 +1,274 @@
+// ResultBatchBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures validating a column of a million values and then scanning the results for
+// failures, with a std::vector of BoolResults compared with a ResultBatch. Each
+// operation processes the whole column. The two must agree on every failure, the
+// partitioned and compacted values must match, and scanning must make no allocation;
+// these are checked, and the benchmark exits with a failure code if any don't hold.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. ResultBatchBenchmark.cpp -o ResultBatchBenchmark
+//     ./ResultBatchBenchmark
+
+#include "Benchmark.h"
+#include "../ResultBatch.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr std::size_t k_columnSize = 1000000;
+	constexpr std::uint64_t k_iterations = 50;
+
+	using VectorColumn = std::vector<IC::BoolResult<std::uint32_t>>;
+	using BatchColumn = IC::ResultBatch<std::uint32_t, bool, true>;
+
+	/// @param in_failurePercent - The percentage of values which fail validation.
+	///
+	/// @return The column of raw values to validate.
+	///
+	std::vector<std::uint32_t> makeInput(std::uint32_t in_failurePercent) noexcept
+	{
+		std::vector<std::uint32_t> input(k_columnSize);
+		std::uint32_t state = 12345;
+		for (auto& value : input)
+		{
+			state = state * 1664525u + 1013904223u;
+			value = (state >> 8) % 100 < in_failurePercent ? 1000000 + (state & 0xff) : (state >> 8) % 1000;
+		}
+		return input;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC::BoolResult<std::uint32_t> validate(std::uint32_t in_value) noexcept
+	{
+		if (in_value >= 1000000)
+		{
+			return IC::BoolResult<std::uint32_t>(false, IC::StaticMessage("The value is out of range."));
+		}
+		return IC::BoolResult<std::uint32_t>(in_value);
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE VectorColumn validateVector(const std::vector<std::uint32_t>& in_input) noexcept
+	{
+		VectorColumn column;
+		column.reserve(in_input.size());
+		for (auto value : in_input)
+		{
+			column.push_back(validate(value));
+		}
+		return column;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE BatchColumn validateBatch(const std::vector<std::uint32_t>& in_input) noexcept
+	{
+		BatchColumn column;
+		column.reserve(in_input.size());
+		for (auto value : in_input)
+		{
+			column.add(validate(value));
+		}
+		return column;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE std::size_t countFailures(const VectorColumn& in_column) noexcept
+	{
+		std::size_t failures = 0;
+		for (auto& result : in_column)
+		{
+			failures += result.wasSuccessful() ? 0 : 1;
+		}
+		return failures;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE std::size_t countFailures(const BatchColumn& in_column) noexcept
+	{
+		return in_column.countFailures();
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE std::uint64_t sumSuccessful(const VectorColumn& in_column) noexcept
+	{
+		std::uint64_t sum = 0;
+		for (auto& result : in_column)
+		{
+			if (result)
+			{
+				sum += result.getValue();
+			}
+		}
+		return sum;
+	}
+
+	/// Failed elements hold a default constructed value, which is zero, so the dense
+	/// array can be summed without checking which elements failed.
+	///
+	IC_BENCHMARK_NOINLINE std::uint64_t sumSuccessful(const BatchColumn& in_column) noexcept
+	{
+		std::uint64_t sum = 0;
+		auto values = in_column.getValues();
+		for (std::size_t index = 0; index < in_column.size(); ++index)
+		{
+			sum += values[index];
+		}
+		return sum;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE void partition(const VectorColumn& in_column, std::vector<std::uint32_t>& out_values, std::vector<std::size_t>& out_failedIndices) noexcept
+	{
+		for (std::size_t index = 0; index < in_column.size(); ++index)
+		{
+			if (in_column[index])
+			{
+				out_values.push_back(in_column[index].getValue());
+			}
+			else
+			{
+				out_failedIndices.push_back(index);
+			}
+		}
+	}
+
+	/// Checks a condition, printing the message if it doesn't hold.
+	///
+	/// @return The condition.
+	///
+	bool check(bool in_condition, const std::string& in_message) noexcept
+	{
+		if (!in_condition)
+		{
+			std::fprintf(stderr, "%s\n", in_message.c_str());
+		}
+		return in_condition;
+	}
+}
+
+int main()
+{
+	bool passed = true;
+
+	const std::uint32_t k_failurePercents[] = { 0, 1, 10 };
+	for (auto failurePercent : k_failurePercents)
+	{
+		auto input = makeInput(failurePercent);
+		auto suffix = "/failures:" + std::to_string(failurePercent) + "%/elements:" + std::to_string(k_columnSize);
+
+		IC::Benchmark::report(IC::Benchmark::measure("validate/vector" + suffix, k_iterations, [&input](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(validateVector(input));
+		}));
+		IC::Benchmark::report(IC::Benchmark::measure("validate/batch" + suffix, k_iterations, [&input](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(validateBatch(input));
+		}));
+
+		auto vectorColumn = validateVector(input);
+		auto batchColumn = validateBatch(input);
+
+		auto vectorCount = IC::Benchmark::measure("count_failures/vector" + suffix, k_iterations, [&vectorColumn](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(countFailures(vectorColumn));
+		});
+		IC::Benchmark::report(vectorCount);
+		auto batchCount = IC::Benchmark::measure("count_failures/batch" + suffix, k_iterations, [&batchColumn](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(countFailures(batchColumn));
+		});
+		IC::Benchmark::report(batchCount);
+		passed &= check(vectorCount.m_allocationsPerOp == 0.0 && batchCount.m_allocationsPerOp == 0.0, "Counting failures should not allocate.");
+
+		IC::Benchmark::report(IC::Benchmark::measure("sum_successful/vector" + suffix, k_iterations, [&vectorColumn](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(sumSuccessful(vectorColumn));
+		}));
+		IC::Benchmark::report(IC::Benchmark::measure("sum_successful/batch" + suffix, k_iterations, [&batchColumn](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(sumSuccessful(batchColumn));
+		}));
+
+		IC::Benchmark::report(IC::Benchmark::measure("partition/vector" + suffix, k_iterations, [&vectorColumn](std::uint64_t)
+		{
+			std::vector<std::uint32_t> values;
+			std::vector<std::size_t> failedIndices;
+			partition(vectorColumn, values, failedIndices);
+			IC::Benchmark::doNotOptimise(values);
+		}));
+		IC::Benchmark::report(IC::Benchmark::measure("partition/batch" + suffix, k_iterations, [&batchColumn](std::uint64_t)
+		{
+			std::vector<std::uint32_t> values;
+			std::vector<std::size_t> failedIndices;
+			batchColumn.partition(values, failedIndices);
+			IC::Benchmark::doNotOptimise(values);
+		}));
+
+		IC::Benchmark::reportValue("footprint/vector" + suffix, "bytes", vectorColumn.size() * sizeof(VectorColumn::value_type));
+		IC::Benchmark::reportValue("footprint/batch" + suffix, "bytes", batchColumn.size() * sizeof(std::uint32_t) + (batchColumn.size() + 63) / 64 * sizeof(std::uint64_t) + batchColumn.countFailures() * sizeof(BatchColumn::Failure));
+
+		passed &= check(countFailures(vectorColumn) == batchColumn.countFailures(), "The failure counts should match" + suffix);
+		passed &= check(sumSuccessful(vectorColumn) == sumSuccessful(batchColumn), "The sums should match" + suffix);
+		passed &= check(batchColumn.allSucceeded() == (failurePercent == 0), "allSucceeded() should be true only without failures" + suffix);
+
+		std::size_t firstFailure = vectorColumn.size();
+		for (std::size_t index = 0; index < vectorColumn.size(); ++index)
+		{
+			if (!vectorColumn[index])
+			{
+				firstFailure = index;
+				break;
+			}
+		}
+		passed &= check(batchColumn.getFirstFailure() == firstFailure, "The first failures should match" + suffix);
+
+		std::vector<std::uint32_t> vectorValues, batchValues;
+		std::vector<std::size_t> vectorFailedIndices, batchFailedIndices;
+		partition(vectorColumn, vectorValues, vectorFailedIndices);
+		batchColumn.partition(batchValues, batchFailedIndices);
+		passed &= check(vectorValues == batchValues && vectorFailedIndices == batchFailedIndices, "The partitions should match" + suffix);
+
+		for (auto index : batchFailedIndices)
+		{
+			auto result = batchColumn.getResult(index);
+			if (!check(!result && result.getErrorMessage() == vectorColumn[index].getErrorMessage(), "The failed results should match" + suffix))
+			{
+				passed = false;
+				break;
+			}
+		}
+
+		auto removed = batchColumn.compact();
+		passed &= check(batchColumn.size() == batchValues.size() && batchColumn.allSucceeded() && removed.size() == batchFailedIndices.size(), "Compaction should remove every failure" + suffix);
+		passed &= check(std::equal(batchValues.begin(), batchValues.end(), batchColumn.getValues()), "Compaction should keep the successful values in order" + suffix);
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+// ResultSizeBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Reports the size of common Result instantiations, whether they can be returned in
+// registers, and the cost of returning them from a hot lookup function, including
+// lookups which return a reference to a large record rather than a copy. The sizes are
+// compared against a type with the original layout, in which every result carried the
+// value, the error, the message string and the cause pointer. Result has a non-trivial
+// destructor, which releases the error node, so every instantiation is expected to
+// report returned_in_registers=0; only LeanResult can be returned in registers.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. ResultSizeBenchmark.cpp -o ResultSizeBenchmark
+//     ./ResultSizeBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	enum class LookupError
+	{
+		k_success,
+		k_notFound
+	};
+
+	/// Mirrors the layout Result used before the value and error data shared storage.
+	///
+	template <typename TValue, typename TError> class LegacyLayout
+	{
+	public:
+		LegacyLayout(const TValue& in_value) noexcept
+			: m_value(in_value), m_error()
+		{
+		}
+
+		virtual ~LegacyLayout() noexcept {}
+
+		const TValue& getValue() const noexcept { return m_value; }
+
+	private:
+		TValue m_value;
+		TError m_error;
+		std::string m_errorMessage;
+		std::unique_ptr<const LegacyLayout> m_causedBy;
+	};
+
+	/// A type with no default constructor, which can only be stored in a Result now that
+	/// failed results no longer construct a value.
+	///
+	struct Handle final
+	{
+		explicit Handle(int in_id) noexcept : m_id(in_id) {}
+
+		int m_id;
+	};
+
+	/// A large object of the kind stored in caches and registries.
+	///
+	struct Record final
+	{
+		char m_data[1024];
+		int m_id;
+	};
+
+	std::vector<int> g_table(1024, 7);
+	std::vector<Record> g_records(64);
+
+	//-----------------------------------------------------------------------------
+	template <typename TResult> void reportLayout(const std::string& in_name) noexcept
+	{
+		constexpr bool k_inRegisters = std::is_trivially_copyable<TResult>::value && sizeof(TResult) <= 2 * sizeof(void*);
+
+		IC::Benchmark::reportValue("sizeof/" + in_name, "bytes", sizeof(TResult));
+		IC::Benchmark::reportValue("registers/" + in_name, "returned_in_registers", k_inRegisters ? 1 : 0);
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::BoolResult<int> lookup(std::uint64_t in_key) noexcept
+	{
+		if (in_key < g_table.size())
+		{
+			return IC::BoolResult<int>(g_table[in_key]);
+		}
+
+		return IC::BoolResult<int>(false, "Key not found.");
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::BoolResult<Record> findRecordCopy(std::uint64_t in_key) noexcept
+	{
+		if (in_key < g_records.size())
+		{
+			return IC::BoolResult<Record>(g_records[in_key]);
+		}
+
+		return IC::BoolResult<Record>(false, IC::StaticMessage("Record not found."));
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::BoolResult<const Record&> findRecord(std::uint64_t in_key) noexcept
+	{
+		if (in_key < g_records.size())
+		{
+			return IC::BoolResult<const Record&>(g_records[in_key]);
+		}
+
+		return IC::BoolResult<const Record&>(false, IC::StaticMessage("Record not found."));
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LegacyLayout<int, bool> legacyLookup(std::uint64_t in_key) noexcept
+	{
+		return LegacyLayout<int, bool>(g_table[in_key]);
+	}
+}
+
+int main()
+{
+	reportLayout<IC::BoolResult<int>>("BoolResult<int>");
+	reportLayout<LegacyLayout<int, bool>>("Legacy<int, bool>");
+	reportLayout<IC::BoolResult<double>>("BoolResult<double>");
+	reportLayout<LegacyLayout<double, bool>>("Legacy<double, bool>");
+	reportLayout<IC::Result<int, LookupError>>("Result<int, LookupError>");
+	reportLayout<LegacyLayout<int, LookupError>>("Legacy<int, LookupError>");
+	reportLayout<IC::BoolResult<std::string>>("BoolResult<std::string>");
+	reportLayout<LegacyLayout<std::string, bool>>("Legacy<std::string, bool>");
+	reportLayout<IC::BoolResult<Handle>>("BoolResult<Handle>");
+	reportLayout<IC::BoolResult<Record>>("BoolResult<Record>");
+	reportLayout<IC::BoolResult<const Record&>>("BoolResult<const Record&>");
+	reportLayout<IC::Error<LookupError>>("Error<LookupError>");
+	reportLayout<IC::BoolError>("BoolError");
+
+	const std::uint64_t k_iterations = 10000000;
+
+	IC::Benchmark::report(IC::Benchmark::measure("return/BoolResult<int>/success", k_iterations, [](std::uint64_t in_index)
+	{
+		auto result = lookup(in_index & 1023);
+		IC::Benchmark::doNotOptimise(result.getValue());
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("return/Legacy<int, bool>/success", k_iterations, [](std::uint64_t in_index)
+	{
+		auto result = legacyLookup(in_index & 1023);
+		IC::Benchmark::doNotOptimise(result.getValue());
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("return/BoolResult<int>/failure", k_iterations / 10, [](std::uint64_t in_index)
+	{
+		auto result = lookup(in_index + 1024);
+		IC::Benchmark::doNotOptimise(result.getError());
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("lookup/BoolResult<Record>", k_iterations, [](std::uint64_t in_index)
+	{
+		auto result = findRecordCopy(in_index & 63);
+		IC::Benchmark::doNotOptimise(result.getValue().m_id);
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure("lookup/BoolResult<const Record&>", k_iterations, [](std::uint64_t in_index)
+	{
+		auto result = findRecord(in_index & 63);
+		IC::Benchmark::doNotOptimise(result.getValue().m_id);
+	}));
+
+	return 0;
+}
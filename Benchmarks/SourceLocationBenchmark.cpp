@@ -0,0 +1,235 @@
+// SourceLocationBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures the cost of recording where each failure was created, with
+// DiagnosticResultPolicy, compared with the default policy, and the cost of sampling
+// backtraces at several rates. The captured location must be that of the code which
+// created the failure, capturing it must make no allocation beyond the error node which
+// the failure already needs, and only the sampled failures may record a backtrace; these
+// are checked, and the benchmark exits with a failure code if they don't hold.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -rdynamic -I.. SourceLocationBenchmark.cpp -o SourceLocationBenchmark -ldl
+//     ./SourceLocationBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace
+{
+	enum class LayerError
+	{
+		k_success,
+		k_failed
+	};
+
+	using DefaultResult = IC::Result<int, LayerError>;
+	using DiagnosticResult = IC::Result<int, LayerError, LayerError::k_success, IC::DiagnosticResultPolicy>;
+
+	constexpr std::uint64_t k_iterations = 2000000;
+	const std::uint32_t k_sampleRates[] = { 1000, 100, 1 };
+
+	//-----------------------------------------------------------------------------
+	template <typename TResult> IC_BENCHMARK_NOINLINE TResult failWithMessage(int in_value) noexcept
+	{
+		if (in_value < 0)
+		{
+			return TResult(in_value);
+		}
+		return TResult(LayerError::k_failed, "The layer failed.");
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TResult> IC_BENCHMARK_NOINLINE TResult failWithStaticMessage(int in_value) noexcept
+	{
+		if (in_value < 0)
+		{
+			return TResult(in_value);
+		}
+		return TResult(LayerError::k_failed, IC::StaticMessage("The layer failed."));
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE DiagnosticResult forward(int in_value) noexcept
+	{
+		IC_TRY_ASSIGN(auto value, failWithMessage<DiagnosticResult>(in_value));
+		return value + 1;
+	}
+
+	//-----------------------------------------------------------------------------
+	bool check(bool in_condition, const std::string& in_message) noexcept
+	{
+		if (!in_condition)
+		{
+			std::fprintf(stderr, "%s\n", in_message.c_str());
+		}
+		return in_condition;
+	}
+
+	//-----------------------------------------------------------------------------
+	bool endsWith(std::string_view in_string, std::string_view in_suffix) noexcept
+	{
+		return in_string.size() >= in_suffix.size() && in_string.substr(in_string.size() - in_suffix.size()) == in_suffix;
+	}
+
+	/// Checks that failures record the location of the code which created them, that the
+	/// location survives forwarding and wrapping, and that it's written in the full
+	/// error message.
+	///
+	/// @return Whether the checks passed.
+	///
+	bool checkLocations() noexcept
+	{
+		bool passed = true;
+
+		passed &= check(!failWithMessage<DefaultResult>(0).getSourceLocation(), "The default policy should not capture a location.");
+
+		const std::uint32_t line = __LINE__ + 1;
+		DiagnosticResult failure(LayerError::k_failed, IC::StaticMessage("Created here."));
+		auto location = failure.getSourceLocation();
+#ifdef IC_RESULT_HAS_SOURCE_LOCATION
+		passed &= check(location && location.getLine() == line && endsWith(location.getFile(), "SourceLocationBenchmark.cpp") && std::strstr(location.getFunction(), "checkLocations"), "The location should be that of the constructor's caller.");
+#endif
+
+		auto forwarded = forward(0);
+		auto created = failWithMessage<DiagnosticResult>(0);
+		passed &= check(forwarded.getSourceLocation().getLine() == created.getSourceLocation().getLine(), "A forwarded failure should keep its location.");
+
+		DiagnosticResult wrapped(LayerError::k_failed, IC::StaticMessage("Wrapped."), failure);
+		passed &= check(wrapped.getCausedBy()->getDiagnostics()->m_sourceLocation.getLine() == line, "A cause should keep its location.");
+
+		auto message = wrapped.getFullErrorMessage();
+		auto expected = ":" + std::to_string(line) + " in ";
+		passed &= check(message.find(expected) != std::string::npos && message.find("\n    at ") < message.find("Caused by:"), "The full message should contain each location.");
+
+		DiagnosticResult catalogless(LayerError::k_failed, "A dynamic message.", IC::Error<LayerError>(LayerError::k_failed, "A cause with the default policy."));
+		passed &= check(!catalogless.getCausedBy()->getDiagnostics(), "A cause with the default policy should have no diagnostics.");
+
+		return passed;
+	}
+
+	/// @param in_result - A failed result with a policy that captures source locations.
+	///
+	/// @return Whether the failure recorded a backtrace.
+	///
+	bool wasSampled(const DiagnosticResult& in_result) noexcept
+	{
+		return in_result.shareError()->getDiagnostics()->m_backtraceSize > 0;
+	}
+
+	/// Checks that exactly one in every sample rate failures records a backtrace, and
+	/// that the backtrace is symbolised, without allocating, when the message is written.
+	///
+	/// @return Whether the checks passed.
+	///
+	bool checkSampling() noexcept
+	{
+		bool passed = true;
+
+		passed &= check(!wasSampled(failWithMessage<DiagnosticResult>(0)), "No backtrace should be recorded when sampling is disabled.");
+
+#ifdef IC_RESULT_HAS_BACKTRACE
+		IC::setErrorBacktraceSampleRate(10);
+		int sampled = 0;
+		for (int i = 0; i < 100; ++i)
+		{
+			sampled += wasSampled(failWithMessage<DiagnosticResult>(0)) ? 1 : 0;
+		}
+		passed &= check(sampled == 10, "One in every 10 failures should record a backtrace.");
+
+		IC::setErrorBacktraceSampleRate(1);
+		auto failure = failWithMessage<DiagnosticResult>(0);
+		IC::setErrorBacktraceSampleRate(0);
+		passed &= check(wasSampled(failure), "Every failure should record a backtrace when the sample rate is 1.");
+
+		char buffer[4096];
+		std::string_view message;
+		auto measurement = IC::Benchmark::measure("render/backtrace", 10000, [&failure, &buffer, &message](std::uint64_t)
+		{
+			IC::FixedBufferErrorSink sink(buffer);
+			failure.writeFullErrorMessage(sink);
+			message = sink.getMessage();
+		});
+		IC::Benchmark::report(measurement);
+		passed &= check(message.find("\n    #0 0x") != std::string_view::npos, "The full message should contain the backtrace.");
+		passed &= check(measurement.m_allocationsPerOp == 0.0, "Rendering a backtrace into a fixed buffer should not allocate.");
+#endif
+
+		return passed;
+	}
+
+	/// Measures creating and destroying a failure with the given function, after warming
+	/// up the node pool.
+	///
+	/// @param in_name - The name of the case.
+	/// @param in_function - Creates a failure.
+	///
+	/// @return The measurement.
+	///
+	template <typename TFunction> IC::Benchmark::Measurement measureFailure(const std::string& in_name, TFunction in_function) noexcept
+	{
+		for (int i = 0; i < 1000; ++i)
+		{
+			IC::Benchmark::doNotOptimise(in_function());
+		}
+
+		auto measurement = IC::Benchmark::measure(in_name, k_iterations, [&in_function](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(in_function());
+		});
+		IC::Benchmark::report(measurement);
+		return measurement;
+	}
+}
+
+int main()
+{
+	bool passed = true;
+
+	passed &= checkLocations();
+	passed &= checkSampling();
+
+	auto defaultMessage = measureFailure("failure/default/message", []() { return failWithMessage<DefaultResult>(0); });
+	auto locationMessage = measureFailure("failure/location/message", []() { return failWithMessage<DiagnosticResult>(0); });
+	passed &= check(locationMessage.m_allocationsPerOp == defaultMessage.m_allocationsPerOp, "Capturing the location should not allocate.");
+
+	measureFailure("failure/default/static", []() { return failWithStaticMessage<DefaultResult>(0); });
+	measureFailure("failure/location/static", []() { return failWithStaticMessage<DiagnosticResult>(0); });
+
+#ifdef IC_RESULT_HAS_BACKTRACE
+	for (auto sampleRate : k_sampleRates)
+	{
+		IC::setErrorBacktraceSampleRate(sampleRate);
+		measureFailure("failure/backtrace/rate:" + std::to_string(sampleRate), []() { return failWithMessage<DiagnosticResult>(0); });
+	}
+	IC::setErrorBacktraceSampleRate(0);
+#endif
+
+	return passed ? 0 : 1;
+}
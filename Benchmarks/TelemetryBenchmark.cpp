@@ -0,0 +1,183 @@
+// TelemetryBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures the overhead of error telemetry. The benchmark is built twice, with and
+// without IC_RESULT_ENABLE_TELEMETRY, and the cases are named accordingly so the two
+// runs can be compared. With telemetry enabled the recorded counts are checked against
+// the number of failures created; with it disabled nothing must be recorded. The
+// benchmark exits with a failure code if either doesn't hold.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -pthread -I.. TelemetryBenchmark.cpp -o TelemetryBenchmark
+//     g++ -std=c++17 -O2 -pthread -DIC_RESULT_ENABLE_TELEMETRY -I.. TelemetryBenchmark.cpp -o TelemetryBenchmarkEnabled
+//     ./TelemetryBenchmark && ./TelemetryBenchmarkEnabled
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace
+{
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+	constexpr bool k_telemetryEnabled = true;
+	const std::string k_prefix = "telemetry:on/";
+#else
+	constexpr bool k_telemetryEnabled = false;
+	const std::string k_prefix = "telemetry:off/";
+#endif
+
+	constexpr std::uint64_t k_iterations = 5000000;
+	constexpr std::uint64_t k_threadIterations = 2000000;
+	constexpr std::uint64_t k_wrapIterations = 500000;
+	constexpr std::uint32_t k_wrapDepth = 8;
+	constexpr std::string_view k_message = "the requested key was not found";
+
+	enum class LookupError
+	{
+		k_success,
+		k_static,
+		k_message,
+		k_threaded,
+		k_wrapped
+	};
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::Result<int, LookupError> succeed(std::uint64_t in_index) noexcept
+	{
+		return IC::Result<int, LookupError>(static_cast<int>(in_index));
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::Result<int, LookupError> failStatic(LookupError in_error) noexcept
+	{
+		return IC::Result<int, LookupError>(in_error, IC::StaticMessage("The key was not found."));
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::Result<int, LookupError> failMessage() noexcept
+	{
+		return IC::Result<int, LookupError>(LookupError::k_message, k_message);
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::Result<int, LookupError> failWrapped(std::uint32_t in_depth) noexcept
+	{
+		if (in_depth == 1)
+		{
+			return failStatic(LookupError::k_wrapped);
+		}
+
+		auto result = failWrapped(in_depth - 1);
+		return IC::Result<int, LookupError>(LookupError::k_wrapped, IC::StaticMessage("The lookup failed."), result);
+	}
+
+	/// @return The entry in the snapshot for the given error, or an empty entry if there
+	/// is none.
+	///
+	IC::ErrorTelemetryEntry findEntry(const IC::ErrorTelemetrySnapshot& in_snapshot, LookupError in_error) noexcept
+	{
+		auto entry = std::find_if(in_snapshot.m_entries.begin(), in_snapshot.m_entries.end(), [=](const IC::ErrorTelemetryEntry& in_entry)
+		{
+			return in_entry.m_errorCode == static_cast<std::int64_t>(in_error);
+		});
+		return entry != in_snapshot.m_entries.end() ? *entry : IC::ErrorTelemetryEntry();
+	}
+
+	/// Checks that a counter has the expected value.
+	///
+	/// @return Whether or not it did.
+	///
+	bool check(const char* in_name, std::uint64_t in_value, std::uint64_t in_expected) noexcept
+	{
+		if (in_value != in_expected)
+		{
+			std::fprintf(stderr, "Expected %s to be %llu, but it was %llu.\n", in_name, static_cast<unsigned long long>(in_expected), static_cast<unsigned long long>(in_value));
+			return false;
+		}
+		return true;
+	}
+}
+
+int main()
+{
+	IC::Benchmark::report(IC::Benchmark::measure(k_prefix + "success", k_iterations, [](std::uint64_t in_index)
+	{
+		auto result = succeed(in_index);
+		IC::Benchmark::doNotOptimise(result);
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure(k_prefix + "fail/static", k_iterations, [](std::uint64_t)
+	{
+		auto result = failStatic(LookupError::k_static);
+		IC::Benchmark::doNotOptimise(result);
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure(k_prefix + "fail/message", k_iterations, [](std::uint64_t)
+	{
+		auto result = failMessage();
+		IC::Benchmark::doNotOptimise(result);
+	}));
+
+	IC::Benchmark::report(IC::Benchmark::measure(k_prefix + "fail/wrapped/depth:" + std::to_string(k_wrapDepth), k_wrapIterations, [](std::uint64_t)
+	{
+		auto result = failWrapped(k_wrapDepth);
+		IC::Benchmark::doNotOptimise(result);
+	}));
+
+	auto threads = std::max(2u, std::thread::hardware_concurrency());
+	IC::Benchmark::report(IC::Benchmark::measureThreads(k_prefix + "fail/static/threads:" + std::to_string(threads), threads, k_threadIterations, [](std::uint64_t)
+	{
+		auto result = failStatic(LookupError::k_threaded);
+		IC::Benchmark::doNotOptimise(result);
+	}));
+
+	IC::Benchmark::reportValue(k_prefix + "sizeof/ErrorNode", "bytes", sizeof(IC::ErrorNode));
+
+	auto snapshot = IC::getErrorTelemetrySnapshot();
+	IC::Benchmark::reportValue(k_prefix + "snapshot/entries", "count", snapshot.m_entries.size());
+
+	bool passed = true;
+	if (k_telemetryEnabled)
+	{
+		passed &= check("the static failures", findEntry(snapshot, LookupError::k_static).m_failures, k_iterations);
+		passed &= check("the message failures", findEntry(snapshot, LookupError::k_message).m_failures, k_iterations);
+		passed &= check("the message bytes", findEntry(snapshot, LookupError::k_message).m_messageBytes, k_iterations * k_message.size());
+		passed &= check("the threaded failures", findEntry(snapshot, LookupError::k_threaded).m_failures, threads * k_threadIterations);
+		passed &= check("the wrapped failures", findEntry(snapshot, LookupError::k_wrapped).m_failures, k_wrapIterations * k_wrapDepth);
+		passed &= check("the wrapped shares", findEntry(snapshot, LookupError::k_wrapped).m_shares, k_wrapIterations * (k_wrapDepth - 1));
+		passed &= check("the chains of depth 8 to 15", snapshot.m_chainDepths[IC::Detail::getChainDepthBucket(k_wrapDepth)], k_wrapIterations);
+		passed &= check("the untracked events", snapshot.m_untrackedEvents, 0);
+	}
+	else
+	{
+		passed &= check("the number of entries", snapshot.m_entries.size(), 0);
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+// TraverseBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures running a function which returns a Result over a range of items with
+// traverse(), compared with running it on a single thread, and on hand written threads
+// which don't stop when an item fails. When an item early in the range fails, traverse()
+// must cancel most of the remaining items, and the values, references and errors it
+// collects, including for functions which return no value, must be correct; these are checked, and the benchmark exits with a failure
+// code if they don't hold.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -pthread -I.. TraverseBenchmark.cpp -o TraverseBenchmark
+//     ./TraverseBenchmark
+
+#include "Benchmark.h"
+#include "../Traverse.h"
+
+#include <cstdio>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr std::size_t k_itemCount = 200000;
+	constexpr std::uint64_t k_iterations = 5;
+	constexpr std::size_t k_noFailure = ~std::size_t(0);
+
+	/// The number of items the function has been run for, used to measure how many
+	/// items were cancelled.
+	///
+	std::atomic<std::size_t> g_itemsRun(0);
+
+	/// Does a small, fixed amount of work for an item, failing if it is the given item.
+	///
+	IC_BENCHMARK_NOINLINE IC::BoolResult<std::uint64_t> process(std::size_t in_item, std::size_t in_failingItem) noexcept
+	{
+		g_itemsRun.fetch_add(1, std::memory_order_relaxed);
+
+		std::uint64_t hash = in_item;
+		for (int round = 0; round < 200; ++round)
+		{
+			hash = (hash ^ (hash >> 29)) * 0xBF58476D1CE4E5B9ull;
+		}
+
+		if (in_item == in_failingItem || (in_failingItem == k_noFailure - 1 && in_item % 1000 == 999))
+		{
+			return IC::BoolResult<std::uint64_t>(false, IC::deferMessage("Could not process item {}.", in_item));
+		}
+		return IC::BoolResult<std::uint64_t>(hash);
+	}
+
+	//-----------------------------------------------------------------------------
+	IC::BoolResult<std::vector<std::uint64_t>> runSequential(const std::vector<std::size_t>& in_items, std::size_t in_failingItem) noexcept
+	{
+		std::vector<std::uint64_t> values;
+		values.reserve(in_items.size());
+		for (auto item : in_items)
+		{
+			auto result = process(item, in_failingItem);
+			if (!result)
+			{
+				return IC::BoolResult<std::vector<std::uint64_t>>(result);
+			}
+			values.push_back(result.getValue());
+		}
+		return IC::BoolResult<std::vector<std::uint64_t>>(std::move(values));
+	}
+
+	/// Splits the items evenly between threads, with no cancellation, in the way this
+	/// was written before traverse().
+	///
+	IC::BoolResult<std::vector<std::uint64_t>> runManualThreads(const std::vector<std::size_t>& in_items, std::size_t in_failingItem, std::size_t in_threadCount) noexcept
+	{
+		std::vector<IC::BoolResult<std::uint64_t>> results(in_items.size(), IC::BoolResult<std::uint64_t>(0));
+		std::vector<std::thread> threads;
+		for (std::size_t thread = 0; thread < in_threadCount; ++thread)
+		{
+			threads.emplace_back([&, thread]()
+			{
+				auto begin = in_items.size() * thread / in_threadCount;
+				auto end = in_items.size() * (thread + 1) / in_threadCount;
+				for (auto index = begin; index < end; ++index)
+				{
+					results[index] = process(in_items[index], in_failingItem);
+				}
+			});
+		}
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+
+		std::vector<std::uint64_t> values;
+		values.reserve(in_items.size());
+		for (auto& result : results)
+		{
+			if (!result)
+			{
+				return IC::BoolResult<std::vector<std::uint64_t>>(result);
+			}
+			values.push_back(result.getValue());
+		}
+		return IC::BoolResult<std::vector<std::uint64_t>>(std::move(values));
+	}
+
+	/// Checks a condition, printing the message if it doesn't hold.
+	///
+	/// @return The condition.
+	///
+	bool check(bool in_condition, const std::string& in_message) noexcept
+	{
+		if (!in_condition)
+		{
+			std::fprintf(stderr, "%s\n", in_message.c_str());
+		}
+		return in_condition;
+	}
+
+	/// Reports the measurement along with the average number of items run.
+	///
+	/// @return The average number of items run per iteration.
+	///
+	template <typename TFunction> std::size_t measureAndReport(const std::string& in_name, TFunction&& in_function) noexcept
+	{
+		g_itemsRun = 0;
+		IC::Benchmark::report(IC::Benchmark::measure(in_name, k_iterations, in_function));
+		auto itemsRun = g_itemsRun.load() / k_iterations;
+		IC::Benchmark::reportValue(in_name, "items_run", itemsRun);
+		return itemsRun;
+	}
+}
+
+int main()
+{
+	bool passed = true;
+
+	std::vector<std::size_t> items(k_itemCount);
+	std::iota(items.begin(), items.end(), std::size_t(0));
+
+	IC::ThreadPool pool;
+	auto threadCount = pool.getThreadCount() + 1;
+	auto suffix = "/items:" + std::to_string(k_itemCount) + "/threads:" + std::to_string(threadCount);
+
+	struct Case
+	{
+		const char* m_name;
+		std::size_t m_failingItem;
+	};
+	const Case k_cases[] = { { "success", k_noFailure }, { "fail_at_1%", k_itemCount / 100 } };
+
+	for (auto& testCase : k_cases)
+	{
+		auto failingItem = testCase.m_failingItem;
+		auto name = std::string(testCase.m_name) + suffix;
+
+		measureAndReport("sequential/" + name, [&](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(runSequential(items, failingItem));
+		});
+
+		measureAndReport("manual_threads/" + name, [&](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(runManualThreads(items, failingItem, threadCount));
+		});
+
+		auto itemsRun = measureAndReport("traverse/" + name, [&](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(IC::traverse(pool, items, [failingItem](std::size_t in_item)
+			{
+				return process(in_item, failingItem);
+			}));
+		});
+
+		auto expected = runSequential(items, failingItem);
+		auto actual = IC::traverse(pool, items, [failingItem](std::size_t in_item)
+		{
+			return process(in_item, failingItem);
+		});
+
+		if (failingItem == k_noFailure)
+		{
+			passed &= check(actual && actual.getValue() == expected.getValue(), "traverse() should collect every value in order.");
+		}
+		else
+		{
+			passed &= check(!actual && actual.getErrorMessage() == expected.getErrorMessage(), "traverse() should return the failure.");
+			passed &= check(itemsRun < k_itemCount / 2, "traverse() should cancel most items after an early failure.");
+		}
+	}
+
+	auto allErrors = IC::traverse(pool, items, [](std::size_t in_item)
+	{
+		return process(in_item, k_noFailure - 1);
+	}, IC::TraverseMode::k_allErrors);
+
+	std::size_t causeCount = 0;
+	bool causesInOrder = true;
+	for (auto& cause : allErrors.getCauses())
+	{
+		auto item = std::to_string(causeCount * 1000 + 999);
+		causesInOrder &= cause.getErrorMessage() == "Item " + item + " failed." && cause.getCausedBy() && cause.getCausedBy()->getErrorMessage() == "Could not process item " + item + ".";
+		++causeCount;
+	}
+
+	auto failureCount = k_itemCount / 1000;
+	passed &= check(!allErrors && allErrors.getErrorMessage() == std::to_string(failureCount) + " of " + std::to_string(k_itemCount) + " items failed.", "traverse() should report the number of failures.");
+	passed &= check(causeCount == failureCount && allErrors.getCauses().getSize() == failureCount, "traverse() should keep every failure as a cause.");
+	passed &= check(causesInOrder, "traverse() should keep the failures in order, each with its own cause.");
+
+	auto references = IC::traverse(pool, items, [](const std::size_t& in_item)
+	{
+		return IC::BoolResult<const std::size_t&>(in_item);
+	}, IC::TraverseMode::k_firstError, 1);
+
+	bool referencesItems = references && references.getValue().size() == items.size();
+	for (std::size_t index = 0; referencesItems && index < items.size(); ++index)
+	{
+		referencesItems &= &references.getValue()[index].get() == &items[index];
+	}
+	passed &= check(referencesItems, "traverse() should collect references to every item, in order, with any grain size.");
+
+	auto validate = [](std::size_t in_failingItem)
+	{
+		return [in_failingItem](std::size_t in_item)
+		{
+			return process(in_item, in_failingItem) ? IC::BoolError() : IC::BoolError(false, IC::deferMessage("Item {} is invalid.", in_item));
+		};
+	};
+	auto valid = IC::traverse(pool, items, validate(k_noFailure));
+	auto firstInvalid = IC::traverse(pool, items, validate(k_itemCount / 100));
+	auto allInvalid = IC::traverse(pool, items, validate(k_noFailure - 1), IC::TraverseMode::k_allErrors);
+	passed &= check(valid.wasSuccessful(), "traverse() should succeed when no item fails a validation.");
+	passed &= check(!firstInvalid && firstInvalid.getErrorMessage() == "Item " + std::to_string(k_itemCount / 100) + " is invalid.", "traverse() should return the first failed validation.");
+	passed &= check(!allInvalid && allInvalid.getCauses().getSize() == failureCount, "traverse() should keep every failed validation as a cause.");
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,232 @@
+// TryBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures passing a failure up through a number of layers unchanged, using IC_TRY and,
+// when built as C++20, co_await, compared with wrapping the failure at each layer. The
+// forwarded failure must be the original error rather than a copy or a wrapper, and
+// forwarding must make no allocation and add no reference to the error node; these are
+// checked, and the benchmark exits with
+// a failure code if they don't hold. Coroutine frames are allocated from the error
+// node pool, so the coroutine cases are warmed up before being measured.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. TryBenchmark.cpp -o TryBenchmark
+//     ./TryBenchmark
+//
+// Or, to include the coroutine cases:
+//
+//     g++ -std=c++20 -O2 -I.. TryBenchmark.cpp -o TryBenchmarkCoroutines
+//     ./TryBenchmarkCoroutines
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	enum class LayerError
+	{
+		k_success,
+		k_failed
+	};
+
+	/// Counts the references added to error nodes, so that forwarding can be checked
+	/// not to add any.
+	///
+	struct CountingRefCount final
+	{
+		static std::uint64_t s_increments;
+
+		/// @param io_count - The reference count to increment.
+		///
+		static void increment(std::atomic<std::uint32_t>& io_count) noexcept
+		{
+			++s_increments;
+			IC::AtomicRefCount::increment(io_count);
+		}
+
+		/// @param io_count - The reference count to decrement.
+		///
+		/// @return Whether or not the last reference was removed.
+		///
+		static bool decrement(std::atomic<std::uint32_t>& io_count) noexcept
+		{
+			return IC::AtomicRefCount::decrement(io_count);
+		}
+	};
+
+	std::uint64_t CountingRefCount::s_increments = 0;
+
+	/// The default policy, with the references added to error nodes counted.
+	///
+	struct CountingPolicy : IC::DefaultResultPolicy
+	{
+		using RefCount = CountingRefCount;
+	};
+
+	using LayerResult = IC::Result<int, LayerError, LayerError::k_success, CountingPolicy>;
+	using LayerErrorResult = IC::Error<LayerError, LayerError::k_success, CountingPolicy>;
+
+	const int k_depths[] = { 1, 8, 32 };
+
+	/// The failure returned by the lowest layer. This is created once, so that only the
+	/// cost of passing it up is measured.
+	///
+	const LayerResult& getLowestFailure() noexcept
+	{
+		static const LayerResult s_failure(LayerError::k_failed, "The lowest layer failed.");
+		return s_failure;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LayerResult getLowest() noexcept
+	{
+		return getLowestFailure();
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LayerResult forwardWithTry(int in_depth) noexcept
+	{
+		if (in_depth <= 1)
+		{
+			return getLowest();
+		}
+
+		IC_TRY_ASSIGN(auto value, forwardWithTry(in_depth - 1));
+		return value + 1;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LayerErrorResult forwardWithTryToError(int in_depth) noexcept
+	{
+		IC_TRY(forwardWithTry(in_depth));
+		return LayerErrorResult();
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LayerResult wrap(int in_depth) noexcept
+	{
+		if (in_depth <= 1)
+		{
+			return getLowest();
+		}
+
+		auto result = wrap(in_depth - 1);
+		if (!result)
+		{
+			return LayerResult(LayerError::k_failed, IC::StaticMessage("A layer failed."), result);
+		}
+		return result.getValue() + 1;
+	}
+
+#ifdef IC_RESULT_HAS_COROUTINES
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE LayerResult forwardWithCoroutine(int in_depth) noexcept
+	{
+		if (in_depth <= 1)
+		{
+			co_return getLowest();
+		}
+
+		auto value = co_await forwardWithCoroutine(in_depth - 1);
+		co_return value + 1;
+	}
+#endif
+
+	//-----------------------------------------------------------------------------
+	bool check(bool in_condition, const std::string& in_message) noexcept
+	{
+		if (!in_condition)
+		{
+			std::fprintf(stderr, "%s\n", in_message.c_str());
+		}
+		return in_condition;
+	}
+
+	/// Measures passing the lowest failure up through each depth, and checks that the
+	/// failure arrives unchanged, without allocating, and with only the reference added
+	/// when the lowest layer copies it.
+	///
+	/// @param in_name - The name of the method of forwarding.
+	/// @param in_function - Forwards the failure through the given number of layers.
+	///
+	/// @return Whether the checks passed.
+	///
+	template <typename TFunction> bool benchmarkForwarding(const std::string& in_name, TFunction in_function) noexcept
+	{
+		bool passed = true;
+		for (auto depth : k_depths)
+		{
+			auto result = in_function(depth);
+			passed &= check(!result && result.getErrorMessage().data() == getLowestFailure().getErrorMessage().data() && !result.getCausedBy(), in_name + " should forward the original error.");
+
+			auto increments = CountingRefCount::s_increments;
+			IC::Benchmark::doNotOptimise(in_function(depth));
+			passed &= check(CountingRefCount::s_increments - increments == 1, in_name + " should not add a reference to the error node.");
+
+			auto measurement = IC::Benchmark::measure("forward/" + in_name + "/depth:" + std::to_string(depth), 2000000 / depth, [&in_function, depth](std::uint64_t)
+			{
+				IC::Benchmark::doNotOptimise(in_function(depth));
+			});
+			IC::Benchmark::report(measurement);
+			passed &= check(measurement.m_allocationsPerOp == 0.0, in_name + " should not allocate.");
+		}
+		return passed;
+	}
+}
+
+int main()
+{
+	bool passed = true;
+
+	passed &= benchmarkForwarding("try", [](int in_depth)
+	{
+		return forwardWithTry(in_depth);
+	});
+	passed &= benchmarkForwarding("try_to_error", [](int in_depth)
+	{
+		return forwardWithTryToError(in_depth);
+	});
+#ifdef IC_RESULT_HAS_COROUTINES
+	passed &= benchmarkForwarding("coroutine", [](int in_depth)
+	{
+		return forwardWithCoroutine(in_depth);
+	});
+#endif
+
+	for (auto depth : k_depths)
+	{
+		IC::Benchmark::report(IC::Benchmark::measure("wrap/depth:" + std::to_string(depth), 2000000 / depth, [depth](std::uint64_t)
+		{
+			IC::Benchmark::doNotOptimise(wrap(depth));
+		}));
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+// ValueMoveBenchmark.cpp
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+// Measures returning a large buffer up through several layers of functions, each of
+// which returns a Result. When the value is moved from layer to layer the buffer itself
+// is the only allocation; this is checked, and the benchmark exits with a failure code
+// if the buffer is copied, if moving a failure touches the reference count of its
+// error node, if a failure which has been moved from doesn't report the moved from
+// message, or if a move assignment which throws changes the result assigned to.
+//
+// To build and run:
+//
+//     g++ -std=c++17 -O2 -I.. ValueMoveBenchmark.cpp -o ValueMoveBenchmark
+//     ./ValueMoveBenchmark
+
+#include "Benchmark.h"
+#include "../Result.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using Buffer = std::vector<char>;
+
+	/// Counts the references added to error nodes, so that moves can be checked not to
+	/// add any.
+	///
+	struct CountingRefCount final
+	{
+		static std::uint64_t s_increments;
+
+		/// @param io_count - The reference count to increment.
+		///
+		static void increment(std::atomic<std::uint32_t>& io_count) noexcept
+		{
+			++s_increments;
+			IC::AtomicRefCount::increment(io_count);
+		}
+
+		/// @param io_count - The reference count to decrement.
+		///
+		/// @return Whether or not the last reference was removed.
+		///
+		static bool decrement(std::atomic<std::uint32_t>& io_count) noexcept
+		{
+			return IC::AtomicRefCount::decrement(io_count);
+		}
+	};
+
+	std::uint64_t CountingRefCount::s_increments = 0;
+
+	/// A policy which counts the references added to error nodes.
+	///
+	struct CountingPolicy : IC::DefaultResultPolicy
+	{
+		using RefCount = CountingRefCount;
+	};
+
+	/// A value whose move constructor can throw.
+	///
+	struct ThrowingValue final
+	{
+		/// @param in_throwOnMove - Whether moving the value should throw.
+		///
+		explicit ThrowingValue(bool in_throwOnMove) noexcept
+			: m_throwOnMove(in_throwOnMove)
+		{
+		}
+
+		//-----------------------------------------------------------------------------
+		ThrowingValue(ThrowingValue&& in_toMove) noexcept(false)
+			: m_throwOnMove(in_toMove.m_throwOnMove)
+		{
+			if (m_throwOnMove)
+			{
+				throw std::runtime_error("The value could not be moved.");
+			}
+		}
+
+		ThrowingValue& operator=(ThrowingValue&&) = default;
+
+		bool m_throwOnMove;
+	};
+
+	constexpr std::size_t k_bufferSize = 4 * 1024 * 1024;
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::BoolResult<Buffer> load() noexcept
+	{
+		return IC::BoolResult<Buffer>(std::in_place, k_bufferSize, '\0');
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::BoolResult<Buffer> decompress() noexcept
+	{
+		auto result = load();
+		if (!result)
+		{
+			return IC::BoolResult<Buffer>(false, IC::StaticMessage("Could not decompress the buffer."), result);
+		}
+		return result;
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::BoolResult<Buffer> validate() noexcept
+	{
+		auto result = decompress();
+		if (!result)
+		{
+			return IC::BoolResult<Buffer>(false, IC::StaticMessage("Could not validate the buffer."), result);
+		}
+		return std::move(result).getValue();
+	}
+
+	//-----------------------------------------------------------------------------
+	IC_BENCHMARK_NOINLINE IC::BoolResult<Buffer> validateCopy() noexcept
+	{
+		const auto result = decompress();
+		if (!result)
+		{
+			return IC::BoolResult<Buffer>(false, IC::StaticMessage("Could not validate the buffer."), result);
+		}
+		return result.getValue();
+	}
+}
+
+int main()
+{
+	int exitCode = 0;
+
+	auto moved = IC::Benchmark::measure("layers:3/move", 200, [](std::uint64_t)
+	{
+		auto buffer = validate().getValue();
+		IC::Benchmark::doNotOptimise(buffer.data());
+	});
+	IC::Benchmark::report(moved);
+	if (moved.m_allocationsPerOp != 1.0)
+	{
+		std::fprintf(stderr, "Expected only the buffer to be allocated, but %.3f allocations were made.\n", moved.m_allocationsPerOp);
+		exitCode = 1;
+	}
+
+	IC::Benchmark::report(IC::Benchmark::measure("layers:3/copy", 200, [](std::uint64_t)
+	{
+		const auto result = validateCopy();
+		IC::Benchmark::doNotOptimise(result.getValue().data());
+	}));
+
+	IC::BoolResult<Buffer, CountingPolicy> failure(false, "The buffer could not be loaded.");
+	auto increments = CountingRefCount::s_increments;
+	auto movedFailure = std::move(failure);
+	IC::BoolResult<Buffer, CountingPolicy> assignedFailure(std::in_place);
+	assignedFailure = std::move(movedFailure);
+	if (CountingRefCount::s_increments != increments)
+	{
+		std::fprintf(stderr, "Expected moving a failure not to add a reference to its error node.\n");
+		exitCode = 1;
+	}
+	if (failure || movedFailure || failure.getErrorMessage() != IC::Detail::k_movedFromMessage || movedFailure.getFullErrorMessage() != IC::Detail::k_movedFromMessage || assignedFailure.getErrorMessage() != "The buffer could not be loaded.")
+	{
+		std::fprintf(stderr, "Expected a failure which has been moved from to report the moved from message.\n");
+		exitCode = 1;
+	}
+
+#ifdef __cpp_exceptions
+	IC::BoolResult<ThrowingValue> throwing(std::in_place, true);
+	IC::BoolResult<ThrowingValue> assignedTo(false, "The value was not found.");
+	try
+	{
+		assignedTo = std::move(throwing);
+	}
+	catch (const std::runtime_error&)
+	{
+	}
+	if (assignedTo || assignedTo.getErrorMessage() != "The value was not found.")
+	{
+		std::fprintf(stderr, "Expected a move assignment which throws to leave the result unchanged.\n");
+		exitCode = 1;
+	}
+#endif
+
+	return exitCode;
+}
@@ -0,0 +1,259 @@
+// DeferredMessage.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_DEFERREDMESSAGE_H_
+#define _IC_DEFERREDMESSAGE_H_
+
+#include "ErrorNode.h"
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace IC
+{
+	/// An error message which has not yet been formatted. This stores a format template
+	/// and the arguments which should be substituted into it, and only builds the final
+	/// string the first time the message is read. As most errors are handled without
+	/// ever being printed, this avoids paying for formatting which is never used.
+	///
+	/// Only the formatting is deferred. The template and arguments are stored in an
+	/// error node, so each failure still makes one allocation from the policy's
+	/// allocator; with the default PoolErrorAllocator this is usually served from the
+	/// calling thread's free list rather than the global heap. Results don't store the
+	/// arguments inline, as their types vary with every call site.
+	///
+	/// The template uses "{}" as the placeholder for each argument, in order:
+	///
+	///     return IC::BoolResult<Item>(false, IC::deferMessage("Key {} not found in '{}'.", key, path));
+	///
+	/// The template must be a string literal, or otherwise outlive the result, as only a
+	/// pointer to it is stored. Arguments are stored by value, however pointer arguments
+	/// such as const char* will only have the pointer stored. Pass a std::string instead
+	/// if the pointed to data might not outlive the result.
+	///
+	template <typename... TArgs> class DeferredMessage final
+	{
+	public:
+		/// @param in_format - The format template. This must outlive the message.
+		/// @param in_arguments - The arguments to substitute into the template.
+		///
+		template <typename... TArgsIn> explicit DeferredMessage(const char* in_format, TArgsIn&&... in_arguments) noexcept
+			: m_format(in_format), m_arguments(std::forward<TArgsIn>(in_arguments)...)
+		{
+		}
+
+		/// @return The format template.
+		///
+		const char* getFormat() const noexcept
+		{
+			return m_format;
+		}
+
+		/// Substitutes each argument into the next "{}" in the template. Any arguments
+		/// beyond the number of placeholders are ignored.
+		///
+		/// @return The formatted message.
+		///
+		std::string format() const noexcept;
+
+	private:
+		const char* m_format;
+		std::tuple<TArgs...> m_arguments;
+	};
+
+	/// Creates a deferred message with the given template and arguments. The arguments
+	/// are decayed and stored by value.
+	///
+	/// @param in_format - The format template. This must outlive the message.
+	/// @param in_arguments - The arguments to substitute into the template.
+	///
+	/// @return The deferred message.
+	///
+	template <typename... TArgs> DeferredMessage<typename std::decay<TArgs>::type...> deferMessage(const char* in_format, TArgs&&... in_arguments) noexcept
+	{
+		return DeferredMessage<typename std::decay<TArgs>::type...>(in_format, std::forward<TArgs>(in_arguments)...);
+	}
+
+	namespace Detail
+	{
+		//-----------------------------------------------------------------------------
+		inline void appendArgument(std::string& io_message, const std::string& in_argument) noexcept
+		{
+			io_message += in_argument;
+		}
+
+		//-----------------------------------------------------------------------------
+		inline void appendArgument(std::string& io_message, std::string_view in_argument) noexcept
+		{
+			io_message += in_argument;
+		}
+
+		//-----------------------------------------------------------------------------
+		inline void appendArgument(std::string& io_message, const char* in_argument) noexcept
+		{
+			io_message += in_argument ? in_argument : "(null)";
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TArg> void appendArgument(std::string& io_message, const TArg& in_argument) noexcept
+		{
+			if constexpr (std::is_same<TArg, bool>::value)
+			{
+				io_message += in_argument ? "true" : "false";
+			}
+			else if constexpr (std::is_same<TArg, char>::value)
+			{
+				io_message += in_argument;
+			}
+			else if constexpr (std::is_integral<TArg>::value)
+			{
+				io_message += std::to_string(in_argument);
+			}
+			else if constexpr (std::is_floating_point<TArg>::value)
+			{
+				char buffer[32];
+				std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(in_argument));
+				io_message += buffer;
+			}
+			else if constexpr (std::is_enum<TArg>::value)
+			{
+				io_message += std::to_string(static_cast<typename std::underlying_type<TArg>::type>(in_argument));
+			}
+			else if constexpr (std::is_convertible<const TArg&, std::string>::value)
+			{
+				io_message += std::string(in_argument);
+			}
+			else
+			{
+				std::ostringstream stream;
+				stream << in_argument;
+				io_message += stream.str();
+			}
+		}
+
+		/// Appends the template text up to the next placeholder, followed by the argument,
+		/// then moves the cursor past the placeholder. If there are no placeholders left
+		/// the argument is ignored.
+		///
+		template <typename TArg> void appendUntilPlaceholder(std::string& io_message, const char*& io_cursor, const TArg& in_argument) noexcept
+		{
+			auto placeholder = std::strstr(io_cursor, "{}");
+			if (!placeholder)
+			{
+				return;
+			}
+
+			io_message.append(io_cursor, placeholder);
+			appendArgument(io_message, in_argument);
+			io_cursor = placeholder + 2;
+		}
+
+		/// The error node created for each failed result with a deferred message. This
+		/// holds the template and the arguments, and the message is formatted the first
+		/// time it is requested and cached for subsequent calls.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy, typename... TArgs> class DeferredErrorNode final : public TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>
+		{
+		public:
+			//-----------------------------------------------------------------------------
+			DeferredErrorNode(TError in_error, DeferredMessage<TArgs...>&& in_errorMessage, ErrorNodePtr in_causedBy) noexcept
+				: TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>(TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>::template getNodeDescriptor<DeferredErrorNode>(), in_error, std::move(in_causedBy)), m_deferredMessage(std::move(in_errorMessage))
+			{
+			}
+
+			//-----------------------------------------------------------------------------
+			static std::string_view readErrorMessage(const ErrorNode& in_node) noexcept
+			{
+				auto& node = static_cast<const DeferredErrorNode&>(in_node);
+				std::call_once(node.m_formatFlag, [&node]()
+				{
+					node.m_errorMessage = node.m_deferredMessage.format();
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+					recordMessageTelemetry(node.getError(), node.m_errorMessage.capacity());
+#endif
+				});
+
+				return node.m_errorMessage;
+			}
+
+			//-----------------------------------------------------------------------------
+			static const char* readMessageTemplate(const ErrorNode& in_node) noexcept
+			{
+				return static_cast<const DeferredErrorNode&>(in_node).m_deferredMessage.getFormat();
+			}
+
+			//-----------------------------------------------------------------------------
+			std::size_t getAllocationSize() const noexcept
+			{
+				return sizeof(DeferredErrorNode);
+			}
+
+		private:
+			const DeferredMessage<TArgs...> m_deferredMessage;
+			mutable std::once_flag m_formatFlag;
+			mutable std::string m_errorMessage;
+		};
+
+		/// Creates the node for a deferred message. If the allocator of the policy fails,
+		/// formatting the message later would most likely fail too, so the node is instead
+		/// created from the emergency reserve with the format template as a static message.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy, typename... TArgs> ErrorNodePtr makeErrorNode(TError in_error, DeferredMessage<TArgs...>&& in_errorMessage, ErrorNodePtr in_causedBy) noexcept
+		{
+			using Node = DeferredErrorNode<TError, TErrorSuccess, TPolicy, TArgs...>;
+
+			if (auto memory = allocateNodeMemory<TPolicy>(sizeof(Node)))
+			{
+				return ErrorNodePtr(new (memory) Node(in_error, std::move(in_errorMessage), std::move(in_causedBy)));
+			}
+
+			return makeErrorNode<TError, TErrorSuccess, TPolicy>(in_error, StaticMessage(in_errorMessage.getFormat()), std::move(in_causedBy));
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename... TArgs> std::string DeferredMessage<TArgs...>::format() const noexcept
+	{
+		std::string message;
+		message.reserve(std::strlen(m_format) + 16 * sizeof...(TArgs));
+
+		auto cursor = m_format;
+		std::apply([&message, &cursor](const TArgs&... in_arguments)
+		{
+			(Detail::appendUntilPlaceholder(message, cursor, in_arguments), ...);
+		}, m_arguments);
+
+		message += cursor;
+		return message;
+	}
+}
+
+#endif
@@ -0,0 +1,213 @@
+// ErrorAggregator.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORAGGREGATOR_H_
+#define _IC_ERRORAGGREGATOR_H_
+
+#include "ErrorNode.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace IC
+{
+	/// The repeats of a single failure recorded by an ErrorAggregator during a window.
+	///
+	struct AggregatedError final
+	{
+		/// The fingerprint shared by every repeat. See ErrorNode::getFingerprint().
+		///
+		std::uint64_t m_fingerprint = 0;
+
+		/// The first failure recorded with the fingerprint during the window. Its full
+		/// error message can be used to represent every repeat.
+		///
+		ErrorNodePtr m_representative;
+
+		/// The number of failures recorded with the fingerprint during the window.
+		///
+		std::uint64_t m_count = 0;
+
+		/// When the first and the last failure with the fingerprint were recorded.
+		///
+		std::chrono::steady_clock::time_point m_firstSeen;
+		std::chrono::steady_clock::time_point m_lastSeen;
+	};
+
+	/// The failures recorded by an ErrorAggregator between two calls to flush().
+	///
+	struct ErrorAggregatorWindow final
+	{
+		/// When the window started and ended.
+		///
+		std::chrono::steady_clock::time_point m_start;
+		std::chrono::steady_clock::time_point m_end;
+
+		/// The failures recorded during the window, ordered by count, highest first.
+		///
+		std::vector<AggregatedError> m_errors;
+
+		/// The number of failures which weren't aggregated as the window already held
+		/// the maximum number of distinct fingerprints.
+		///
+		std::uint64_t m_overflowCount = 0;
+	};
+
+	/// Collapses repeats of the same failure into a count, so that a burst of identical
+	/// errors, for example from a degraded dependency, produces one message rather than
+	/// thousands. Failures are identified by their fingerprint, which is calculated from
+	/// the error types, values and message templates of the cause chain without ever
+	/// formatting a message. Messages built dynamically are identified by their text.
+	///
+	/// Failures may be recorded from any number of threads at once. The table is split
+	/// into shards, each with its own lock, so threads recording different failures
+	/// rarely contend. flush() should be called periodically, for example once a second,
+	/// to emit one representative chain and its statistics per fingerprint:
+	///
+	///     if (aggregator.record(result))
+	///     {
+	///         // The first occurrence in this window, which may be logged immediately.
+	///     }
+	///
+	///     for (auto& error : aggregator.flush().m_errors)
+	///     {
+	///         log(error.m_count, error.m_representative->getFullErrorMessage());
+	///     }
+	///
+	class ErrorAggregator final
+	{
+	public:
+		static constexpr std::size_t k_shardCount = 16;
+
+		/// @param in_maxFingerprints - The maximum number of distinct fingerprints held
+		/// in a single window. This bounds the memory used when errors are unique.
+		///
+		explicit ErrorAggregator(std::size_t in_maxFingerprints = 4096) noexcept
+			: m_maxFingerprintsPerShard(std::max<std::size_t>(1, in_maxFingerprints / k_shardCount)), m_windowStart(std::chrono::steady_clock::now())
+		{
+		}
+
+		ErrorAggregator(const ErrorAggregator&) = delete;
+		ErrorAggregator& operator=(const ErrorAggregator&) = delete;
+
+		/// Records a failure. This must not be called with a successful result.
+		///
+		/// @param in_error - The failed result, or error node, to record.
+		///
+		/// @return Whether or not this was the first failure with its fingerprint in the
+		/// current window.
+		///
+		template <typename TResult> bool record(const TResult& in_error) noexcept
+		{
+			auto fingerprint = in_error.getFingerprint();
+			auto now = std::chrono::steady_clock::now();
+			auto& shard = m_shards[fingerprint % k_shardCount];
+
+			std::lock_guard<std::mutex> lock(shard.m_mutex);
+			auto entry = shard.m_errors.find(fingerprint);
+			if (entry != shard.m_errors.end())
+			{
+				++entry->second.m_count;
+				entry->second.m_lastSeen = now;
+				return false;
+			}
+
+			if (shard.m_errors.size() >= m_maxFingerprintsPerShard)
+			{
+				++shard.m_overflowCount;
+				return false;
+			}
+
+			AggregatedError& error = shard.m_errors[fingerprint];
+			error.m_fingerprint = fingerprint;
+			error.m_representative = in_error.shareError();
+			error.m_count = 1;
+			error.m_firstSeen = now;
+			error.m_lastSeen = now;
+			return true;
+		}
+
+		/// Ends the current window and starts a new one. This may be called concurrently
+		/// with record().
+		///
+		/// @return The failures recorded during the window which ended.
+		///
+		ErrorAggregatorWindow flush() noexcept
+		{
+			std::lock_guard<std::mutex> flushLock(m_flushMutex);
+
+			ErrorAggregatorWindow window;
+			window.m_start = m_windowStart;
+			window.m_end = std::chrono::steady_clock::now();
+			m_windowStart = window.m_end;
+
+			for (auto& shard : m_shards)
+			{
+				std::unordered_map<std::uint64_t, AggregatedError> errors;
+				{
+					std::lock_guard<std::mutex> lock(shard.m_mutex);
+					errors.swap(shard.m_errors);
+					window.m_overflowCount += shard.m_overflowCount;
+					shard.m_overflowCount = 0;
+				}
+
+				for (auto& error : errors)
+				{
+					window.m_errors.push_back(std::move(error.second));
+				}
+			}
+
+			std::sort(window.m_errors.begin(), window.m_errors.end(), [](const AggregatedError& in_a, const AggregatedError& in_b)
+			{
+				return in_a.m_count > in_b.m_count;
+			});
+			return window;
+		}
+
+	private:
+		/// A part of the table, padded to its own cache line so that threads recording
+		/// into different shards don't contend.
+		///
+		struct alignas(64) Shard final
+		{
+			std::mutex m_mutex;
+			std::unordered_map<std::uint64_t, AggregatedError> m_errors;
+			std::uint64_t m_overflowCount = 0;
+		};
+
+		const std::size_t m_maxFingerprintsPerShard;
+		std::array<Shard, k_shardCount> m_shards;
+		std::mutex m_flushMutex;
+		std::chrono::steady_clock::time_point m_windowStart;
+	};
+}
+
+#endif
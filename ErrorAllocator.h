@@ -0,0 +1,583 @@
+// ErrorAllocator.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORALLOCATOR_H_
+#define _IC_ERRORALLOCATOR_H_
+
+#include <assert.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/// The number of blocks in the emergency error reserve. See ErrorReserve.
+///
+#ifndef IC_RESULT_ERROR_RESERVE_BLOCKS
+#define IC_RESULT_ERROR_RESERVE_BLOCKS 64
+#endif
+
+namespace IC
+{
+	/// An error node allocator which uses the global operator new and delete.
+	///
+	/// An allocator is any type with the following static methods, and is selected with
+	/// the Allocator member of the result policy:
+	///
+	///     static void* allocate(std::size_t in_size) noexcept;
+	///     static void deallocate(void* in_memory, std::size_t in_size) noexcept;
+	///
+	/// allocate() returns null if the memory can't be allocated, in which case the error
+	/// node is allocated from the emergency reserve instead. The size passed to
+	/// deallocate() is always the size that was passed to allocate().
+	///
+	struct GlobalErrorAllocator final
+	{
+		/// @param in_size - The number of bytes to allocate.
+		///
+		/// @return The allocated memory, or null if it couldn't be allocated.
+		///
+		static void* allocate(std::size_t in_size) noexcept
+		{
+			return ::operator new(in_size, std::nothrow);
+		}
+
+		/// @param in_memory - The memory to free.
+		/// @param in_size - The size that was passed to allocate().
+		///
+		static void deallocate(void* in_memory, std::size_t in_size) noexcept
+		{
+			(void)in_size;
+			::operator delete(in_memory);
+		}
+	};
+
+	namespace Detail
+	{
+		/// A per-thread cache of freed error node blocks, split into a small number of
+		/// size classes. Allocations are served from the calling thread's cache, so under
+		/// a storm of failures no locks are taken and the global heap is rarely touched.
+		/// Blocks freed on a different thread to the one which allocated them are simply
+		/// cached by the freeing thread.
+		///
+		class ErrorNodePool final
+		{
+		public:
+			static constexpr std::size_t k_numSizeClasses = 4;
+			static constexpr std::size_t k_maxCachedBlocks = 256;
+
+			ErrorNodePool() noexcept = default;
+			ErrorNodePool(const ErrorNodePool&) = delete;
+			ErrorNodePool& operator=(const ErrorNodePool&) = delete;
+
+			/// @return The pool for the calling thread, or null if the thread is exiting and
+			/// the pool has already been destroyed.
+			///
+			static ErrorNodePool* get() noexcept
+			{
+				if (s_destroyed)
+				{
+					return nullptr;
+				}
+
+				static thread_local ErrorNodePool s_pool;
+				return &s_pool;
+			}
+
+			/// @param in_size - The number of bytes required.
+			///
+			/// @return The index of the size class which should be used, or
+			/// k_numSizeClasses if the size is too large to be pooled.
+			///
+			static std::size_t getSizeClass(std::size_t in_size) noexcept
+			{
+				std::size_t sizeClass = 0;
+				while (sizeClass < k_numSizeClasses && getBlockSize(sizeClass) < in_size)
+				{
+					++sizeClass;
+				}
+				return sizeClass;
+			}
+
+			/// @param in_sizeClass - The size class.
+			///
+			/// @return The size of the blocks in the size class.
+			///
+			static constexpr std::size_t getBlockSize(std::size_t in_sizeClass) noexcept
+			{
+				return std::size_t(64) << in_sizeClass;
+			}
+
+			/// @param in_sizeClass - The size class to allocate from.
+			///
+			/// @return A block from the size class, or null if one couldn't be allocated.
+			///
+			void* allocate(std::size_t in_sizeClass) noexcept
+			{
+				assert(in_sizeClass < k_numSizeClasses);
+
+				auto& freeList = m_freeLists[in_sizeClass];
+				if (freeList.m_head)
+				{
+					auto block = freeList.m_head;
+					freeList.m_head = block->m_next;
+					--freeList.m_count;
+					return block;
+				}
+
+				return ::operator new(getBlockSize(in_sizeClass), std::nothrow);
+			}
+
+			/// @param in_memory - The block to free.
+			/// @param in_sizeClass - The size class the block was allocated from.
+			///
+			void deallocate(void* in_memory, std::size_t in_sizeClass) noexcept
+			{
+				assert(in_sizeClass < k_numSizeClasses);
+
+				auto& freeList = m_freeLists[in_sizeClass];
+				if (freeList.m_count >= k_maxCachedBlocks)
+				{
+					::operator delete(in_memory);
+					return;
+				}
+
+				auto block = static_cast<FreeBlock*>(in_memory);
+				block->m_next = freeList.m_head;
+				freeList.m_head = block;
+				++freeList.m_count;
+			}
+
+			//-----------------------------------------------------------------------------
+			~ErrorNodePool() noexcept
+			{
+				for (auto& freeList : m_freeLists)
+				{
+					while (freeList.m_head)
+					{
+						auto block = freeList.m_head;
+						freeList.m_head = block->m_next;
+						::operator delete(block);
+					}
+				}
+
+				s_destroyed = true;
+			}
+
+		private:
+			struct FreeBlock final
+			{
+				FreeBlock* m_next;
+			};
+
+			struct FreeList final
+			{
+				FreeBlock* m_head = nullptr;
+				std::size_t m_count = 0;
+			};
+
+			static inline thread_local bool s_destroyed = false;
+
+			FreeList m_freeLists[k_numSizeClasses];
+		};
+	}
+
+	/// The default error node allocator. Nodes of up to 512 bytes are allocated from a
+	/// thread local free list pool; larger nodes use the global operator new.
+	///
+	struct PoolErrorAllocator final
+	{
+		/// @param in_size - The number of bytes to allocate.
+		///
+		/// @return The allocated memory, or null if it couldn't be allocated.
+		///
+		static void* allocate(std::size_t in_size) noexcept
+		{
+			auto sizeClass = Detail::ErrorNodePool::getSizeClass(in_size);
+			auto pool = Detail::ErrorNodePool::get();
+			if (sizeClass < Detail::ErrorNodePool::k_numSizeClasses)
+			{
+				return pool ? pool->allocate(sizeClass) : ::operator new(Detail::ErrorNodePool::getBlockSize(sizeClass), std::nothrow);
+			}
+
+			return ::operator new(in_size, std::nothrow);
+		}
+
+		/// @param in_memory - The memory to free.
+		/// @param in_size - The size that was passed to allocate().
+		///
+		static void deallocate(void* in_memory, std::size_t in_size) noexcept
+		{
+			auto sizeClass = Detail::ErrorNodePool::getSizeClass(in_size);
+			auto pool = Detail::ErrorNodePool::get();
+			if (pool && sizeClass < Detail::ErrorNodePool::k_numSizeClasses)
+			{
+				pool->deallocate(in_memory, sizeClass);
+			}
+			else
+			{
+				::operator delete(in_memory);
+			}
+		}
+	};
+
+	/// A bump allocator for the error nodes created while handling a single request or
+	/// unit of work. While a Scope is active on a thread, results using the
+	/// ArenaErrorAllocator allocate their nodes from the arena, and freeing a node does
+	/// nothing. The memory for every node is instead released in bulk when the arena is
+	/// reset or destroyed:
+	///
+	///     IC::ErrorArena arena;
+	///     {
+	///         IC::ErrorArena::Scope scope(arena);
+	///         handleRequest();
+	///     }
+	///     arena.reset();
+	///
+	/// All results whose nodes were allocated from the arena must be destroyed before it
+	/// is reset or destroyed.
+	///
+	class ErrorArena final
+	{
+	public:
+		/// Makes an arena the current arena for the calling thread for the lifetime of
+		/// the scope. Scopes can be nested.
+		///
+		class Scope final
+		{
+		public:
+			/// @param in_arena - The arena to make current.
+			///
+			explicit Scope(ErrorArena& in_arena) noexcept
+				: m_previous(s_current)
+			{
+				s_current = &in_arena;
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+			~Scope() noexcept
+			{
+				s_current = m_previous;
+			}
+
+		private:
+			ErrorArena* m_previous;
+		};
+
+		/// @param in_chunkSize - The size of each chunk of memory the arena allocates.
+		///
+		explicit ErrorArena(std::size_t in_chunkSize = 4096) noexcept
+			: m_chunkSize(in_chunkSize)
+		{
+		}
+
+		ErrorArena(const ErrorArena&) = delete;
+		ErrorArena& operator=(const ErrorArena&) = delete;
+
+		~ErrorArena() noexcept
+		{
+			releaseChunks(nullptr);
+		}
+
+		/// @return The current arena for the calling thread, or null if there isn't one.
+		///
+		static ErrorArena* getCurrent() noexcept
+		{
+			return s_current;
+		}
+
+		/// @param in_size - The number of bytes to allocate.
+		///
+		/// @return Memory from the arena, aligned to alignof(std::max_align_t), or null if
+		/// a new chunk was needed and couldn't be allocated.
+		///
+		void* allocate(std::size_t in_size) noexcept
+		{
+			in_size = (in_size + k_alignment - 1) & ~(k_alignment - 1);
+
+			if (!m_head || m_head->m_used + in_size > m_head->m_capacity)
+			{
+				auto capacity = in_size > m_chunkSize ? in_size : m_chunkSize;
+				auto chunk = static_cast<Chunk*>(::operator new(sizeof(Chunk) + capacity, std::nothrow));
+				if (!chunk)
+				{
+					return nullptr;
+				}
+
+				chunk->m_next = m_head;
+				chunk->m_capacity = capacity;
+				chunk->m_used = 0;
+				m_head = chunk;
+			}
+
+			auto memory = reinterpret_cast<unsigned char*>(m_head + 1) + m_head->m_used;
+			m_head->m_used += in_size;
+			return memory;
+		}
+
+		/// Releases the memory for every node allocated from the arena. The most recent
+		/// chunk is kept for reuse.
+		///
+		void reset() noexcept
+		{
+			if (m_head)
+			{
+				releaseChunks(m_head);
+				m_head->m_next = nullptr;
+				m_head->m_used = 0;
+			}
+		}
+
+	private:
+		static constexpr std::size_t k_alignment = alignof(std::max_align_t);
+
+		struct alignas(std::max_align_t) Chunk final
+		{
+			Chunk* m_next;
+			std::size_t m_capacity;
+			std::size_t m_used;
+		};
+
+		//-----------------------------------------------------------------------------
+		void releaseChunks(Chunk* in_keep) noexcept
+		{
+			auto chunk = m_head;
+			while (chunk)
+			{
+				auto next = chunk->m_next;
+				if (chunk != in_keep)
+				{
+					::operator delete(chunk);
+				}
+				chunk = next;
+			}
+
+			m_head = in_keep;
+		}
+
+		static inline thread_local ErrorArena* s_current = nullptr;
+
+		std::size_t m_chunkSize;
+		Chunk* m_head = nullptr;
+	};
+
+	/// An error node allocator which allocates from the current ErrorArena of the calling
+	/// thread. If there is no current arena the global heap is used instead. Each node is
+	/// prefixed with a small header recording which was used, so that nodes freed after
+	/// leaving the arena scope, or on another thread, are handled correctly.
+	///
+	struct ArenaErrorAllocator final
+	{
+		/// @param in_size - The number of bytes to allocate.
+		///
+		/// @return The allocated memory, or null if it couldn't be allocated.
+		///
+		static void* allocate(std::size_t in_size) noexcept
+		{
+			auto arena = ErrorArena::getCurrent();
+			auto memory = arena ? arena->allocate(in_size + k_headerSize) : ::operator new(in_size + k_headerSize, std::nothrow);
+			if (!memory)
+			{
+				return nullptr;
+			}
+
+			*static_cast<ErrorArena**>(memory) = arena;
+			return static_cast<unsigned char*>(memory) + k_headerSize;
+		}
+
+		/// @param in_memory - The memory to free.
+		/// @param in_size - The size that was passed to allocate().
+		///
+		static void deallocate(void* in_memory, std::size_t in_size) noexcept
+		{
+			(void)in_size;
+
+			auto memory = static_cast<unsigned char*>(in_memory) - k_headerSize;
+			if (!*reinterpret_cast<ErrorArena**>(memory))
+			{
+				::operator delete(memory);
+			}
+		}
+
+	private:
+		static constexpr std::size_t k_headerSize = alignof(std::max_align_t);
+	};
+
+	/// Describes how often the emergency error reserve has been used. See
+	/// getErrorReserveStats().
+	///
+	struct ErrorReserveStats final
+	{
+		/// The number of error nodes which have been allocated from the reserve.
+		///
+		std::uint64_t m_allocations = 0;
+
+		/// The number of those whose message was truncated to fit in a block.
+		///
+		std::uint64_t m_truncatedMessages = 0;
+
+		/// The number of causes dropped from failures with several causes, because they
+		/// didn't fit in a block.
+		///
+		std::uint64_t m_droppedCauses = 0;
+
+		/// The number of blocks currently in use.
+		///
+		std::uint32_t m_blocksInUse = 0;
+	};
+
+	namespace Detail
+	{
+		/// A bounded reserve of error node blocks, with static storage duration, which is
+		/// used when the allocator of a result policy fails. This means a failure can still
+		/// be reported when memory is exhausted, which is often when reporting it matters
+		/// most. Messages which don't fit in a block are truncated.
+		///
+		/// Blocks are claimed from a bitmask with compare and swap, so the reserve can be
+		/// used from any thread without locks. The number of blocks can be changed by
+		/// defining IC_RESULT_ERROR_RESERVE_BLOCKS, which must be a multiple of 64.
+		///
+		class ErrorReserve final
+		{
+		public:
+			static constexpr std::size_t k_blockSize = 256;
+			static constexpr std::size_t k_numBlocks = IC_RESULT_ERROR_RESERVE_BLOCKS;
+
+			static_assert(k_numBlocks > 0 && k_numBlocks % 64 == 0, "IC_RESULT_ERROR_RESERVE_BLOCKS must be a positive multiple of 64.");
+
+			/// @param in_size - The number of bytes required. This must not exceed
+			/// k_blockSize.
+			///
+			/// @return A block from the reserve, or null if every block is in use.
+			///
+			static void* allocate(std::size_t in_size) noexcept
+			{
+				assert(in_size <= k_blockSize);
+				(void)in_size;
+
+				for (std::size_t wordIndex = 0; wordIndex < k_numWords; ++wordIndex)
+				{
+					auto& word = s_used[wordIndex];
+					auto used = word.load(std::memory_order_relaxed);
+					while (used != ~std::uint64_t(0))
+					{
+						std::size_t bit = 0;
+						while ((used >> bit) & 1)
+						{
+							++bit;
+						}
+
+						if (word.compare_exchange_weak(used, used | (std::uint64_t(1) << bit), std::memory_order_acquire, std::memory_order_relaxed))
+						{
+							s_allocations.fetch_add(1, std::memory_order_relaxed);
+							return s_blocks[wordIndex * 64 + bit].m_data;
+						}
+					}
+				}
+
+				return nullptr;
+			}
+
+			/// @param in_memory - The memory to check.
+			///
+			/// @return Whether or not the memory is a block from the reserve.
+			///
+			static bool contains(const void* in_memory) noexcept
+			{
+				auto address = reinterpret_cast<std::uintptr_t>(in_memory);
+				return address >= reinterpret_cast<std::uintptr_t>(s_blocks) && address < reinterpret_cast<std::uintptr_t>(s_blocks + k_numBlocks);
+			}
+
+			/// @param in_memory - A block returned by allocate().
+			///
+			static void deallocate(void* in_memory) noexcept
+			{
+				assert(contains(in_memory));
+
+				auto index = std::size_t(static_cast<Block*>(in_memory) - s_blocks);
+				s_used[index / 64].fetch_and(~(std::uint64_t(1) << (index % 64)), std::memory_order_release);
+			}
+
+			/// Records that a message was truncated to fit in a block.
+			///
+			static void recordTruncation() noexcept
+			{
+				s_truncatedMessages.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			/// Records that causes were dropped from a failure to fit it in a block.
+			///
+			/// @param in_count - The number of causes dropped.
+			///
+			static void recordDroppedCauses(std::size_t in_count) noexcept
+			{
+				s_droppedCauses.fetch_add(in_count, std::memory_order_relaxed);
+			}
+
+			/// @return The usage of the reserve. See getErrorReserveStats().
+			///
+			static ErrorReserveStats getStats() noexcept
+			{
+				ErrorReserveStats stats;
+				stats.m_allocations = s_allocations.load(std::memory_order_relaxed);
+				stats.m_truncatedMessages = s_truncatedMessages.load(std::memory_order_relaxed);
+				stats.m_droppedCauses = s_droppedCauses.load(std::memory_order_relaxed);
+				for (auto& word : s_used)
+				{
+					for (auto used = word.load(std::memory_order_relaxed); used != 0; used &= used - 1)
+					{
+						++stats.m_blocksInUse;
+					}
+				}
+				return stats;
+			}
+
+		private:
+			static constexpr std::size_t k_numWords = k_numBlocks / 64;
+
+			struct alignas(std::max_align_t) Block final
+			{
+				unsigned char m_data[k_blockSize];
+			};
+
+			static inline Block s_blocks[k_numBlocks];
+			static inline std::atomic<std::uint64_t> s_used[k_numWords] = {};
+			static inline std::atomic<std::uint64_t> s_allocations{0};
+			static inline std::atomic<std::uint64_t> s_truncatedMessages{0};
+			static inline std::atomic<std::uint64_t> s_droppedCauses{0};
+		};
+	}
+
+	/// @return How often the emergency error reserve has been used. A failure is
+	/// allocated from the reserve when the allocator of its policy fails, so any use
+	/// indicates that memory was exhausted.
+	///
+	inline ErrorReserveStats getErrorReserveStats() noexcept
+	{
+		return Detail::ErrorReserve::getStats();
+	}
+}
+
+#endif
@@ -0,0 +1,212 @@
+// ErrorCatalog.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORCATALOG_H_
+#define _IC_ERRORCATALOG_H_
+
+#include <type_traits>
+
+namespace IC
+{
+	/// How severe an error is. This is provided by the ErrorCatalog for an error type.
+	///
+	enum class ErrorSeverity
+	{
+		k_info,
+		k_warning,
+		k_error,
+		k_fatal
+	};
+
+	/// The static description of a single error value in an ErrorCatalog.
+	///
+	template <typename TError> struct ErrorCatalogEntry final
+	{
+		TError m_error;
+		const char* m_message;
+		ErrorSeverity m_severity;
+		const char* m_category;
+	};
+
+	/// An opt-in, compile time catalog of the messages for an error type. When an error
+	/// type has a catalog, a failed Result can be created from the error alone, storing no
+	/// message and making no allocation; the message is instead looked up in the catalog
+	/// when it is read. To provide a catalog, specialise this with a constexpr array of
+	/// entries named k_entries:
+	///
+	///     template <> struct IC::ErrorCatalog<FileError>
+	///     {
+	///         static constexpr IC::ErrorCatalogEntry<FileError> k_entries[] =
+	///         {
+	///             { FileError::k_notFound, "The file was not found.", IC::ErrorSeverity::k_error, "io" },
+	///             { FileError::k_locked, "The file is locked.", IC::ErrorSeverity::k_warning, "io" },
+	///         };
+	///     };
+	///
+	///     IC::Error<FileError> openFile() { return IC::Error<FileError>(FileError::k_notFound); }
+	///
+	template <typename TError> struct ErrorCatalog
+	{
+	};
+
+	/// Whether or not an ErrorCatalog has been provided for the given error type.
+	///
+	template <typename TError, typename = void> struct HasErrorCatalog : std::false_type
+	{
+	};
+
+	template <typename TError> struct HasErrorCatalog<TError, std::void_t<decltype(ErrorCatalog<TError>::k_entries)>> : std::true_type
+	{
+	};
+
+	/// @param in_error - The error to look up.
+	///
+	/// @return The catalog entry for the given error, or null if it isn't in the catalog.
+	///
+	template <typename TError> constexpr const ErrorCatalogEntry<TError>* findErrorCatalogEntry(TError in_error) noexcept
+	{
+		static_assert(HasErrorCatalog<TError>::value, "No ErrorCatalog has been provided for this error type.");
+
+		for (const auto& entry : ErrorCatalog<TError>::k_entries)
+		{
+			if (entry.m_error == in_error)
+			{
+				return &entry;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/// @param in_error - The error to look up.
+	///
+	/// @return The catalog message for the given error, or a generic message if it isn't
+	/// in the catalog.
+	///
+	template <typename TError> constexpr const char* getErrorCatalogMessage(TError in_error) noexcept
+	{
+		static_assert(HasErrorCatalog<TError>::value, "No ErrorCatalog has been provided for this error type.");
+
+		for (const auto& entry : ErrorCatalog<TError>::k_entries)
+		{
+			if (entry.m_error == in_error)
+			{
+				return entry.m_message;
+			}
+		}
+
+		return "Unknown error.";
+	}
+
+	/// @param in_error - The error to look up.
+	///
+	/// @return The catalog severity for the given error, or k_error if it isn't in the
+	/// catalog.
+	///
+	template <typename TError> constexpr ErrorSeverity getErrorSeverity(TError in_error) noexcept
+	{
+		static_assert(HasErrorCatalog<TError>::value, "No ErrorCatalog has been provided for this error type.");
+
+		for (const auto& entry : ErrorCatalog<TError>::k_entries)
+		{
+			if (entry.m_error == in_error)
+			{
+				return entry.m_severity;
+			}
+		}
+
+		return ErrorSeverity::k_error;
+	}
+
+	/// @param in_error - The error to look up.
+	///
+	/// @return The catalog category for the given error, or an empty string if it isn't in
+	/// the catalog.
+	///
+	template <typename TError> constexpr const char* getErrorCategory(TError in_error) noexcept
+	{
+		static_assert(HasErrorCatalog<TError>::value, "No ErrorCatalog has been provided for this error type.");
+
+		for (const auto& entry : ErrorCatalog<TError>::k_entries)
+		{
+			if (entry.m_error == in_error)
+			{
+				return entry.m_category;
+			}
+		}
+
+		return "";
+	}
+
+	/// An error message with static storage duration, typically a string literal. Only
+	/// the pointer is stored, so creating a failed result with a static message doesn't
+	/// allocate or copy the text:
+	///
+	///     return IC::BoolResult<float>(false, IC::StaticMessage("Could not calculate value."));
+	///
+	class StaticMessage final
+	{
+	public:
+		/// @param in_message - The message. This must outlive any result created with it.
+		///
+		constexpr explicit StaticMessage(const char* in_message) noexcept
+			: m_message(in_message)
+		{
+		}
+
+		/// @return The message.
+		///
+		constexpr const char* get() const noexcept
+		{
+			return m_message;
+		}
+
+	private:
+		const char* m_message;
+	};
+
+	namespace Detail
+	{
+		/// @param in_error - The error which occurred.
+		/// @param in_staticMessage - The static message the error was created with. If
+		/// this is null the message is looked up in the ErrorCatalog.
+		///
+		/// @return The message describing the error.
+		///
+		template <typename TError> constexpr const char* resolveStaticMessage(TError in_error, const char* in_staticMessage) noexcept
+		{
+			if constexpr (HasErrorCatalog<TError>::value)
+			{
+				if (!in_staticMessage)
+				{
+					return getErrorCatalogMessage(in_error);
+				}
+			}
+
+			return in_staticMessage;
+		}
+	}
+}
+
+#endif
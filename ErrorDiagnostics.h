@@ -0,0 +1,288 @@
+// ErrorDiagnostics.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORDIAGNOSTICS_H_
+#define _IC_ERRORDIAGNOSTICS_H_
+
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_FILE) && __has_builtin(__builtin_LINE) && __has_builtin(__builtin_FUNCTION)
+#define IC_RESULT_HAS_SOURCE_LOCATION 1
+#endif
+#elif defined(__GNUC__) || (defined(_MSC_VER) && _MSC_VER >= 1926)
+#define IC_RESULT_HAS_SOURCE_LOCATION 1
+#endif
+
+#if defined(__has_include)
+#if __has_include(<execinfo.h>)
+#include <execinfo.h>
+#define IC_RESULT_HAS_BACKTRACE 1
+#endif
+#if __has_include(<dlfcn.h>)
+#include <dlfcn.h>
+#define IC_RESULT_HAS_DLADDR 1
+#endif
+#endif
+
+namespace IC
+{
+	/// The place in the source code a failure was created. Failure constructors take
+	/// one as a defaulted final argument, so the location of the caller is captured
+	/// automatically. It only holds pointers to the static file and function names, so
+	/// capturing it makes no allocation. The location is only stored if the policy of
+	/// the result enables it; see DefaultResultPolicy::k_captureSourceLocation.
+	///
+	/// Locations are captured with the compiler builtins std::source_location is built
+	/// on, so that they're also available in C++17. If the compiler doesn't provide
+	/// them, the location is empty.
+	///
+	class SourceLocation final
+	{
+	public:
+		constexpr SourceLocation() noexcept = default;
+
+#ifdef IC_RESULT_HAS_SOURCE_LOCATION
+		/// The arguments should be left as their defaults.
+		///
+		/// @return The location of the caller.
+		///
+		static constexpr SourceLocation current(const char* in_file = __builtin_FILE(), std::uint32_t in_line = __builtin_LINE(), const char* in_function = __builtin_FUNCTION()) noexcept
+		{
+			return SourceLocation(in_file, in_line, in_function);
+		}
+#else
+		/// @return An empty location, as the compiler can't provide the caller's.
+		///
+		static constexpr SourceLocation current() noexcept
+		{
+			return SourceLocation();
+		}
+#endif
+
+		/// @return The name of the source file, or null if the location is empty.
+		///
+		constexpr const char* getFile() const noexcept
+		{
+			return m_file;
+		}
+
+		/// @return The line number, or 0 if the location is empty.
+		///
+		constexpr std::uint32_t getLine() const noexcept
+		{
+			return m_line;
+		}
+
+		/// @return The name of the function, or null if the location is empty.
+		///
+		constexpr const char* getFunction() const noexcept
+		{
+			return m_function;
+		}
+
+		/// @return Whether or not a location was captured.
+		///
+		constexpr explicit operator bool() const noexcept
+		{
+			return m_file != nullptr;
+		}
+
+	private:
+		//-----------------------------------------------------------------------------
+		constexpr SourceLocation(const char* in_file, std::uint32_t in_line, const char* in_function) noexcept
+			: m_file(in_file), m_function(in_function), m_line(in_line)
+		{
+		}
+
+		const char* m_file = nullptr;
+		const char* m_function = nullptr;
+		std::uint32_t m_line = 0;
+	};
+
+	/// Where an error was created, stored in the same allocation as its error node when
+	/// the policy of the result enables it. See ErrorNode::getDiagnostics(). The frames
+	/// of the backtrace, if one was sampled, are stored directly before this.
+	///
+	struct ErrorDiagnostics final
+	{
+		/// @return The return addresses of the sampled backtrace, innermost first.
+		///
+		void* const* getBacktrace() const noexcept
+		{
+			return reinterpret_cast<void* const*>(this) - m_backtraceSize;
+		}
+
+		SourceLocation m_sourceLocation;
+		std::uint32_t m_backtraceSize = 0;
+	};
+
+	namespace Detail
+	{
+		/// Decides which failures record a backtrace. Each thread counts its own
+		/// failures, so sampling takes no locks and no shared writes.
+		///
+		class ErrorBacktraceSampler final
+		{
+		public:
+			static constexpr std::uint32_t k_maxFrames = 32;
+
+			/// @param in_sampleRate - See setErrorBacktraceSampleRate().
+			///
+			static void setSampleRate(std::uint32_t in_sampleRate) noexcept
+			{
+				s_sampleRate.store(in_sampleRate, std::memory_order_relaxed);
+			}
+
+			//-----------------------------------------------------------------------------
+			static std::uint32_t getSampleRate() noexcept
+			{
+				return s_sampleRate.load(std::memory_order_relaxed);
+			}
+
+			/// Records a backtrace if the calling thread's failure count has reached the
+			/// sample rate.
+			///
+			/// @param out_frames - Receives up to k_maxFrames return addresses.
+			///
+			/// @return The number of frames recorded, which is 0 if this failure isn't
+			/// sampled.
+			///
+			static std::uint32_t sample(void** out_frames) noexcept
+			{
+				auto sampleRate = getSampleRate();
+				if (sampleRate == 0 || ++s_count < sampleRate)
+				{
+					return 0;
+				}
+
+				s_count = 0;
+#ifdef IC_RESULT_HAS_BACKTRACE
+				auto size = backtrace(out_frames, static_cast<int>(k_maxFrames));
+				return size > 0 ? static_cast<std::uint32_t>(size) : 0;
+#else
+				(void)out_frames;
+				return 0;
+#endif
+			}
+
+		private:
+			static inline std::atomic<std::uint32_t> s_sampleRate{0};
+			static inline thread_local std::uint32_t s_count = 0;
+		};
+
+		/// Writes the source location and backtrace of an error, each on its own indented
+		/// line. Frames are symbolised here, rather than when they're recorded, using the
+		/// dynamic symbol table; frames without a symbol are written as an offset into
+		/// their module, which can be symbolised offline. Nothing is allocated.
+		///
+		/// @param in_diagnostics - The diagnostics to write. This may be null.
+		/// @param io_sink - The sink to write to.
+		///
+		template <typename TSink> void writeErrorDiagnostics(const ErrorDiagnostics* in_diagnostics, TSink& io_sink) noexcept
+		{
+			if (!in_diagnostics)
+			{
+				return;
+			}
+
+			char number[24];
+			auto writeNumber = [&number, &io_sink](std::uintptr_t in_number, int in_base)
+			{
+				auto end = std::to_chars(number, number + sizeof(number), in_number, in_base).ptr;
+				io_sink.append(std::string_view(number, std::size_t(end - number)));
+			};
+
+			auto& location = in_diagnostics->m_sourceLocation;
+			if (location)
+			{
+				io_sink.append("\n    at ");
+				io_sink.append(location.getFile());
+				io_sink.append(":");
+				writeNumber(location.getLine(), 10);
+				io_sink.append(" in ");
+				io_sink.append(location.getFunction());
+			}
+
+			auto frames = in_diagnostics->getBacktrace();
+			for (std::uint32_t i = 0; i < in_diagnostics->m_backtraceSize; ++i)
+			{
+				auto address = reinterpret_cast<std::uintptr_t>(frames[i]);
+				io_sink.append("\n    #");
+				writeNumber(i, 10);
+				io_sink.append(" 0x");
+				writeNumber(address, 16);
+#ifdef IC_RESULT_HAS_DLADDR
+				Dl_info info;
+				if (dladdr(frames[i], &info) != 0)
+				{
+					if (info.dli_sname)
+					{
+						io_sink.append(" ");
+						io_sink.append(info.dli_sname);
+						io_sink.append("+0x");
+						writeNumber(address - reinterpret_cast<std::uintptr_t>(info.dli_saddr), 16);
+					}
+					if (info.dli_fname)
+					{
+						io_sink.append(" (");
+						io_sink.append(info.dli_fname);
+						io_sink.append("+0x");
+						writeNumber(address - reinterpret_cast<std::uintptr_t>(info.dli_fbase), 16);
+						io_sink.append(")");
+					}
+				}
+#endif
+			}
+		}
+	}
+
+	/// Sets how often failures record a backtrace, for results whose policy captures
+	/// source locations. One in every in_sampleRate such failures on each thread records
+	/// the return addresses of its callers, which are only symbolised when the full error
+	/// message is written. This can be changed at any time from any thread.
+	///
+	/// Backtraces require <execinfo.h>, so aren't recorded on other platforms.
+	///
+	/// @param in_sampleRate - Record one backtrace per this many failures. 0, the
+	/// default, disables backtraces, and 1 records one for every failure.
+	///
+	inline void setErrorBacktraceSampleRate(std::uint32_t in_sampleRate) noexcept
+	{
+		Detail::ErrorBacktraceSampler::setSampleRate(in_sampleRate);
+	}
+
+	/// @return The current backtrace sample rate. See setErrorBacktraceSampleRate().
+	///
+	inline std::uint32_t getErrorBacktraceSampleRate() noexcept
+	{
+		return Detail::ErrorBacktraceSampler::getSampleRate();
+	}
+}
+
+#endif
@@ -0,0 +1,1345 @@
+// ErrorNode.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORNODE_H_
+#define _IC_ERRORNODE_H_
+
+#include "ErrorAllocator.h"
+#include "ErrorCatalog.h"
+#include "ErrorDiagnostics.h"
+#include "ErrorSink.h"
+#include "ErrorTelemetry.h"
+
+#include <assert.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/// Marks a function which is only called once an error has occurred. These are kept out
+/// of line, and away from hot code, so that handling a result which succeeded inlines to
+/// little more than a test of the error.
+///
+#if defined(__GNUC__) || defined(__clang__)
+#define IC_RESULT_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define IC_RESULT_COLD __declspec(noinline)
+#else
+#define IC_RESULT_COLD
+#endif
+
+namespace IC
+{
+	class ErrorNode;
+	struct ErrorDescriptor;
+
+	/// Describes how writeFullErrorMessage() lays out an error and its causes.
+	///
+	enum class ErrorMessageFormat
+	{
+		/// Each error is followed by the errors which caused it, each separated by
+		/// "Caused by:". An error with several causes is followed by each cause, and
+		/// its own causes, in turn.
+		///
+		k_chain,
+
+		/// Each cause is written on its own line, indented beneath the error it caused,
+		/// so that the structure of errors with several causes is kept.
+		///
+		k_tree
+	};
+
+	/// An error in a cause tree, along with how far below the first error in the tree
+	/// it is. See ErrorNode::getErrorTree().
+	///
+	struct ErrorTreeEntry final
+	{
+		/// The error.
+		///
+		const ErrorNode* m_node;
+
+		/// The number of errors between this and the first error in the tree, plus one,
+		/// so the first error has a depth of 0 and its causes a depth of 1.
+		///
+		std::uint32_t m_depth;
+	};
+
+	namespace Detail
+	{
+		/// The causes of a node with more than one cause, stored by the node as a flat
+		/// array of every error beneath it, in pre-order. The depth of each entry is
+		/// relative to the node, so its direct causes have a depth of 1.
+		///
+		struct ErrorCauseTree final
+		{
+			const ErrorTreeEntry* m_entries = nullptr;
+			std::uint32_t m_size = 0;
+			std::uint32_t m_causeCount = 0;
+		};
+	}
+
+	/// Iterates over the direct causes of an error. See ErrorNode::getCauses().
+	///
+	class ErrorCauseIterator final
+	{
+	public:
+		ErrorCauseIterator() noexcept = default;
+
+		/// @param in_cause - The only cause of an error. This may be null.
+		///
+		explicit ErrorCauseIterator(const ErrorNode* in_cause) noexcept;
+
+		/// @param in_entries - The first entry of the flattened causes of an error.
+		/// @param in_end - The end of the flattened causes.
+		///
+		ErrorCauseIterator(const ErrorTreeEntry* in_entries, const ErrorTreeEntry* in_end) noexcept;
+
+		/// @return The cause.
+		///
+		const ErrorNode& operator*() const noexcept;
+
+		/// @return The cause.
+		///
+		const ErrorNode* operator->() const noexcept;
+
+		/// Moves to the next cause, skipping the causes of the current one.
+		///
+		/// @return This iterator.
+		///
+		ErrorCauseIterator& operator++() noexcept;
+
+		//-----------------------------------------------------------------------------
+		bool operator==(const ErrorCauseIterator& in_other) const noexcept;
+
+		//-----------------------------------------------------------------------------
+		bool operator!=(const ErrorCauseIterator& in_other) const noexcept;
+
+	private:
+		const ErrorNode* m_cause = nullptr;
+		const ErrorTreeEntry* m_entry = nullptr;
+		const ErrorTreeEntry* m_end = nullptr;
+	};
+
+	/// The direct causes of an error, in the order they were given. See
+	/// ErrorNode::getCauses().
+	///
+	class ErrorCauseRange final
+	{
+	public:
+		ErrorCauseRange() noexcept = default;
+
+		/// @param in_begin - The first cause.
+		/// @param in_size - The number of causes.
+		///
+		ErrorCauseRange(ErrorCauseIterator in_begin, std::size_t in_size) noexcept;
+
+		//-----------------------------------------------------------------------------
+		ErrorCauseIterator begin() const noexcept;
+
+		//-----------------------------------------------------------------------------
+		ErrorCauseIterator end() const noexcept;
+
+		/// @return The number of causes.
+		///
+		std::size_t getSize() const noexcept;
+
+	private:
+		ErrorCauseIterator m_begin;
+		std::size_t m_size = 0;
+	};
+
+	/// Iterates over an error and every error beneath it, in pre-order. A chain of
+	/// single causes is followed node by node, and once an error with several causes
+	/// is reached, its flattened causes are read as one array. See
+	/// ErrorNode::getErrorTree().
+	///
+	class ErrorTreeIterator final
+	{
+	public:
+		ErrorTreeIterator() noexcept = default;
+
+		/// @param in_node - The first error in the tree. This may be null.
+		///
+		explicit ErrorTreeIterator(const ErrorNode* in_node) noexcept;
+
+		/// @return The current error and its depth.
+		///
+		ErrorTreeEntry operator*() const noexcept;
+
+		/// Moves to the next error in pre-order.
+		///
+		/// @return This iterator.
+		///
+		ErrorTreeIterator& operator++() noexcept;
+
+		//-----------------------------------------------------------------------------
+		bool operator==(const ErrorTreeIterator& in_other) const noexcept;
+
+		//-----------------------------------------------------------------------------
+		bool operator!=(const ErrorTreeIterator& in_other) const noexcept;
+
+	private:
+		const ErrorNode* m_node = nullptr;
+		std::uint32_t m_depth = 0;
+		const ErrorTreeEntry* m_entry = nullptr;
+		const ErrorTreeEntry* m_end = nullptr;
+	};
+
+	/// An error and every error beneath it, in pre-order. See ErrorNode::getErrorTree().
+	///
+	class ErrorTreeRange final
+	{
+	public:
+		ErrorTreeRange() noexcept = default;
+
+		/// @param in_begin - The first error.
+		///
+		explicit ErrorTreeRange(ErrorTreeIterator in_begin) noexcept;
+
+		//-----------------------------------------------------------------------------
+		ErrorTreeIterator begin() const noexcept;
+
+		//-----------------------------------------------------------------------------
+		ErrorTreeIterator end() const noexcept;
+
+	private:
+		ErrorTreeIterator m_begin;
+	};
+
+	/// An intrusive, reference counted pointer to an immutable error node. Copying this
+	/// is O(1) regardless of the length of the cause chain.
+	///
+	class ErrorNodePtr final
+	{
+	public:
+		ErrorNodePtr() noexcept = default;
+
+		/// @param in_node - The node to refer to. A reference is added if this is not null.
+		///
+		explicit ErrorNodePtr(const ErrorNode* in_node) noexcept;
+
+		/// @param in_toCopy - The pointer to copy. This shares the node.
+		///
+		ErrorNodePtr(const ErrorNodePtr& in_toCopy) noexcept;
+
+		/// @param in_toMove - The pointer to move into this.
+		///
+		ErrorNodePtr(ErrorNodePtr&& in_toMove) noexcept;
+
+		/// @param in_toCopy - The pointer to copy. This shares the node.
+		///
+		ErrorNodePtr& operator=(const ErrorNodePtr& in_toCopy) noexcept;
+
+		/// @param in_toMove - The pointer to move into this.
+		///
+		ErrorNodePtr& operator=(ErrorNodePtr&& in_toMove) noexcept;
+
+		~ErrorNodePtr() noexcept;
+
+		/// @param io_other - The pointer to swap with.
+		///
+		void swap(ErrorNodePtr& io_other) noexcept;
+
+		/// @return The node, or null if this doesn't refer to one.
+		///
+		const ErrorNode* get() const noexcept;
+
+		/// @return The node. This must not be called on a null pointer.
+		///
+		const ErrorNode* operator->() const noexcept;
+
+		/// @return The node. This must not be called on a null pointer.
+		///
+		const ErrorNode& operator*() const noexcept;
+
+		/// @return Whether or not this refers to a node.
+		///
+		explicit operator bool() const noexcept;
+
+	private:
+		const ErrorNode* m_node = nullptr;
+	};
+
+	/// A static description of a type of error node, similar to std::error_category.
+	/// Each type of node has a single descriptor, and each node points to the descriptor
+	/// for its type. This type erases the node without a vtable, so that results with
+	/// different template parameters can be chained together as causes, while the
+	/// results themselves remain plain, non-polymorphic types.
+	///
+	struct ErrorDescriptor final
+	{
+		/// Adds a reference to the node.
+		///
+		void (*m_addReference)(const ErrorNode& in_node) noexcept;
+
+		/// Removes a reference from the node, destroying it if this was the last.
+		///
+		void (*m_removeReference)(const ErrorNode& in_node) noexcept;
+
+		/// Returns the message describing the error.
+		///
+		std::string_view (*m_getErrorMessage)(const ErrorNode& in_node) noexcept;
+
+		/// Returns the error value, converted to an integer.
+		///
+		std::int64_t (*m_getErrorCode)(const ErrorNode& in_node) noexcept;
+
+		/// Returns the name of the error type. As each error type has its own function,
+		/// this also identifies the error type.
+		///
+		std::string_view (*m_getErrorType)() noexcept;
+
+		/// Returns the static message or format template the message was built from, or
+		/// null if the message was built dynamically.
+		///
+		const char* (*m_getMessageTemplate)(const ErrorNode& in_node) noexcept;
+
+		/// Returns where the error was created, or null if the policy of the node
+		/// doesn't capture source locations.
+		///
+		const ErrorDiagnostics* (*m_getDiagnostics)(const ErrorNode& in_node) noexcept;
+
+		/// Returns the flattened causes of a node with more than one cause, or an empty
+		/// tree for a node with at most one, which is instead returned by getCausedBy().
+		///
+		Detail::ErrorCauseTree (*m_getCauseTree)(const ErrorNode& in_node) noexcept;
+	};
+
+	/// The base class for the immutable, reference counted nodes which describe a single
+	/// error in a cause chain. Once created a node is never modified, so wrapping an error
+	/// or copying a failed result simply shares the node rather than cloning the chain.
+	///
+	/// The node is type erased through its ErrorDescriptor, so a cause chain can contain
+	/// nodes for any mix of error types. Nodes are only ever referred to through an
+	/// ErrorNodePtr.
+	///
+	class ErrorNode
+	{
+	public:
+		ErrorNode(const ErrorNode&) = delete;
+		ErrorNode& operator=(const ErrorNode&) = delete;
+
+		/// An error node always describes a failure.
+		///
+		/// @return false.
+		///
+		bool wasSuccessful() const noexcept
+		{
+			return false;
+		}
+
+		/// @return A message describing the error. The message remains valid for as long
+		/// as the node exists.
+		///
+		std::string_view getErrorMessage() const noexcept
+		{
+			return m_descriptor->m_getErrorMessage(*this);
+		}
+
+		/// @param in_format - How the causes should be laid out.
+		///
+		/// @return A message describing this error and any errors which caused this error
+		/// to occur. See writeFullErrorMessage().
+		///
+		std::string getFullErrorMessage(ErrorMessageFormat in_format = ErrorMessageFormat::k_chain) const noexcept;
+
+		/// Writes a message describing this error and any errors which caused this error
+		/// to occur into the given sink. The tree is walked iteratively: once to measure
+		/// the message, so the sink can be sized in one go, and once to write it.
+		///
+		/// @param io_sink - The sink to write to, for example a StringErrorSink,
+		/// StreamErrorSink or FixedBufferErrorSink.
+		/// @param in_format - How the causes should be laid out.
+		///
+		template <typename TSink> void writeFullErrorMessage(TSink& io_sink, ErrorMessageFormat in_format = ErrorMessageFormat::k_chain) const noexcept;
+
+		/// @return The error value of the result which created the node, converted to an
+		/// integer. Use getDescriptor() to identify the type of node.
+		///
+		std::int64_t getErrorCode() const noexcept
+		{
+			return m_descriptor->m_getErrorCode(*this);
+		}
+
+		/// @return The name of the error type, as reported by the compiler.
+		///
+		std::string_view getErrorType() const noexcept
+		{
+			return m_descriptor->m_getErrorType();
+		}
+
+		/// @return The static message or format template the message was built from, or
+		/// null if the message was built dynamically. Messages from an ErrorCatalog are
+		/// static.
+		///
+		const char* getMessageTemplate() const noexcept
+		{
+			return m_descriptor->m_getMessageTemplate(*this);
+		}
+
+		/// @return A hash of the error type, error value and message template of this
+		/// error and each error that caused it. Repeats of the same failure have the same
+		/// fingerprint, even if their messages contain different arguments, and the
+		/// message is never formatted to calculate it. For messages built dynamically,
+		/// which have no template, the text of the message is hashed instead.
+		///
+		std::uint64_t getFingerprint() const noexcept;
+
+		/// @return Where the error was created, and the backtrace if one was sampled, or
+		/// null if the policy of the result which created it doesn't capture source
+		/// locations. See DefaultResultPolicy::k_captureSourceLocation.
+		///
+		const ErrorDiagnostics* getDiagnostics() const noexcept
+		{
+			return m_descriptor->m_getDiagnostics(*this);
+		}
+
+		/// @return The descriptor for the type of node.
+		///
+		const ErrorDescriptor& getDescriptor() const noexcept
+		{
+			return *m_descriptor;
+		}
+
+		/// @return The node describing the error which caused this one, or the first of
+		/// them if it had several, or null if this wasn't caused by another.
+		///
+		const ErrorNode* getCausedBy() const noexcept
+		{
+			return m_causedBy.get();
+		}
+
+		/// @return The errors which directly caused this one, in the order they were
+		/// given.
+		///
+		ErrorCauseRange getCauses() const noexcept;
+
+		/// @return This error followed by every error beneath it, in pre-order, each with
+		/// its depth below this one. For example, to visit every error in the tree:
+		///
+		///     for (auto entry : node.getErrorTree())
+		///     {
+		///         log(entry.m_depth, entry.m_node->getErrorMessage());
+		///     }
+		///
+		ErrorTreeRange getErrorTree() const noexcept;
+
+		/// @return A new reference to this node.
+		///
+		ErrorNodePtr shareError() const noexcept
+		{
+			return ErrorNodePtr(this);
+		}
+
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+		/// This is only available when telemetry is enabled, so that the depth isn't
+		/// calculated otherwise.
+		///
+		/// @return The length of the cause chain, including this node. If any error in
+		/// the chain has several causes, this is the length of the longest path.
+		///
+		std::uint32_t getChainDepth() const noexcept
+		{
+			return m_chainDepth;
+		}
+#endif
+
+	protected:
+		/// @param in_descriptor - The descriptor for the type of node. This must have
+		/// static storage duration.
+		/// @param in_causedBy - The node describing the error which caused this one. This
+		/// may be null.
+		///
+		ErrorNode(const ErrorDescriptor& in_descriptor, ErrorNodePtr in_causedBy) noexcept
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+			: m_chainDepth(in_causedBy ? in_causedBy->m_chainDepth + 1 : 1), m_descriptor(&in_descriptor), m_causedBy(std::move(in_causedBy))
+#else
+			: m_descriptor(&in_descriptor), m_causedBy(std::move(in_causedBy))
+#endif
+		{
+		}
+
+		/// @param in_descriptor - The descriptor for the type of node. This must have
+		/// static storage duration.
+		/// @param in_causedBy - The node describing the first error which caused this one.
+		/// @param in_causeChainDepth - The longest chain depth of any of the causes.
+		///
+		ErrorNode(const ErrorDescriptor& in_descriptor, ErrorNodePtr in_causedBy, [[maybe_unused]] std::uint32_t in_causeChainDepth) noexcept
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+			: m_chainDepth(in_causeChainDepth + 1), m_descriptor(&in_descriptor), m_causedBy(std::move(in_causedBy))
+#else
+			: m_descriptor(&in_descriptor), m_causedBy(std::move(in_causedBy))
+#endif
+		{
+		}
+
+		~ErrorNode() noexcept = default;
+
+		mutable std::atomic<std::uint32_t> m_referenceCount{0};
+
+	private:
+		friend class ErrorNodePtr;
+
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+		// This fits in the padding after the reference count.
+		const std::uint32_t m_chainDepth;
+#endif
+		const ErrorDescriptor* const m_descriptor;
+		const ErrorNodePtr m_causedBy;
+	};
+
+	namespace Detail
+	{
+		/// @param in_backtraceSize - The number of frames in the backtrace.
+		///
+		/// @return The number of bytes stored before a node whose policy captures source
+		/// locations. The node is aligned as if it were allocated directly.
+		///
+		constexpr std::size_t getDiagnosticsPrefixSize(std::uint32_t in_backtraceSize) noexcept
+		{
+			constexpr std::size_t k_alignment = alignof(std::max_align_t);
+			auto size = sizeof(ErrorDiagnostics) + in_backtraceSize * sizeof(void*);
+			return (size + k_alignment - 1) / k_alignment * k_alignment;
+		}
+
+		/// Constructs the diagnostics stored before a node.
+		///
+		/// @param in_memory - The memory for the node, after the prefix.
+		/// @param in_frames - The sampled backtrace.
+		/// @param in_backtraceSize - The number of frames in the backtrace.
+		///
+		/// @return The memory for the node.
+		///
+		inline void* constructDiagnostics(char* in_memory, void* const* in_frames, std::uint32_t in_backtraceSize) noexcept
+		{
+			auto diagnostics = new (in_memory - sizeof(ErrorDiagnostics)) ErrorDiagnostics();
+			diagnostics->m_backtraceSize = in_backtraceSize;
+			if (in_backtraceSize > 0)
+			{
+				std::memcpy(const_cast<void**>(diagnostics->getBacktrace()), in_frames, in_backtraceSize * sizeof(void*));
+			}
+			return in_memory;
+		}
+
+		/// Allocates the memory for an error node with the allocator described by the
+		/// policy. If the policy captures source locations, an ErrorDiagnostics and any
+		/// sampled backtrace are stored directly before the node, in the same allocation.
+		///
+		/// @param in_size - The size of the node.
+		///
+		/// @return The memory for the node, or null if the allocator failed.
+		///
+		template <typename TPolicy> void* allocateNodeMemory(std::size_t in_size) noexcept
+		{
+			if constexpr (TPolicy::k_captureSourceLocation)
+			{
+				void* frames[ErrorBacktraceSampler::k_maxFrames];
+				auto backtraceSize = ErrorBacktraceSampler::sample(frames);
+				auto prefixSize = getDiagnosticsPrefixSize(backtraceSize);
+				auto memory = static_cast<char*>(TPolicy::Allocator::allocate(prefixSize + in_size));
+				return memory ? constructDiagnostics(memory + prefixSize, frames, backtraceSize) : nullptr;
+			}
+			else
+			{
+				return TPolicy::Allocator::allocate(in_size);
+			}
+		}
+
+		/// @return The largest node which can be allocated by allocateReservedNodeMemory().
+		///
+		template <typename TPolicy> constexpr std::size_t getReservedNodeCapacity() noexcept
+		{
+			constexpr std::size_t k_available = ErrorReserve::k_blockSize - (TPolicy::k_captureSourceLocation ? getDiagnosticsPrefixSize(0) : 0);
+			static_assert(k_available >= 64, "The blocks of the error reserve are too small.");
+			return k_available;
+		}
+
+		/// Allocates the memory for an error node from the emergency reserve, for use when
+		/// allocateNodeMemory() fails. A sampled backtrace isn't recorded. If the reserve is
+		/// exhausted too std::terminate() is called, as it would have been when allocation
+		/// failures were reported by throwing.
+		///
+		/// @param io_size - The size of the node, which is reduced if it doesn't fit in a
+		/// block of the reserve.
+		/// @param in_minSize - The size the node can't be reduced below.
+		///
+		/// @return The memory for the node.
+		///
+		template <typename TPolicy> void* allocateReservedNodeMemory(std::size_t& io_size, std::size_t in_minSize) noexcept
+		{
+			constexpr std::size_t k_prefixSize = TPolicy::k_captureSourceLocation ? getDiagnosticsPrefixSize(0) : 0;
+			constexpr std::size_t k_available = getReservedNodeCapacity<TPolicy>();
+
+			if (io_size > k_available)
+			{
+				io_size = in_minSize > k_available ? in_minSize : k_available;
+				ErrorReserve::recordTruncation();
+			}
+
+			auto memory = io_size <= k_available ? static_cast<char*>(ErrorReserve::allocate(k_prefixSize + io_size)) : nullptr;
+			if (!memory)
+			{
+				std::terminate();
+			}
+
+			if constexpr (TPolicy::k_captureSourceLocation)
+			{
+				return constructDiagnostics(memory + k_prefixSize, nullptr, 0);
+			}
+			else
+			{
+				return memory;
+			}
+		}
+
+		/// Deallocates memory returned by allocateNodeMemory() or
+		/// allocateReservedNodeMemory().
+		///
+		/// @param in_memory - The memory for the node, which must already be destroyed.
+		/// @param in_size - The size of the node.
+		///
+		template <typename TPolicy> void deallocateNodeMemory(void* in_memory, std::size_t in_size) noexcept
+		{
+			auto memory = static_cast<char*>(in_memory);
+			std::size_t prefixSize = 0;
+			if constexpr (TPolicy::k_captureSourceLocation)
+			{
+				prefixSize = getDiagnosticsPrefixSize(reinterpret_cast<const ErrorDiagnostics*>(memory)[-1].m_backtraceSize);
+			}
+
+			if (ErrorReserve::contains(memory - prefixSize))
+			{
+				ErrorReserve::deallocate(memory - prefixSize);
+			}
+			else
+			{
+				TPolicy::Allocator::deallocate(memory - prefixSize, prefixSize + in_size);
+			}
+		}
+
+		/// The base for error nodes with the given error type, providing the error value
+		/// and the reference counting described by the policy. Derived classes provide the
+		/// error message through a static readErrorMessage() function, and the size of their
+		/// allocation through getAllocationSize(). Nodes with several causes also provide
+		/// readCauseTree().
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy> class TypedErrorNodeBase : public ErrorNode
+		{
+		public:
+			//-----------------------------------------------------------------------------
+			TError getError() const noexcept
+			{
+				return m_error;
+			}
+
+			//-----------------------------------------------------------------------------
+			static ErrorCauseTree readCauseTree(const ErrorNode&) noexcept
+			{
+				return ErrorCauseTree();
+			}
+
+		protected:
+			//-----------------------------------------------------------------------------
+			TypedErrorNodeBase(const ErrorDescriptor& in_descriptor, TError in_error, ErrorNodePtr in_causedBy) noexcept
+				: ErrorNode(in_descriptor, std::move(in_causedBy)), m_error(in_error)
+			{
+				assert(m_error != TErrorSuccess);
+			}
+
+			//-----------------------------------------------------------------------------
+			TypedErrorNodeBase(const ErrorDescriptor& in_descriptor, TError in_error, ErrorNodePtr in_causedBy, std::uint32_t in_causeChainDepth) noexcept
+				: ErrorNode(in_descriptor, std::move(in_causedBy), in_causeChainDepth), m_error(in_error)
+			{
+				assert(m_error != TErrorSuccess);
+			}
+
+			/// @return The descriptor for nodes of the given derived type.
+			///
+			template <typename TNode> static const ErrorDescriptor& getNodeDescriptor() noexcept
+			{
+				static constexpr ErrorDescriptor k_descriptor = { &addNodeReference, &removeNodeReference<TNode>, &TNode::readErrorMessage, &readErrorCode, &getErrorTypeName<TError>, &TNode::readMessageTemplate, &readDiagnostics, &TNode::readCauseTree };
+				return k_descriptor;
+			}
+
+		private:
+			//-----------------------------------------------------------------------------
+			static void addNodeReference(const ErrorNode& in_node) noexcept
+			{
+				TPolicy::RefCount::increment(static_cast<const TypedErrorNodeBase&>(in_node).m_referenceCount);
+			}
+
+			//-----------------------------------------------------------------------------
+			template <typename TNode> static void removeNodeReference(const ErrorNode& in_node) noexcept
+			{
+				auto& node = static_cast<const TNode&>(in_node);
+				if (TPolicy::RefCount::decrement(static_cast<const TypedErrorNodeBase&>(node).m_referenceCount))
+				{
+					auto allocationSize = node.getAllocationSize();
+					auto memory = const_cast<TNode*>(&node);
+					memory->~TNode();
+					deallocateNodeMemory<TPolicy>(memory, allocationSize);
+				}
+			}
+
+			//-----------------------------------------------------------------------------
+			static std::int64_t readErrorCode(const ErrorNode& in_node) noexcept
+			{
+				return static_cast<std::int64_t>(static_cast<const TypedErrorNodeBase&>(in_node).m_error);
+			}
+
+			//-----------------------------------------------------------------------------
+			static const ErrorDiagnostics* readDiagnostics(const ErrorNode& in_node) noexcept
+			{
+				if constexpr (TPolicy::k_captureSourceLocation)
+				{
+					return reinterpret_cast<const ErrorDiagnostics*>(&in_node) - 1;
+				}
+				else
+				{
+					return nullptr;
+				}
+			}
+
+			const TError m_error;
+		};
+
+		/// Records where a newly created node's error occurred. This does nothing if the
+		/// policy of the node doesn't capture source locations. As nodes are immutable
+		/// once shared, this must only be called before the node is shared.
+		///
+		/// @param in_node - The new node.
+		/// @param in_location - Where the error occurred.
+		///
+		inline void setErrorSourceLocation(const ErrorNode& in_node, const SourceLocation& in_location) noexcept
+		{
+			if (auto diagnostics = in_node.getDiagnostics())
+			{
+				const_cast<ErrorDiagnostics*>(diagnostics)->m_sourceLocation = in_location;
+			}
+		}
+
+		/// Allocates a node of the given type with the allocator described by the policy,
+		/// or from the emergency reserve if the allocator fails.
+		///
+		/// @param in_args - The arguments passed to the node's constructor.
+		///
+		/// @return The new node.
+		///
+		template <typename TNode, typename TPolicy, typename... TArgs> ErrorNodePtr allocateErrorNode(TArgs&&... in_args) noexcept
+		{
+			auto memory = allocateNodeMemory<TPolicy>(sizeof(TNode));
+			if (!memory)
+			{
+				auto size = sizeof(TNode);
+				memory = allocateReservedNodeMemory<TPolicy>(size, size);
+			}
+
+			return ErrorNodePtr(new (memory) TNode(std::forward<TArgs>(in_args)...));
+		}
+
+		/// The error node created for failed results with a message that has already
+		/// been formatted. The message is stored directly after the node, in the same
+		/// allocation, so creating the node makes exactly one allocation.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy> class TypedErrorNode final : public TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>
+		{
+		public:
+			/// @param in_error - The error that occurred.
+			/// @param in_errorMessage - A description of the error that occurred.
+			/// @param in_causedBy - The node describing the cause. This may be null.
+			///
+			/// @return A new node with the message stored in the same allocation.
+			///
+			static ErrorNodePtr create(TError in_error, std::string_view in_errorMessage, ErrorNodePtr in_causedBy) noexcept
+			{
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+				recordMessageTelemetry(in_error, in_errorMessage.size());
+#endif
+				auto size = sizeof(TypedErrorNode) + in_errorMessage.size();
+				auto memory = allocateNodeMemory<TPolicy>(size);
+				if (!memory)
+				{
+					memory = allocateReservedNodeMemory<TPolicy>(size, sizeof(TypedErrorNode));
+					in_errorMessage = in_errorMessage.substr(0, size - sizeof(TypedErrorNode));
+				}
+
+				return ErrorNodePtr(new (memory) TypedErrorNode(in_error, in_errorMessage, std::move(in_causedBy)));
+			}
+
+			//-----------------------------------------------------------------------------
+			static std::string_view readErrorMessage(const ErrorNode& in_node) noexcept
+			{
+				auto& node = static_cast<const TypedErrorNode&>(in_node);
+				return std::string_view(reinterpret_cast<const char*>(&node + 1), node.m_errorMessageLength);
+			}
+
+			//-----------------------------------------------------------------------------
+			static const char* readMessageTemplate(const ErrorNode&) noexcept
+			{
+				return nullptr;
+			}
+
+			//-----------------------------------------------------------------------------
+			std::size_t getAllocationSize() const noexcept
+			{
+				return sizeof(TypedErrorNode) + m_errorMessageLength;
+			}
+
+		private:
+			//-----------------------------------------------------------------------------
+			TypedErrorNode(TError in_error, std::string_view in_errorMessage, ErrorNodePtr in_causedBy) noexcept
+				: TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>(TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>::template getNodeDescriptor<TypedErrorNode>(), in_error, std::move(in_causedBy)), m_errorMessageLength(in_errorMessage.size())
+			{
+				std::memcpy(reinterpret_cast<char*>(this + 1), in_errorMessage.data(), in_errorMessage.size());
+			}
+
+			const std::size_t m_errorMessageLength;
+		};
+
+		/// The error node created for failed results with a static message, which only
+		/// stores a pointer to the message.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy> class StaticErrorNode final : public TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>
+		{
+		public:
+			//-----------------------------------------------------------------------------
+			StaticErrorNode(TError in_error, StaticMessage in_errorMessage, ErrorNodePtr in_causedBy) noexcept
+				: TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>(TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>::template getNodeDescriptor<StaticErrorNode>(), in_error, std::move(in_causedBy)), m_errorMessage(in_errorMessage.get())
+			{
+			}
+
+			//-----------------------------------------------------------------------------
+			static std::string_view readErrorMessage(const ErrorNode& in_node) noexcept
+			{
+				return static_cast<const StaticErrorNode&>(in_node).m_errorMessage;
+			}
+
+			//-----------------------------------------------------------------------------
+			static const char* readMessageTemplate(const ErrorNode& in_node) noexcept
+			{
+				return static_cast<const StaticErrorNode&>(in_node).m_errorMessage;
+			}
+
+			//-----------------------------------------------------------------------------
+			std::size_t getAllocationSize() const noexcept
+			{
+				return sizeof(StaticErrorNode);
+			}
+
+		private:
+			const char* const m_errorMessage;
+		};
+
+		//-----------------------------------------------------------------------------
+		template <typename TError, TError TErrorSuccess, typename TPolicy> ErrorNodePtr makeErrorNode(TError in_error, std::string_view in_errorMessage, ErrorNodePtr in_causedBy) noexcept
+		{
+			return TypedErrorNode<TError, TErrorSuccess, TPolicy>::create(in_error, in_errorMessage, std::move(in_causedBy));
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TError, TError TErrorSuccess, typename TPolicy> ErrorNodePtr makeErrorNode(TError in_error, StaticMessage in_errorMessage, ErrorNodePtr in_causedBy) noexcept
+		{
+			return allocateErrorNode<StaticErrorNode<TError, TErrorSuccess, TPolicy>, TPolicy>(in_error, in_errorMessage, std::move(in_causedBy));
+		}
+	}
+
+	namespace Detail
+	{
+		/// The text placed between each message in a full error message.
+		///
+		constexpr std::string_view k_causedBySeparator = "\nCaused by:\n";
+
+		/// The number of spaces each level of a tree is indented by, in a full error
+		/// message written with ErrorMessageFormat::k_tree.
+		///
+		constexpr std::uint32_t k_treeIndent = 2;
+
+		/// @param in_node - The first error in a tree. This may be null.
+		///
+		/// @return Every error beneath the given one, in pre-order.
+		///
+		inline ErrorTreeRange getCauseTree(const ErrorNode* in_node) noexcept
+		{
+			ErrorTreeIterator begin(in_node);
+			if (in_node)
+			{
+				++begin;
+			}
+			return ErrorTreeRange(begin);
+		}
+
+		/// Calculates the fingerprint of an error with the given type, value, message
+		/// template and causes. See ErrorNode::getFingerprint().
+		///
+		/// @param in_errorType - Identifies the type of the first error in the tree.
+		/// @param in_errorCode - The value of the first error, converted to an integer.
+		/// @param in_messageTemplate - The message template of the first error. This may
+		/// be null.
+		/// @param in_errorMessage - The message of the first error, which is only used if
+		/// it has no template.
+		/// @param in_causes - Every error beneath the first, in pre-order.
+		///
+		/// @return The fingerprint.
+		///
+		inline std::uint64_t fingerprintErrorChain(ErrorTypeNameGetter in_errorType, std::int64_t in_errorCode, const char* in_messageTemplate, std::string_view in_errorMessage, ErrorTreeRange in_causes) noexcept
+		{
+			constexpr std::uint64_t k_multiplier = 0x9E3779B97F4A7C15ull;
+
+			std::uint64_t fingerprint = 0;
+			auto combine = [&fingerprint](std::uint64_t in_value)
+			{
+				fingerprint = (fingerprint ^ in_value) * k_multiplier;
+				fingerprint ^= fingerprint >> 32;
+			};
+
+			// Templates are static, so are identified by their address. Messages without
+			// one are already formatted, so their text can be hashed without formatting.
+			auto combineMessage = [&combine](const char* in_template, std::string_view in_message)
+			{
+				if (in_template)
+				{
+					combine(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(in_template)));
+					return;
+				}
+
+				std::uint64_t hash = 0xCBF29CE484222325ull;
+				for (auto character : in_message)
+				{
+					hash = (hash ^ static_cast<unsigned char>(character)) * 0x100000001B3ull;
+				}
+				combine(hash);
+			};
+
+			combine(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(in_errorType)));
+			combine(static_cast<std::uint64_t>(in_errorCode));
+			combineMessage(in_messageTemplate, in_errorMessage);
+			for (auto entry : in_causes)
+			{
+				combine(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(entry.m_node->getDescriptor().m_getErrorType)));
+				combine(static_cast<std::uint64_t>(entry.m_node->getErrorCode()));
+				auto messageTemplate = entry.m_node->getMessageTemplate();
+				combineMessage(messageTemplate, messageTemplate ? std::string_view() : entry.m_node->getErrorMessage());
+				combine(entry.m_depth);
+			}
+
+			return fingerprint;
+		}
+
+		/// Wraps a sink, indenting every line after the first by a fixed number of
+		/// spaces, so that messages and diagnostics which span several lines stay aligned
+		/// in a tree.
+		///
+		template <typename TSink> class IndentedErrorSink final
+		{
+		public:
+			/// @param io_sink - The sink to write to.
+			/// @param in_indent - The number of spaces to indent each new line by.
+			///
+			IndentedErrorSink(TSink& io_sink, std::uint32_t in_indent) noexcept
+				: m_sink(io_sink), m_indent(in_indent)
+			{
+			}
+
+			//-----------------------------------------------------------------------------
+			void reserve(std::size_t in_size) noexcept
+			{
+				m_sink.reserve(in_size);
+			}
+
+			//-----------------------------------------------------------------------------
+			void append(std::string_view in_text) noexcept
+			{
+				for (auto newLine = in_text.find('\n'); newLine != std::string_view::npos; newLine = in_text.find('\n'))
+				{
+					m_sink.append(in_text.substr(0, newLine + 1));
+					appendIndent(m_sink, m_indent);
+					in_text.remove_prefix(newLine + 1);
+				}
+				m_sink.append(in_text);
+			}
+
+			/// Appends the given number of spaces to a sink.
+			///
+			/// @param io_sink - The sink to write to.
+			/// @param in_indent - The number of spaces.
+			///
+			static void appendIndent(TSink& io_sink, std::uint32_t in_indent) noexcept
+			{
+				constexpr std::string_view k_spaces = "                                ";
+				for (; in_indent > k_spaces.size(); in_indent -= std::uint32_t(k_spaces.size()))
+				{
+					io_sink.append(k_spaces);
+				}
+				io_sink.append(k_spaces.substr(0, in_indent));
+			}
+
+		private:
+			TSink& m_sink;
+			const std::uint32_t m_indent;
+		};
+
+		/// Writes the full error message for an error with the given message and causes
+		/// into the sink. See ErrorNode::writeFullErrorMessage(). The source location and
+		/// backtrace of each error, if they were captured, follow its message.
+		///
+		/// @param in_errorMessage - The message for the first error in the tree.
+		/// @param in_diagnostics - The diagnostics for the first error. This may be null.
+		/// @param in_causes - Every error beneath the first, in pre-order.
+		/// @param in_format - How the causes should be laid out.
+		/// @param io_sink - The sink to write to.
+		///
+		template <typename TSink> IC_RESULT_COLD void writeErrorChain(std::string_view in_errorMessage, const ErrorDiagnostics* in_diagnostics, ErrorTreeRange in_causes, ErrorMessageFormat in_format, TSink& io_sink) noexcept
+		{
+			auto length = in_errorMessage.size();
+			for (auto entry : in_causes)
+			{
+				auto separatorSize = in_format == ErrorMessageFormat::k_tree ? 1 + entry.m_depth * k_treeIndent : k_causedBySeparator.size();
+				length += separatorSize + entry.m_node->getErrorMessage().size();
+			}
+
+			io_sink.reserve(length);
+			io_sink.append(in_errorMessage);
+			writeErrorDiagnostics(in_diagnostics, io_sink);
+			for (auto entry : in_causes)
+			{
+				if (in_format == ErrorMessageFormat::k_tree)
+				{
+					io_sink.append("\n");
+					IndentedErrorSink<TSink>::appendIndent(io_sink, (entry.m_depth - 1) * k_treeIndent);
+					io_sink.append("- ");
+
+					IndentedErrorSink<TSink> indentedSink(io_sink, entry.m_depth * k_treeIndent);
+					indentedSink.append(entry.m_node->getErrorMessage());
+					writeErrorDiagnostics(entry.m_node->getDiagnostics(), indentedSink);
+				}
+				else
+				{
+					io_sink.append(k_causedBySeparator);
+					io_sink.append(entry.m_node->getErrorMessage());
+					writeErrorDiagnostics(entry.m_node->getDiagnostics(), io_sink);
+				}
+			}
+		}
+
+		/// Builds the full error message for an error with the given message and causes.
+		/// This is shared by every type of result, so that each doesn't instantiate its
+		/// own copy. See writeErrorChain().
+		///
+		/// @param in_errorMessage - The message for the first error in the tree.
+		/// @param in_diagnostics - The diagnostics for the first error. This may be null.
+		/// @param in_causes - Every error beneath the first, in pre-order.
+		/// @param in_format - How the causes should be laid out.
+		///
+		/// @return The full error message.
+		///
+		IC_RESULT_COLD inline std::string buildErrorChain(std::string_view in_errorMessage, const ErrorDiagnostics* in_diagnostics, ErrorTreeRange in_causes, ErrorMessageFormat in_format) noexcept
+		{
+			std::string errorMessage;
+			StringErrorSink sink(errorMessage);
+			writeErrorChain(in_errorMessage, in_diagnostics, in_causes, in_format, sink);
+			return errorMessage;
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+	inline std::string ErrorNode::getFullErrorMessage(ErrorMessageFormat in_format) const noexcept
+	{
+		return Detail::buildErrorChain(getErrorMessage(), getDiagnostics(), Detail::getCauseTree(this), in_format);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TSink> void ErrorNode::writeFullErrorMessage(TSink& io_sink, ErrorMessageFormat in_format) const noexcept
+	{
+		Detail::writeErrorChain(getErrorMessage(), getDiagnostics(), Detail::getCauseTree(this), in_format, io_sink);
+	}
+
+	//-----------------------------------------------------------------------------
+	inline std::uint64_t ErrorNode::getFingerprint() const noexcept
+	{
+		auto messageTemplate = getMessageTemplate();
+		return Detail::fingerprintErrorChain(m_descriptor->m_getErrorType, getErrorCode(), messageTemplate, messageTemplate ? std::string_view() : getErrorMessage(), Detail::getCauseTree(this));
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorCauseRange ErrorNode::getCauses() const noexcept
+	{
+		auto tree = m_descriptor->m_getCauseTree(*this);
+		if (tree.m_size > 0)
+		{
+			return ErrorCauseRange(ErrorCauseIterator(tree.m_entries, tree.m_entries + tree.m_size), tree.m_causeCount);
+		}
+
+		return ErrorCauseRange(ErrorCauseIterator(getCausedBy()), getCausedBy() ? 1 : 0);
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorTreeRange ErrorNode::getErrorTree() const noexcept
+	{
+		return ErrorTreeRange(ErrorTreeIterator(this));
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorCauseIterator::ErrorCauseIterator(const ErrorNode* in_cause) noexcept
+		: m_cause(in_cause)
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorCauseIterator::ErrorCauseIterator(const ErrorTreeEntry* in_entries, const ErrorTreeEntry* in_end) noexcept
+		: m_entry(in_entries != in_end ? in_entries : nullptr), m_end(in_entries != in_end ? in_end : nullptr)
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	inline const ErrorNode& ErrorCauseIterator::operator*() const noexcept
+	{
+		return *operator->();
+	}
+
+	//-----------------------------------------------------------------------------
+	inline const ErrorNode* ErrorCauseIterator::operator->() const noexcept
+	{
+		assert(m_cause || m_entry);
+		return m_entry ? m_entry->m_node : m_cause;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorCauseIterator& ErrorCauseIterator::operator++() noexcept
+	{
+		if (m_entry)
+		{
+			do
+			{
+				++m_entry;
+			}
+			while (m_entry != m_end && m_entry->m_depth != 1);
+
+			if (m_entry == m_end)
+			{
+				m_entry = nullptr;
+				m_end = nullptr;
+			}
+		}
+		else
+		{
+			m_cause = nullptr;
+		}
+		return *this;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline bool ErrorCauseIterator::operator==(const ErrorCauseIterator& in_other) const noexcept
+	{
+		return m_cause == in_other.m_cause && m_entry == in_other.m_entry;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline bool ErrorCauseIterator::operator!=(const ErrorCauseIterator& in_other) const noexcept
+	{
+		return !(*this == in_other);
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorCauseRange::ErrorCauseRange(ErrorCauseIterator in_begin, std::size_t in_size) noexcept
+		: m_begin(in_begin), m_size(in_size)
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorCauseIterator ErrorCauseRange::begin() const noexcept
+	{
+		return m_begin;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorCauseIterator ErrorCauseRange::end() const noexcept
+	{
+		return ErrorCauseIterator();
+	}
+
+	//-----------------------------------------------------------------------------
+	inline std::size_t ErrorCauseRange::getSize() const noexcept
+	{
+		return m_size;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorTreeIterator::ErrorTreeIterator(const ErrorNode* in_node) noexcept
+		: m_node(in_node)
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorTreeEntry ErrorTreeIterator::operator*() const noexcept
+	{
+		assert(m_node || m_entry);
+		return m_entry ? ErrorTreeEntry{ m_entry->m_node, m_depth + m_entry->m_depth } : ErrorTreeEntry{ m_node, m_depth };
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorTreeIterator& ErrorTreeIterator::operator++() noexcept
+	{
+		// The flattened causes of a node cover everything beneath it, so once they're
+		// reached there's nothing left to follow afterwards.
+		if (m_entry)
+		{
+			if (++m_entry == m_end)
+			{
+				m_entry = nullptr;
+				m_end = nullptr;
+			}
+			return *this;
+		}
+
+		assert(m_node);
+		auto tree = m_node->getDescriptor().m_getCauseTree(*m_node);
+		if (tree.m_size > 0)
+		{
+			m_node = nullptr;
+			m_entry = tree.m_entries;
+			m_end = tree.m_entries + tree.m_size;
+		}
+		else
+		{
+			m_node = m_node->getCausedBy();
+			++m_depth;
+		}
+		return *this;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline bool ErrorTreeIterator::operator==(const ErrorTreeIterator& in_other) const noexcept
+	{
+		return m_node == in_other.m_node && m_entry == in_other.m_entry;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline bool ErrorTreeIterator::operator!=(const ErrorTreeIterator& in_other) const noexcept
+	{
+		return !(*this == in_other);
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorTreeRange::ErrorTreeRange(ErrorTreeIterator in_begin) noexcept
+		: m_begin(in_begin)
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorTreeIterator ErrorTreeRange::begin() const noexcept
+	{
+		return m_begin;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorTreeIterator ErrorTreeRange::end() const noexcept
+	{
+		return ErrorTreeIterator();
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorNodePtr::ErrorNodePtr(const ErrorNode* in_node) noexcept
+		: m_node(in_node)
+	{
+		if (m_node)
+		{
+			m_node->m_descriptor->m_addReference(*m_node);
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorNodePtr::ErrorNodePtr(const ErrorNodePtr& in_toCopy) noexcept
+		: ErrorNodePtr(in_toCopy.m_node)
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorNodePtr::ErrorNodePtr(ErrorNodePtr&& in_toMove) noexcept
+		: m_node(in_toMove.m_node)
+	{
+		in_toMove.m_node = nullptr;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorNodePtr& ErrorNodePtr::operator=(const ErrorNodePtr& in_toCopy) noexcept
+	{
+		ErrorNodePtr(in_toCopy).swap(*this);
+		return *this;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorNodePtr& ErrorNodePtr::operator=(ErrorNodePtr&& in_toMove) noexcept
+	{
+		ErrorNodePtr(std::move(in_toMove)).swap(*this);
+		return *this;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorNodePtr::~ErrorNodePtr() noexcept
+	{
+		if (m_node)
+		{
+			m_node->m_descriptor->m_removeReference(*m_node);
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+	inline void ErrorNodePtr::swap(ErrorNodePtr& io_other) noexcept
+	{
+		std::swap(m_node, io_other.m_node);
+	}
+
+	//-----------------------------------------------------------------------------
+	inline const ErrorNode* ErrorNodePtr::get() const noexcept
+	{
+		return m_node;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline const ErrorNode* ErrorNodePtr::operator->() const noexcept
+	{
+		assert(m_node);
+		return m_node;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline const ErrorNode& ErrorNodePtr::operator*() const noexcept
+	{
+		assert(m_node);
+		return *m_node;
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorNodePtr::operator bool() const noexcept
+	{
+		return m_node != nullptr;
+	}
+}
+
+#endif
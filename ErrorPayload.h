@@ -0,0 +1,421 @@
+// ErrorPayload.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORPAYLOAD_H_
+#define _IC_ERRORPAYLOAD_H_
+
+#include "DeferredMessage.h"
+#include "ErrorCatalog.h"
+#include "ErrorNode.h"
+#include "ErrorTelemetry.h"
+#include "ErrorTree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace IC
+{
+	namespace Detail
+	{
+		/// Describes which member of an ErrorPayload is active. This is stored alongside
+		/// the error by each Result, where it typically fits in padding.
+		///
+		enum class ErrorStorage : std::uint8_t
+		{
+			k_node,
+			k_staticMessage,
+			k_inlineMessage
+		};
+
+		/// A short message stored inline in a result, avoiding any allocation.
+		///
+		template <std::size_t TCapacity> struct InlineMessage final
+		{
+			static_assert(TCapacity <= 255, "The inline message capacity cannot exceed 255 bytes.");
+
+			//-----------------------------------------------------------------------------
+			explicit InlineMessage(std::string_view in_message) noexcept
+				: m_length(static_cast<std::uint8_t>(in_message.size()))
+			{
+				std::memcpy(m_data, in_message.data(), in_message.size());
+			}
+
+			//-----------------------------------------------------------------------------
+			std::string_view get() const noexcept
+			{
+				return std::string_view(m_data, m_length);
+			}
+
+			char m_data[TCapacity];
+			std::uint8_t m_length;
+		};
+
+		/// Inline messages are disabled when the capacity is zero.
+		///
+		template <> struct InlineMessage<0> final
+		{
+			//-----------------------------------------------------------------------------
+			explicit InlineMessage(std::string_view) noexcept
+			{
+			}
+
+			//-----------------------------------------------------------------------------
+			std::string_view get() const noexcept
+			{
+				return std::string_view();
+			}
+		};
+
+		/// Creates the node for a failure without a cause, out of line, so that a failed
+		/// result is constructed with a single call.
+		///
+		/// @param in_error - The error that occurred.
+		/// @param in_errorMessage - A description of the error that occurred.
+		///
+		/// @return The new node.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy, typename TMessage> IC_RESULT_COLD ErrorNodePtr makeColdErrorNode(TError in_error, TMessage in_errorMessage) noexcept
+		{
+			return makeErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage), ErrorNodePtr());
+		}
+
+		/// Creates the node for a failure caused by a failed result or a node, out of line.
+		/// The cause is shared here, rather than by the caller, so that every step of
+		/// wrapping an error is kept out of line.
+		///
+		/// @param in_error - The error that occurred.
+		/// @param in_errorMessage - A description of the error that occurred.
+		/// @param in_causedBy - The failed result or node which caused the error.
+		///
+		/// @return The new node.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy, typename TMessage, typename TCause> IC_RESULT_COLD ErrorNodePtr makeColdErrorNode(TError in_error, TMessage in_errorMessage, const TCause& in_causedBy) noexcept
+		{
+			return makeErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage), in_causedBy.shareError());
+		}
+
+		/// Creates the node for a failure caused by several errors, out of line. See
+		/// ErrorCauses.
+		///
+		/// @param in_error - The error that occurred.
+		/// @param in_errorMessage - A description of the error that occurred.
+		/// @param in_causes - The errors which caused the error.
+		///
+		/// @return The new node.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy, typename TMessage> IC_RESULT_COLD ErrorNodePtr makeColdErrorNode(TError in_error, TMessage in_errorMessage, const ErrorCauses& in_causes) noexcept
+		{
+			return makeErrorTreeNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage), in_causes.getData(), in_causes.getSize());
+		}
+
+		/// The message reported by a failed result whose error node has been moved to
+		/// another result.
+		///
+		inline constexpr char k_movedFromMessage[] = "The error was moved to another result.";
+
+		/// Releases the node held by a payload, if it holds one. This doesn't depend on the
+		/// type of the payload, so a single out of line copy is shared by every result.
+		///
+		/// @param in_storage - The active member of the payload.
+		/// @param io_node - The node member of the payload.
+		///
+		IC_RESULT_COLD inline void releaseErrorPayload(ErrorStorage in_storage, ErrorNodePtr& io_node) noexcept
+		{
+			if (in_storage == ErrorStorage::k_node)
+			{
+				io_node.~ErrorNodePtr();
+			}
+		}
+
+		/// The description of the error stored by a failed result. This is either a
+		/// shared error node, a static message, or a short message stored inline, the
+		/// latter two of which require no allocation. A null static message indicates
+		/// that the message should be looked up in the ErrorCatalog for the error type.
+		/// If the policy captures source locations, every failure is stored as a node,
+		/// which records where it was created.
+		///
+		/// As the payload doesn't know which member is active, the owning Result passes
+		/// the ErrorStorage to each method.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy> union ErrorPayload
+		{
+			static constexpr std::size_t k_inlineCapacity = TPolicy::k_captureSourceLocation ? 0 : TPolicy::k_inlineMessageCapacity;
+
+			/// The storage used for failures with a static or catalog message.
+			///
+			static constexpr ErrorStorage k_staticStorage = TPolicy::k_captureSourceLocation ? ErrorStorage::k_node : ErrorStorage::k_staticMessage;
+
+			/// @param in_errorMessage - The message a failure without a cause will be
+			/// created with.
+			///
+			/// @return The storage which should be used for the message.
+			///
+			static constexpr ErrorStorage getStorage(std::string_view in_errorMessage) noexcept
+			{
+				return in_errorMessage.size() <= k_inlineCapacity && k_inlineCapacity > 0 ? ErrorStorage::k_inlineMessage : ErrorStorage::k_node;
+			}
+
+			/// @param in_error - The error that occurred.
+			/// @param in_node - The node describing the error.
+			/// @param in_location - Where a newly created node's error occurred. This must
+			/// be left empty if the node may already be shared.
+			///
+			ErrorPayload([[maybe_unused]] TError in_error, ErrorNodePtr in_node, [[maybe_unused]] const SourceLocation& in_location = SourceLocation()) noexcept
+				: m_node(std::move(in_node))
+			{
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+				recordFailureTelemetry(in_error, m_node->getChainDepth());
+#endif
+				if constexpr (TPolicy::k_captureSourceLocation)
+				{
+					if (in_location)
+					{
+						setErrorSourceLocation(*m_node, in_location);
+					}
+				}
+			}
+
+			/// Creates the payload for a failure with a static message, using the storage
+			/// given by k_staticStorage.
+			///
+			/// @param in_error - The error that occurred.
+			/// @param in_staticMessage - A description of the error that occurred, or null
+			/// to use the ErrorCatalog.
+			/// @param in_location - Where the error occurred.
+			///
+			ErrorPayload(TError in_error, StaticMessage in_staticMessage, [[maybe_unused]] const SourceLocation& in_location = SourceLocation()) noexcept
+			{
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+				recordFailureTelemetry(in_error, 1);
+#endif
+				if constexpr (TPolicy::k_captureSourceLocation)
+				{
+					new (&m_node) ErrorNodePtr(makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, StaticMessage(resolveStaticMessage(in_error, in_staticMessage.get()))));
+					setErrorSourceLocation(*m_node, in_location);
+				}
+				else
+				{
+					m_staticMessage = in_staticMessage.get();
+				}
+			}
+
+			/// Creates the payload for a failure without a cause, using the storage
+			/// returned by getStorage().
+			///
+			/// @param in_storage - The storage returned by getStorage() for the message.
+			/// @param in_error - The error that occurred.
+			/// @param in_errorMessage - A description of the error that occurred.
+			/// @param in_location - Where the error occurred.
+			///
+			ErrorPayload(ErrorStorage in_storage, TError in_error, std::string_view in_errorMessage, [[maybe_unused]] const SourceLocation& in_location = SourceLocation()) noexcept
+			{
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+				recordFailureTelemetry(in_error, 1);
+#endif
+				if (in_storage == ErrorStorage::k_inlineMessage)
+				{
+					new (&m_inlineMessage) InlineMessage<k_inlineCapacity>(in_errorMessage);
+				}
+				else
+				{
+					new (&m_node) ErrorNodePtr(makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, in_errorMessage));
+					if constexpr (TPolicy::k_captureSourceLocation)
+					{
+						setErrorSourceLocation(*m_node, in_location);
+					}
+				}
+			}
+
+			//-----------------------------------------------------------------------------
+			IC_RESULT_COLD ErrorPayload(ErrorStorage in_storage, const ErrorPayload& in_toCopy) noexcept
+			{
+				switch (in_storage)
+				{
+				case ErrorStorage::k_node:
+					new (&m_node) ErrorNodePtr(in_toCopy.m_node);
+					break;
+				case ErrorStorage::k_staticMessage:
+					m_staticMessage = in_toCopy.m_staticMessage;
+					break;
+				case ErrorStorage::k_inlineMessage:
+					new (&m_inlineMessage) InlineMessage<k_inlineCapacity>(in_toCopy.m_inlineMessage);
+					break;
+				}
+			}
+
+			/// The node is moved without touching its reference count. As the owning result
+			/// of the moved from payload still reports the failure, that payload is left
+			/// holding k_movedFromMessage, and its storage is updated to match.
+			///
+			/// @param in_storage - The active member of the payload to move.
+			/// @param in_toMove - The payload to move.
+			/// @param out_movedFromStorage - The storage of the moved from payload.
+			///
+			ErrorPayload(ErrorStorage in_storage, ErrorPayload&& in_toMove, ErrorStorage& out_movedFromStorage) noexcept
+			{
+				switch (in_storage)
+				{
+				case ErrorStorage::k_node:
+					new (&m_node) ErrorNodePtr(std::move(in_toMove.m_node));
+					in_toMove.m_node.~ErrorNodePtr();
+					in_toMove.m_staticMessage = k_movedFromMessage;
+					out_movedFromStorage = ErrorStorage::k_staticMessage;
+					break;
+				case ErrorStorage::k_staticMessage:
+					m_staticMessage = in_toMove.m_staticMessage;
+					break;
+				case ErrorStorage::k_inlineMessage:
+					new (&m_inlineMessage) InlineMessage<k_inlineCapacity>(in_toMove.m_inlineMessage);
+					break;
+				}
+			}
+
+			ErrorPayload(const ErrorPayload&) = delete;
+			ErrorPayload& operator=(const ErrorPayload&) = delete;
+
+			//-----------------------------------------------------------------------------
+			~ErrorPayload() noexcept
+			{
+			}
+
+			/// Destroys the active member. This must be called before the payload is
+			/// destroyed.
+			///
+			void destroy(ErrorStorage in_storage) noexcept
+			{
+				releaseErrorPayload(in_storage, m_node);
+			}
+
+			//-----------------------------------------------------------------------------
+			IC_RESULT_COLD std::string_view getErrorMessage(ErrorStorage in_storage, TError in_error) const noexcept
+			{
+				switch (in_storage)
+				{
+				case ErrorStorage::k_node:
+					return m_node->getErrorMessage();
+				case ErrorStorage::k_inlineMessage:
+					return m_inlineMessage.get();
+				default:
+					return resolveStaticMessage(in_error, m_staticMessage);
+				}
+			}
+
+			//-----------------------------------------------------------------------------
+			IC_RESULT_COLD const char* getMessageTemplate(ErrorStorage in_storage, TError in_error) const noexcept
+			{
+				switch (in_storage)
+				{
+				case ErrorStorage::k_node:
+					return m_node->getMessageTemplate();
+				case ErrorStorage::k_inlineMessage:
+					return nullptr;
+				default:
+					return resolveStaticMessage(in_error, m_staticMessage);
+				}
+			}
+
+			//-----------------------------------------------------------------------------
+			IC_RESULT_COLD std::uint64_t getFingerprint(ErrorStorage in_storage, TError in_error) const noexcept
+			{
+				auto messageTemplate = getMessageTemplate(in_storage, in_error);
+				return fingerprintErrorChain(&getErrorTypeName<TError>, static_cast<std::int64_t>(in_error), messageTemplate, messageTemplate ? std::string_view() : getErrorMessage(in_storage, in_error), getCauseTree(getNode(in_storage)));
+			}
+
+			//-----------------------------------------------------------------------------
+			IC_RESULT_COLD std::string getFullErrorMessage(ErrorStorage in_storage, TError in_error, ErrorMessageFormat in_format) const noexcept
+			{
+				return buildErrorChain(getErrorMessage(in_storage, in_error), getDiagnostics(in_storage), getCauseTree(getNode(in_storage)), in_format);
+			}
+
+			//-----------------------------------------------------------------------------
+			template <typename TSink> IC_RESULT_COLD void writeFullErrorMessage(ErrorStorage in_storage, TError in_error, TSink& io_sink, ErrorMessageFormat in_format) const noexcept
+			{
+				writeErrorChain(getErrorMessage(in_storage, in_error), getDiagnostics(in_storage), getCauseTree(getNode(in_storage)), in_format, io_sink);
+			}
+
+			//-----------------------------------------------------------------------------
+			const ErrorDiagnostics* getDiagnostics(ErrorStorage in_storage) const noexcept
+			{
+				return in_storage == ErrorStorage::k_node ? m_node->getDiagnostics() : nullptr;
+			}
+
+			//-----------------------------------------------------------------------------
+			SourceLocation getSourceLocation(ErrorStorage in_storage) const noexcept
+			{
+				auto diagnostics = getDiagnostics(in_storage);
+				return diagnostics ? diagnostics->m_sourceLocation : SourceLocation();
+			}
+
+			//-----------------------------------------------------------------------------
+			const ErrorNode* getCausedBy(ErrorStorage in_storage) const noexcept
+			{
+				return in_storage == ErrorStorage::k_node ? m_node->getCausedBy() : nullptr;
+			}
+
+			//-----------------------------------------------------------------------------
+			ErrorCauseRange getCauses(ErrorStorage in_storage) const noexcept
+			{
+				return in_storage == ErrorStorage::k_node ? m_node->getCauses() : ErrorCauseRange();
+			}
+
+			/// @return The node, or null if the payload doesn't hold one, in which case the
+			/// error has no causes.
+			///
+			const ErrorNode* getNode(ErrorStorage in_storage) const noexcept
+			{
+				return in_storage == ErrorStorage::k_node ? m_node.get() : nullptr;
+			}
+
+			/// Static and inline messages are promoted to a node the first time they are
+			/// shared, so errors which are never used as a cause never allocate.
+			///
+			IC_RESULT_COLD ErrorNodePtr shareError(ErrorStorage in_storage, TError in_error) const noexcept
+			{
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+				recordShareTelemetry(in_error);
+#endif
+				switch (in_storage)
+				{
+				case ErrorStorage::k_node:
+					return m_node;
+				case ErrorStorage::k_inlineMessage:
+					return makeErrorNode<TError, TErrorSuccess, TPolicy>(in_error, m_inlineMessage.get(), ErrorNodePtr());
+				default:
+					return makeErrorNode<TError, TErrorSuccess, TPolicy>(in_error, StaticMessage(resolveStaticMessage(in_error, m_staticMessage)), ErrorNodePtr());
+				}
+			}
+
+			ErrorNodePtr m_node;
+			const char* m_staticMessage;
+			InlineMessage<k_inlineCapacity> m_inlineMessage;
+		};
+	}
+}
+
+#endif
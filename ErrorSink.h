@@ -0,0 +1,187 @@
+// ErrorSink.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORSINK_H_
+#define _IC_ERRORSINK_H_
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace IC
+{
+	/// A sink which appends full error messages to a string. The string isn't cleared
+	/// first, so a single buffer can be cleared and reused to avoid reallocating for
+	/// every message.
+	///
+	/// A sink is any type with the following methods, and can be passed to
+	/// writeFullErrorMessage():
+	///
+	///     void reserve(std::size_t in_size);
+	///     void append(std::string_view in_text);
+	///
+	/// reserve() is called once with the total length of the message before it is
+	/// appended in pieces.
+	///
+	class StringErrorSink final
+	{
+	public:
+		/// @param io_string - The string to append to.
+		///
+		explicit StringErrorSink(std::string& io_string) noexcept
+			: m_string(io_string)
+		{
+		}
+
+		/// @param in_size - The number of characters which are about to be appended.
+		///
+		void reserve(std::size_t in_size)
+		{
+			m_string.reserve(m_string.size() + in_size);
+		}
+
+		/// @param in_text - The text to append.
+		///
+		void append(std::string_view in_text)
+		{
+			m_string.append(in_text.data(), in_text.size());
+		}
+
+	private:
+		std::string& m_string;
+	};
+
+	/// A sink which writes full error messages to a stream.
+	///
+	class StreamErrorSink final
+	{
+	public:
+		/// @param io_stream - The stream to write to.
+		///
+		explicit StreamErrorSink(std::ostream& io_stream) noexcept
+			: m_stream(io_stream)
+		{
+		}
+
+		/// Streams can't be pre-sized, so this does nothing.
+		///
+		/// @param in_size - The number of characters which are about to be written.
+		///
+		void reserve(std::size_t in_size) noexcept
+		{
+			(void)in_size;
+		}
+
+		/// @param in_text - The text to write.
+		///
+		void append(std::string_view in_text)
+		{
+			m_stream.write(in_text.data(), std::streamsize(in_text.size()));
+		}
+
+	private:
+		std::ostream& m_stream;
+	};
+
+	/// A sink which writes full error messages to a fixed size buffer, truncating them if
+	/// they don't fit. The buffer is always null terminated. This never allocates, so is
+	/// suitable for logging from signal handlers or under memory pressure.
+	///
+	class FixedBufferErrorSink final
+	{
+	public:
+		/// @param out_buffer - The buffer to write to.
+		/// @param in_capacity - The size of the buffer in bytes, including the null
+		/// terminator.
+		///
+		FixedBufferErrorSink(char* out_buffer, std::size_t in_capacity) noexcept
+			: m_buffer(out_buffer), m_capacity(in_capacity)
+		{
+			if (m_capacity > 0)
+			{
+				m_buffer[0] = '\0';
+			}
+		}
+
+		/// @param out_buffer - The buffer to write to.
+		///
+		template <std::size_t TCapacity> explicit FixedBufferErrorSink(char (&out_buffer)[TCapacity]) noexcept
+			: FixedBufferErrorSink(out_buffer, TCapacity)
+		{
+		}
+
+		/// The buffer is fixed, so this does nothing.
+		///
+		/// @param in_size - The number of characters which are about to be appended.
+		///
+		void reserve(std::size_t in_size) noexcept
+		{
+			(void)in_size;
+		}
+
+		/// Appends as much of the text as will fit.
+		///
+		/// @param in_text - The text to append.
+		///
+		void append(std::string_view in_text) noexcept
+		{
+			if (m_capacity == 0)
+			{
+				m_truncated = m_truncated || !in_text.empty();
+				return;
+			}
+
+			auto available = m_capacity - 1 - m_length;
+			auto length = in_text.size() < available ? in_text.size() : available;
+			std::memcpy(m_buffer + m_length, in_text.data(), length);
+			m_length += length;
+			m_buffer[m_length] = '\0';
+			m_truncated = m_truncated || length < in_text.size();
+		}
+
+		/// @return The text written so far.
+		///
+		std::string_view getMessage() const noexcept
+		{
+			return std::string_view(m_buffer, m_length);
+		}
+
+		/// @return Whether or not any text was discarded because the buffer was full.
+		///
+		bool isTruncated() const noexcept
+		{
+			return m_truncated;
+		}
+
+	private:
+		char* m_buffer;
+		std::size_t m_capacity;
+		std::size_t m_length = 0;
+		bool m_truncated = false;
+	};
+}
+
+#endif
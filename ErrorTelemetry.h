@@ -0,0 +1,501 @@
+// ErrorTelemetry.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORTELEMETRY_H_
+#define _IC_ERRORTELEMETRY_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace IC
+{
+	/// The telemetry recorded for a single value of a single error type.
+	///
+	struct ErrorTelemetryEntry final
+	{
+		/// The name of the error type, as reported by the compiler.
+		///
+		std::string_view m_errorType;
+
+		/// The error value, converted to an integer.
+		///
+		std::int64_t m_errorCode = 0;
+
+		/// The number of failed results created with this error.
+		///
+		std::uint64_t m_failures = 0;
+
+		/// The number of times a failure with this error was shared, typically to become
+		/// the cause of another error.
+		///
+		std::uint64_t m_shares = 0;
+
+		/// The number of bytes allocated for the messages of failures with this error.
+		///
+		std::uint64_t m_messageBytes = 0;
+	};
+
+	/// The telemetry aggregated from every thread at the time of the snapshot. All values
+	/// are totals since the program started, so periodic scrapes should diff consecutive
+	/// snapshots.
+	///
+	struct ErrorTelemetrySnapshot final
+	{
+		/// The number of buckets in the chain depth histogram.
+		///
+		static constexpr std::size_t k_chainDepthBuckets = 8;
+
+		/// The entries for each error, ordered by the number of failures, highest first.
+		///
+		std::vector<ErrorTelemetryEntry> m_entries;
+
+		/// A histogram of the length of the cause chain of each failure, including the
+		/// failure itself. Bucket i counts chains with a length in [2^i, 2^(i + 1)), and
+		/// the last bucket counts all longer chains.
+		///
+		std::array<std::uint64_t, k_chainDepthBuckets> m_chainDepths = {};
+
+		/// The number of events which could not be attributed to an entry as the thread
+		/// had already seen too many distinct errors.
+		///
+		std::uint64_t m_untrackedEvents = 0;
+	};
+
+	/// Aggregates the telemetry recorded by every thread, including threads which have
+	/// since exited. This takes a lock, but only contends with threads recording their
+	/// first error or exiting, never with the recording itself.
+	///
+	/// Telemetry is only recorded when IC_RESULT_ENABLE_TELEMETRY is defined; otherwise
+	/// the snapshot is always empty.
+	///
+	/// @return The snapshot.
+	///
+	ErrorTelemetrySnapshot getErrorTelemetrySnapshot() noexcept;
+
+	namespace Detail
+	{
+		/// Identifies an error type. Each error type has a distinct function.
+		///
+		using ErrorTypeNameGetter = std::string_view (*)() noexcept;
+
+		/// @param in_signature - The signature of getErrorTypeName(), as reported by the
+		/// compiler.
+		///
+		/// @return The name of the error type in the signature.
+		///
+		inline std::string_view parseErrorTypeName(std::string_view in_signature) noexcept
+		{
+#if defined(__clang__) || defined(__GNUC__)
+			constexpr std::string_view k_prefix = "TError = ";
+			auto start = in_signature.find(k_prefix);
+			if (start == std::string_view::npos)
+			{
+				return in_signature;
+			}
+
+			start += k_prefix.size();
+			return in_signature.substr(start, in_signature.find_first_of(";]", start) - start);
+#elif defined(_MSC_VER)
+			constexpr std::string_view k_prefix = "getErrorTypeName<";
+			auto start = in_signature.find(k_prefix);
+			if (start == std::string_view::npos)
+			{
+				return in_signature;
+			}
+
+			start += k_prefix.size();
+			return in_signature.substr(start, in_signature.rfind(">(") - start);
+#else
+			(void)in_signature;
+			return "unknown";
+#endif
+		}
+
+		/// The name is parsed from the signature of the function the first time it's
+		/// requested, and cached.
+		///
+		/// @return The name of the given error type, as reported by the compiler.
+		///
+		template <typename TError> std::string_view getErrorTypeName() noexcept
+		{
+#if defined(__clang__) || defined(__GNUC__)
+			static const std::string_view s_name = parseErrorTypeName(__PRETTY_FUNCTION__);
+#elif defined(_MSC_VER)
+			static const std::string_view s_name = parseErrorTypeName(__FUNCSIG__);
+#else
+			static const std::string_view s_name = parseErrorTypeName(std::string_view());
+#endif
+			return s_name;
+		}
+
+		/// @param in_chainDepth - The length of a cause chain, which must be at least 1.
+		///
+		/// @return The chain depth histogram bucket for the length.
+		///
+		constexpr std::size_t getChainDepthBucket(std::uint32_t in_chainDepth) noexcept
+		{
+			std::size_t bucket = 0;
+			while (bucket + 1 < ErrorTelemetrySnapshot::k_chainDepthBuckets && (in_chainDepth >> (bucket + 1)) != 0)
+			{
+				++bucket;
+			}
+			return bucket;
+		}
+
+		/// The telemetry recorded by a single thread. Only the owning thread ever writes to
+		/// a shard, so the counters are updated with a relaxed load and store rather than a
+		/// read-modify-write; these compile to plain loads and stores, with no locks or
+		/// locked instructions, but still allow the snapshot to read the shard from another
+		/// thread. Entries are kept in a fixed size open addressed table, so recording
+		/// never allocates.
+		///
+		class ErrorTelemetryShard final
+		{
+		public:
+			static constexpr std::size_t k_capacity = 256;
+
+			/// Records the creation of a failed result.
+			///
+			/// @param in_errorType - Identifies the error type.
+			/// @param in_errorCode - The error value, converted to an integer.
+			/// @param in_chainDepth - The length of the cause chain, including the failure.
+			///
+			void recordFailure(ErrorTypeNameGetter in_errorType, std::int64_t in_errorCode, std::uint32_t in_chainDepth) noexcept
+			{
+				add(m_chainDepths[getChainDepthBucket(in_chainDepth)], 1);
+				if (auto slot = findSlot(in_errorType, in_errorCode))
+				{
+					add(slot->m_failures, 1);
+				}
+				else
+				{
+					add(m_untrackedEvents, 1);
+				}
+			}
+
+			/// Records the sharing of a failed result.
+			///
+			/// @param in_errorType - Identifies the error type.
+			/// @param in_errorCode - The error value, converted to an integer.
+			///
+			void recordShare(ErrorTypeNameGetter in_errorType, std::int64_t in_errorCode) noexcept
+			{
+				if (auto slot = findSlot(in_errorType, in_errorCode))
+				{
+					add(slot->m_shares, 1);
+				}
+				else
+				{
+					add(m_untrackedEvents, 1);
+				}
+			}
+
+			/// Records the allocation of an error message.
+			///
+			/// @param in_errorType - Identifies the error type.
+			/// @param in_errorCode - The error value, converted to an integer.
+			/// @param in_bytes - The number of bytes allocated for the message.
+			///
+			void recordMessageBytes(ErrorTypeNameGetter in_errorType, std::int64_t in_errorCode, std::size_t in_bytes) noexcept
+			{
+				if (auto slot = findSlot(in_errorType, in_errorCode))
+				{
+					add(slot->m_messageBytes, in_bytes);
+				}
+				else
+				{
+					add(m_untrackedEvents, 1);
+				}
+			}
+
+			/// Adds the counters in this shard to another. This may be called from any
+			/// thread, but the caller must be the only writer to the target shard.
+			///
+			/// @param io_shard - The shard to add to.
+			///
+			void addTo(ErrorTelemetryShard& io_shard) const noexcept
+			{
+				for (auto& slot : m_slots)
+				{
+					auto errorType = slot.m_errorType.load(std::memory_order_acquire);
+					if (!errorType)
+					{
+						continue;
+					}
+
+					if (auto target = io_shard.findSlot(errorType, slot.m_errorCode.load(std::memory_order_relaxed)))
+					{
+						add(target->m_failures, slot.m_failures.load(std::memory_order_relaxed));
+						add(target->m_shares, slot.m_shares.load(std::memory_order_relaxed));
+						add(target->m_messageBytes, slot.m_messageBytes.load(std::memory_order_relaxed));
+					}
+					else
+					{
+						add(io_shard.m_untrackedEvents, slot.m_failures.load(std::memory_order_relaxed) + slot.m_shares.load(std::memory_order_relaxed));
+					}
+				}
+
+				for (std::size_t bucket = 0; bucket < m_chainDepths.size(); ++bucket)
+				{
+					add(io_shard.m_chainDepths[bucket], m_chainDepths[bucket].load(std::memory_order_relaxed));
+				}
+				add(io_shard.m_untrackedEvents, m_untrackedEvents.load(std::memory_order_relaxed));
+			}
+
+			/// @return The snapshot of the counters in this shard. This must only be called
+			/// by the thread which writes to the shard.
+			///
+			ErrorTelemetrySnapshot getSnapshot() const noexcept;
+
+		private:
+			/// The counters for a single error. The error type is written last, with
+			/// release semantics, so a reader which sees the type also sees the code.
+			///
+			struct Slot final
+			{
+				std::atomic<ErrorTypeNameGetter> m_errorType{nullptr};
+				std::atomic<std::int64_t> m_errorCode{0};
+				std::atomic<std::uint64_t> m_failures{0};
+				std::atomic<std::uint64_t> m_shares{0};
+				std::atomic<std::uint64_t> m_messageBytes{0};
+			};
+
+			//-----------------------------------------------------------------------------
+			static void add(std::atomic<std::uint64_t>& io_counter, std::uint64_t in_amount) noexcept
+			{
+				io_counter.store(io_counter.load(std::memory_order_relaxed) + in_amount, std::memory_order_relaxed);
+			}
+
+			/// Finds the slot for the given error, claiming an empty slot if there is none.
+			///
+			/// @param in_errorType - Identifies the error type.
+			/// @param in_errorCode - The error value, converted to an integer.
+			///
+			/// @return The slot, or null if the table is full.
+			///
+			Slot* findSlot(ErrorTypeNameGetter in_errorType, std::int64_t in_errorCode) noexcept
+			{
+				auto key = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(in_errorType)) ^ static_cast<std::uint64_t>(in_errorCode);
+				auto hash = static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> 56);
+				for (std::size_t probe = 0; probe < k_capacity; ++probe)
+				{
+					auto& slot = m_slots[(hash + probe) & (k_capacity - 1)];
+					auto errorType = slot.m_errorType.load(std::memory_order_relaxed);
+					if (!errorType)
+					{
+						slot.m_errorCode.store(in_errorCode, std::memory_order_relaxed);
+						slot.m_errorType.store(in_errorType, std::memory_order_release);
+						return &slot;
+					}
+
+					if (errorType == in_errorType && slot.m_errorCode.load(std::memory_order_relaxed) == in_errorCode)
+					{
+						return &slot;
+					}
+				}
+
+				return nullptr;
+			}
+
+			std::array<Slot, k_capacity> m_slots;
+			std::array<std::atomic<std::uint64_t>, ErrorTelemetrySnapshot::k_chainDepthBuckets> m_chainDepths = {};
+			std::atomic<std::uint64_t> m_untrackedEvents{0};
+		};
+
+		/// The list of every thread's shard, along with the totals from threads which have
+		/// exited. The registry is only locked when a thread records its first error, when
+		/// it exits, and when a snapshot is taken.
+		///
+		class ErrorTelemetryRegistry final
+		{
+		public:
+			/// @return The registry. This is never destroyed, so threads which outlive
+			/// static destruction can still retire their shards safely.
+			///
+			static ErrorTelemetryRegistry& get() noexcept
+			{
+				static auto s_registry = new ErrorTelemetryRegistry();
+				return *s_registry;
+			}
+
+			/// @param in_shard - The shard for a new thread.
+			///
+			void addShard(const ErrorTelemetryShard* in_shard) noexcept
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_shards.push_back(in_shard);
+			}
+
+			/// Removes the shard for an exiting thread, keeping its totals.
+			///
+			/// @param in_shard - The shard to remove.
+			///
+			void retireShard(const ErrorTelemetryShard* in_shard) noexcept
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				in_shard->addTo(m_retired);
+				for (auto& shard : m_shards)
+				{
+					if (shard == in_shard)
+					{
+						shard = m_shards.back();
+						m_shards.pop_back();
+						break;
+					}
+				}
+			}
+
+			/// @return The totals of every shard, current and retired.
+			///
+			ErrorTelemetrySnapshot getSnapshot() noexcept
+			{
+				auto totals = std::make_unique<ErrorTelemetryShard>();
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_retired.addTo(*totals);
+					for (auto shard : m_shards)
+					{
+						shard->addTo(*totals);
+					}
+				}
+
+				return totals->getSnapshot();
+			}
+
+		private:
+			ErrorTelemetryRegistry() noexcept = default;
+
+			std::mutex m_mutex;
+			std::vector<const ErrorTelemetryShard*> m_shards;
+			ErrorTelemetryShard m_retired;
+		};
+
+		/// Owns the shard for a thread, registering it when the thread first records an
+		/// error and retiring it when the thread exits.
+		///
+		class ThreadErrorTelemetry final
+		{
+		public:
+			//-----------------------------------------------------------------------------
+			ThreadErrorTelemetry() noexcept
+			{
+				ErrorTelemetryRegistry::get().addShard(&m_shard);
+			}
+
+			ThreadErrorTelemetry(const ThreadErrorTelemetry&) = delete;
+			ThreadErrorTelemetry& operator=(const ThreadErrorTelemetry&) = delete;
+
+			//-----------------------------------------------------------------------------
+			~ThreadErrorTelemetry() noexcept
+			{
+				ErrorTelemetryRegistry::get().retireShard(&m_shard);
+			}
+
+			ErrorTelemetryShard m_shard;
+		};
+
+		/// @return The shard for the calling thread.
+		///
+		inline ErrorTelemetryShard& getThreadErrorTelemetryShard() noexcept
+		{
+			static thread_local ThreadErrorTelemetry s_telemetry;
+			return s_telemetry.m_shard;
+		}
+
+		/// Records the creation of a failed result with the given error.
+		///
+		/// @param in_error - The error.
+		/// @param in_chainDepth - The length of the cause chain, including the failure.
+		///
+		template <typename TError> void recordFailureTelemetry(TError in_error, std::uint32_t in_chainDepth) noexcept
+		{
+			getThreadErrorTelemetryShard().recordFailure(&getErrorTypeName<TError>, static_cast<std::int64_t>(in_error), in_chainDepth);
+		}
+
+		/// Records the sharing of a failed result with the given error.
+		///
+		/// @param in_error - The error.
+		///
+		template <typename TError> void recordShareTelemetry(TError in_error) noexcept
+		{
+			getThreadErrorTelemetryShard().recordShare(&getErrorTypeName<TError>, static_cast<std::int64_t>(in_error));
+		}
+
+		/// Records the allocation of a message for a failure with the given error.
+		///
+		/// @param in_error - The error.
+		/// @param in_bytes - The number of bytes allocated for the message.
+		///
+		template <typename TError> void recordMessageTelemetry(TError in_error, std::size_t in_bytes) noexcept
+		{
+			getThreadErrorTelemetryShard().recordMessageBytes(&getErrorTypeName<TError>, static_cast<std::int64_t>(in_error), in_bytes);
+		}
+
+		//-----------------------------------------------------------------------------
+		inline ErrorTelemetrySnapshot ErrorTelemetryShard::getSnapshot() const noexcept
+		{
+			ErrorTelemetrySnapshot snapshot;
+			for (auto& slot : m_slots)
+			{
+				if (auto errorType = slot.m_errorType.load(std::memory_order_relaxed))
+				{
+					ErrorTelemetryEntry entry;
+					entry.m_errorType = errorType();
+					entry.m_errorCode = slot.m_errorCode.load(std::memory_order_relaxed);
+					entry.m_failures = slot.m_failures.load(std::memory_order_relaxed);
+					entry.m_shares = slot.m_shares.load(std::memory_order_relaxed);
+					entry.m_messageBytes = slot.m_messageBytes.load(std::memory_order_relaxed);
+					snapshot.m_entries.push_back(entry);
+				}
+			}
+
+			std::sort(snapshot.m_entries.begin(), snapshot.m_entries.end(), [](const ErrorTelemetryEntry& in_a, const ErrorTelemetryEntry& in_b)
+			{
+				return in_a.m_failures > in_b.m_failures;
+			});
+
+			for (std::size_t bucket = 0; bucket < m_chainDepths.size(); ++bucket)
+			{
+				snapshot.m_chainDepths[bucket] = m_chainDepths[bucket].load(std::memory_order_relaxed);
+			}
+			snapshot.m_untrackedEvents = m_untrackedEvents.load(std::memory_order_relaxed);
+			return snapshot;
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+	inline ErrorTelemetrySnapshot getErrorTelemetrySnapshot() noexcept
+	{
+		return Detail::ErrorTelemetryRegistry::get().getSnapshot();
+	}
+}
+
+#endif
@@ -0,0 +1,513 @@
+// ErrorTree.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORTREE_H_
+#define _IC_ERRORTREE_H_
+
+#include "DeferredMessage.h"
+#include "ErrorCatalog.h"
+#include "ErrorNode.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace IC
+{
+	/// The errors which caused a failure with several causes, such as a request which
+	/// fanned out to several services, a batch in which several items failed, or an
+	/// operation which failed after several retries. It can be passed as the cause of a
+	/// failed result, in place of a single cause:
+	///
+	///     IC::ErrorCauses causes;
+	///     for (auto& response : responses)
+	///     {
+	///         if (!response)
+	///         {
+	///             causes.add(response);
+	///         }
+	///     }
+	///     return IC::Error<FetchError>(FetchError::k_failed, "Some of the requests failed.", causes);
+	///
+	/// The causes are shared rather than copied. The failure stores every error beneath
+	/// it as a single flat array, in pre-order, in the same allocation as its own node,
+	/// so the whole tree can be walked without recursion or following a pointer per
+	/// level. The failure's getCausedBy() returns the first cause, so code which only
+	/// follows a chain still sees it.
+	///
+	class ErrorCauses final
+	{
+	public:
+		/// Adds a cause. The cause can be a failed Result with any template parameters,
+		/// or an ErrorNode.
+		///
+		/// @param in_cause - The cause.
+		///
+		template <typename TCause> void add(const TCause& in_cause) noexcept
+		{
+			m_causes.push_back(in_cause.shareError());
+		}
+
+		/// @param in_cause - The node describing the cause. This must not be null.
+		///
+		void add(ErrorNodePtr in_cause) noexcept
+		{
+			assert(in_cause);
+			m_causes.push_back(std::move(in_cause));
+		}
+
+		/// @param in_count - The number of causes which will be added.
+		///
+		void reserve(std::size_t in_count) noexcept
+		{
+			m_causes.reserve(in_count);
+		}
+
+		/// Causes always describe failures, even if none have been added, in which case
+		/// a failure is created without a cause.
+		///
+		/// @return false.
+		///
+		bool wasSuccessful() const noexcept
+		{
+			return false;
+		}
+
+		/// @return The causes.
+		///
+		const ErrorNodePtr* getData() const noexcept
+		{
+			return m_causes.data();
+		}
+
+		/// @return The number of causes.
+		///
+		std::size_t getSize() const noexcept
+		{
+			return m_causes.size();
+		}
+
+	private:
+		std::vector<ErrorNodePtr> m_causes;
+	};
+
+	namespace Detail
+	{
+		/// The base for the error nodes created for failures with more than one cause. The
+		/// node and the flattened causes are stored in a single allocation, with the
+		/// causes directly after the derived node, TNode. The first cause is also held as
+		/// the cause of the node, so that getCausedBy() returns it.
+		///
+		/// The entries for the direct causes hold a reference to them, which keeps every
+		/// error beneath them alive. As nodes are immutable, the entries for those can
+		/// simply point to them.
+		///
+		template <typename TNode, typename TError, TError TErrorSuccess, typename TPolicy> class ErrorTreeNodeBase : public TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>
+		{
+		public:
+			ErrorTreeNodeBase(const ErrorTreeNodeBase&) = delete;
+			ErrorTreeNodeBase& operator=(const ErrorTreeNodeBase&) = delete;
+
+			/// @param in_causes - The causes.
+			/// @param in_causeCount - The number of causes.
+			///
+			/// @return The number of entries needed to store the causes and every error
+			/// beneath them.
+			///
+			static std::uint32_t countEntries(const ErrorNodePtr* in_causes, std::size_t in_causeCount) noexcept
+			{
+				std::uint32_t entryCount = 0;
+				for (std::size_t i = 0; i < in_causeCount; ++i)
+				{
+					for (auto entry : in_causes[i]->getErrorTree())
+					{
+						(void)entry;
+						++entryCount;
+					}
+				}
+				return entryCount;
+			}
+
+			//-----------------------------------------------------------------------------
+			static ErrorCauseTree readCauseTree(const ErrorNode& in_node) noexcept
+			{
+				auto& node = static_cast<const ErrorTreeNodeBase&>(in_node);
+				ErrorCauseTree tree;
+				tree.m_entries = node.getEntries();
+				tree.m_size = node.m_entryCount;
+				tree.m_causeCount = node.m_causeCount;
+				return tree;
+			}
+
+		protected:
+			//-----------------------------------------------------------------------------
+			ErrorTreeNodeBase(TError in_error, const ErrorNodePtr* in_causes, std::size_t in_causeCount, std::uint32_t in_entryCount) noexcept
+				: TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>(TypedErrorNodeBase<TError, TErrorSuccess, TPolicy>::template getNodeDescriptor<TNode>(), in_error, in_causes[0], getCauseChainDepth(in_causes, in_causeCount)),
+				m_entryCount(in_entryCount), m_causeCount(static_cast<std::uint32_t>(in_causeCount))
+			{
+				auto entry = getEntries();
+				for (std::size_t i = 0; i < in_causeCount; ++i)
+				{
+					if (i > 0)
+					{
+						in_causes[i]->getDescriptor().m_addReference(*in_causes[i]);
+					}
+
+					for (auto causeEntry : in_causes[i]->getErrorTree())
+					{
+						*entry++ = ErrorTreeEntry{ causeEntry.m_node, causeEntry.m_depth + 1 };
+					}
+				}
+			}
+
+			//-----------------------------------------------------------------------------
+			~ErrorTreeNodeBase() noexcept
+			{
+				// The first cause is released by the base.
+				for (auto entry = getEntries() + 1; entry != getEntries() + m_entryCount; ++entry)
+				{
+					if (entry->m_depth == 1)
+					{
+						entry->m_node->getDescriptor().m_removeReference(*entry->m_node);
+					}
+				}
+			}
+
+			/// @return The size of the node and its entries.
+			///
+			std::size_t getTreeAllocationSize() const noexcept
+			{
+				return sizeof(TNode) + m_entryCount * sizeof(ErrorTreeEntry);
+			}
+
+			/// @return The end of the entries, where any data stored after them starts.
+			///
+			char* getEntriesEnd() const noexcept
+			{
+				return reinterpret_cast<char*>(getEntries() + m_entryCount);
+			}
+
+		private:
+			/// @return The flattened causes, which are stored directly after the node.
+			///
+			ErrorTreeEntry* getEntries() const noexcept
+			{
+				return reinterpret_cast<ErrorTreeEntry*>(const_cast<TNode*>(static_cast<const TNode*>(this)) + 1);
+			}
+
+			/// @return The deepest cause chain of the causes, which is recorded by the
+			/// telemetry.
+			///
+			static std::uint32_t getCauseChainDepth([[maybe_unused]] const ErrorNodePtr* in_causes, [[maybe_unused]] std::size_t in_causeCount) noexcept
+			{
+				std::uint32_t causeChainDepth = 0;
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+				for (std::size_t i = 0; i < in_causeCount; ++i)
+				{
+					auto chainDepth = in_causes[i]->getChainDepth();
+					causeChainDepth = chainDepth > causeChainDepth ? chainDepth : causeChainDepth;
+				}
+#endif
+				return causeChainDepth;
+			}
+
+			const std::uint32_t m_entryCount;
+			const std::uint32_t m_causeCount;
+		};
+
+		/// The error node created for failures with more than one cause and a message which
+		/// has already been formatted, or is static. Unless it is static, the message is
+		/// stored after the flattened causes, in the same allocation.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy> class ErrorTreeNode final : public ErrorTreeNodeBase<ErrorTreeNode<TError, TErrorSuccess, TPolicy>, TError, TErrorSuccess, TPolicy>
+		{
+			using Base = ErrorTreeNodeBase<ErrorTreeNode<TError, TErrorSuccess, TPolicy>, TError, TErrorSuccess, TPolicy>;
+
+		public:
+			/// @param in_error - The error that occurred.
+			/// @param in_errorMessage - A description of the error that occurred.
+			/// @param in_messageTemplate - The static message or format template the
+			/// message was built from, or null if it was built dynamically.
+			/// @param in_copyMessage - Whether the message should be copied into the node,
+			/// rather than only a pointer to it stored.
+			/// @param in_causes - The causes. There must be at least two.
+			/// @param in_causeCount - The number of causes.
+			///
+			/// @return The new node. If the allocator of the policy fails, the node is
+			/// allocated from the emergency reserve instead. See createReserved().
+			///
+			static ErrorNodePtr create(TError in_error, std::string_view in_errorMessage, const char* in_messageTemplate, bool in_copyMessage, const ErrorNodePtr* in_causes, std::size_t in_causeCount) noexcept
+			{
+				assert(in_causeCount > 1);
+
+				auto entryCount = Base::countEntries(in_causes, in_causeCount);
+				auto messageLength = in_copyMessage ? in_errorMessage.size() : 0;
+				auto memory = allocateNodeMemory<TPolicy>(sizeof(ErrorTreeNode) + entryCount * sizeof(ErrorTreeEntry) + messageLength);
+				if (!memory)
+				{
+					return createReserved(in_error, in_errorMessage, in_messageTemplate, in_causes, in_causeCount);
+				}
+
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+				recordMessageTelemetry(in_error, messageLength);
+#endif
+				return ErrorNodePtr(new (memory) ErrorTreeNode(in_error, in_errorMessage, std::string_view(), in_messageTemplate, in_copyMessage, in_causes, in_causeCount, entryCount));
+			}
+
+			/// Creates the node from the emergency reserve, for use when the allocator of
+			/// the policy fails. As much of the tree as fits in a block of the reserve is
+			/// kept, starting from the first cause, and the number of causes which didn't
+			/// fit is appended to the message and recorded in the reserve stats. If not even
+			/// the first cause's tree fits, the usual node is created with the first cause
+			/// alone.
+			///
+			/// @param in_error - The error that occurred.
+			/// @param in_errorMessage - A description of the error that occurred.
+			/// @param in_messageTemplate - The static message or format template the
+			/// message was built from, or null if it was built dynamically.
+			/// @param in_causes - The causes. There must be at least two.
+			/// @param in_causeCount - The number of causes.
+			///
+			/// @return The new node.
+			///
+			IC_RESULT_COLD static ErrorNodePtr createReserved(TError in_error, std::string_view in_errorMessage, const char* in_messageTemplate, const ErrorNodePtr* in_causes, std::size_t in_causeCount) noexcept
+			{
+				constexpr std::size_t k_maxNoteSize = 48;
+				constexpr auto k_available = getReservedNodeCapacity<TPolicy>();
+
+				std::size_t keptCauses = 0;
+				std::uint32_t entryCount = 0;
+				for (; keptCauses < in_causeCount; ++keptCauses)
+				{
+					auto causeEntries = Base::countEntries(in_causes + keptCauses, 1);
+					if (sizeof(ErrorTreeNode) + (entryCount + causeEntries) * sizeof(ErrorTreeEntry) + k_maxNoteSize > k_available)
+					{
+						break;
+					}
+					entryCount += causeEntries;
+				}
+
+				char note[k_maxNoteSize];
+				auto droppedCauses = in_causeCount - (keptCauses > 0 ? keptCauses : 1);
+				auto noteLength = droppedCauses > 0 ? std::snprintf(note, sizeof(note), " (%zu further causes were dropped.)", droppedCauses) : 0;
+				auto noteView = std::string_view(note, noteLength > 0 ? std::size_t(noteLength) : 0);
+				if (droppedCauses > 0)
+				{
+					ErrorReserve::recordDroppedCauses(droppedCauses);
+				}
+
+				if (keptCauses == 0)
+				{
+					char message[ErrorReserve::k_blockSize];
+					auto messageLength = std::min(in_errorMessage.size(), sizeof(message) - noteView.size());
+					std::memcpy(message, in_errorMessage.data(), messageLength);
+					std::memcpy(message + messageLength, noteView.data(), noteView.size());
+					return makeErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::string_view(message, messageLength + noteView.size()), in_causes[0]);
+				}
+
+				auto minSize = sizeof(ErrorTreeNode) + entryCount * sizeof(ErrorTreeEntry) + noteView.size();
+				auto size = minSize + in_errorMessage.size();
+				auto memory = allocateReservedNodeMemory<TPolicy>(size, minSize);
+				return ErrorNodePtr(new (memory) ErrorTreeNode(in_error, in_errorMessage.substr(0, size - minSize), noteView, in_messageTemplate, true, in_causes, keptCauses, entryCount));
+			}
+
+			//-----------------------------------------------------------------------------
+			static std::string_view readErrorMessage(const ErrorNode& in_node) noexcept
+			{
+				auto& node = static_cast<const ErrorTreeNode&>(in_node);
+				return std::string_view(node.m_errorMessage, node.m_errorMessageLength);
+			}
+
+			//-----------------------------------------------------------------------------
+			static const char* readMessageTemplate(const ErrorNode& in_node) noexcept
+			{
+				return static_cast<const ErrorTreeNode&>(in_node).m_messageTemplate;
+			}
+
+			//-----------------------------------------------------------------------------
+			std::size_t getAllocationSize() const noexcept
+			{
+				return this->getTreeAllocationSize() + (m_ownsMessage ? m_errorMessageLength : 0);
+			}
+
+		private:
+			//-----------------------------------------------------------------------------
+			ErrorTreeNode(TError in_error, std::string_view in_errorMessage, std::string_view in_note, const char* in_messageTemplate, bool in_copyMessage, const ErrorNodePtr* in_causes, std::size_t in_causeCount, std::uint32_t in_entryCount) noexcept
+				: Base(in_error, in_causes, in_causeCount, in_entryCount), m_messageTemplate(in_messageTemplate), m_errorMessageLength(in_errorMessage.size() + in_note.size()), m_ownsMessage(in_copyMessage)
+			{
+				assert(in_copyMessage || in_note.empty());
+
+				if (m_ownsMessage)
+				{
+					auto message = this->getEntriesEnd();
+					std::memcpy(message, in_errorMessage.data(), in_errorMessage.size());
+					if (!in_note.empty())
+					{
+						std::memcpy(message + in_errorMessage.size(), in_note.data(), in_note.size());
+					}
+					m_errorMessage = message;
+				}
+				else
+				{
+					m_errorMessage = in_errorMessage.data();
+				}
+			}
+
+			const char* m_errorMessage;
+			const char* const m_messageTemplate;
+			const std::size_t m_errorMessageLength;
+			const bool m_ownsMessage;
+		};
+
+		/// The error node created for failures with more than one cause and a deferred
+		/// message. As with DeferredErrorNode, the message is formatted the first time it
+		/// is requested and cached for subsequent calls.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy, typename... TArgs> class DeferredErrorTreeNode final : public ErrorTreeNodeBase<DeferredErrorTreeNode<TError, TErrorSuccess, TPolicy, TArgs...>, TError, TErrorSuccess, TPolicy>
+		{
+			using Base = ErrorTreeNodeBase<DeferredErrorTreeNode<TError, TErrorSuccess, TPolicy, TArgs...>, TError, TErrorSuccess, TPolicy>;
+
+		public:
+			/// @param in_error - The error that occurred.
+			/// @param in_errorMessage - A description of the error that occurred.
+			/// @param in_causes - The causes. There must be at least two.
+			/// @param in_causeCount - The number of causes.
+			///
+			/// @return The new node. If the allocator of the policy fails, formatting the
+			/// message later would most likely fail too, so the node is instead created
+			/// from the emergency reserve with the format template as a static message.
+			///
+			static ErrorNodePtr create(TError in_error, DeferredMessage<TArgs...>&& in_errorMessage, const ErrorNodePtr* in_causes, std::size_t in_causeCount) noexcept
+			{
+				assert(in_causeCount > 1);
+
+				auto entryCount = Base::countEntries(in_causes, in_causeCount);
+				auto memory = allocateNodeMemory<TPolicy>(sizeof(DeferredErrorTreeNode) + entryCount * sizeof(ErrorTreeEntry));
+				if (!memory)
+				{
+					auto format = in_errorMessage.getFormat();
+					return ErrorTreeNode<TError, TErrorSuccess, TPolicy>::createReserved(in_error, format, format, in_causes, in_causeCount);
+				}
+
+				return ErrorNodePtr(new (memory) DeferredErrorTreeNode(in_error, std::move(in_errorMessage), in_causes, in_causeCount, entryCount));
+			}
+
+			//-----------------------------------------------------------------------------
+			static std::string_view readErrorMessage(const ErrorNode& in_node) noexcept
+			{
+				auto& node = static_cast<const DeferredErrorTreeNode&>(in_node);
+				std::call_once(node.m_formatFlag, [&node]()
+				{
+					node.m_errorMessage = node.m_deferredMessage.format();
+#ifdef IC_RESULT_ENABLE_TELEMETRY
+					recordMessageTelemetry(node.getError(), node.m_errorMessage.capacity());
+#endif
+				});
+
+				return node.m_errorMessage;
+			}
+
+			//-----------------------------------------------------------------------------
+			static const char* readMessageTemplate(const ErrorNode& in_node) noexcept
+			{
+				return static_cast<const DeferredErrorTreeNode&>(in_node).m_deferredMessage.getFormat();
+			}
+
+			//-----------------------------------------------------------------------------
+			std::size_t getAllocationSize() const noexcept
+			{
+				return this->getTreeAllocationSize();
+			}
+
+		private:
+			//-----------------------------------------------------------------------------
+			DeferredErrorTreeNode(TError in_error, DeferredMessage<TArgs...>&& in_errorMessage, const ErrorNodePtr* in_causes, std::size_t in_causeCount, std::uint32_t in_entryCount) noexcept
+				: Base(in_error, in_causes, in_causeCount, in_entryCount), m_deferredMessage(std::move(in_errorMessage))
+			{
+			}
+
+			const DeferredMessage<TArgs...> m_deferredMessage;
+			mutable std::once_flag m_formatFlag;
+			mutable std::string m_errorMessage;
+		};
+
+		/// Creates the node for a failure with the given causes. A failure with a single
+		/// cause, or none, is given the usual node.
+		///
+		/// @param in_error - The error that occurred.
+		/// @param in_errorMessage - A description of the error that occurred.
+		/// @param in_causes - The causes.
+		/// @param in_causeCount - The number of causes.
+		///
+		/// @return The new node.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy> ErrorNodePtr makeErrorTreeNode(TError in_error, std::string_view in_errorMessage, const ErrorNodePtr* in_causes, std::size_t in_causeCount) noexcept
+		{
+			if (in_causeCount > 1)
+			{
+				return ErrorTreeNode<TError, TErrorSuccess, TPolicy>::create(in_error, in_errorMessage, nullptr, true, in_causes, in_causeCount);
+			}
+
+			return makeErrorNode<TError, TErrorSuccess, TPolicy>(in_error, in_errorMessage, in_causeCount > 0 ? in_causes[0] : ErrorNodePtr());
+		}
+
+		/// Creates the node for a failure with the given causes and a static message. See
+		/// the std::string_view overload.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy> ErrorNodePtr makeErrorTreeNode(TError in_error, StaticMessage in_errorMessage, const ErrorNodePtr* in_causes, std::size_t in_causeCount) noexcept
+		{
+			if (in_causeCount > 1)
+			{
+				auto errorMessage = resolveStaticMessage(in_error, in_errorMessage.get());
+				return ErrorTreeNode<TError, TErrorSuccess, TPolicy>::create(in_error, errorMessage, errorMessage, false, in_causes, in_causeCount);
+			}
+
+			return makeErrorNode<TError, TErrorSuccess, TPolicy>(in_error, in_errorMessage, in_causeCount > 0 ? in_causes[0] : ErrorNodePtr());
+		}
+
+		/// Creates the node for a failure with the given causes and a deferred message,
+		/// which is formatted when it's first read. See the std::string_view overload.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy, typename... TArgs> ErrorNodePtr makeErrorTreeNode(TError in_error, DeferredMessage<TArgs...>&& in_errorMessage, const ErrorNodePtr* in_causes, std::size_t in_causeCount) noexcept
+		{
+			if (in_causeCount > 1)
+			{
+				return DeferredErrorTreeNode<TError, TErrorSuccess, TPolicy, TArgs...>::create(in_error, std::move(in_errorMessage), in_causes, in_causeCount);
+			}
+
+			return makeErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage), in_causeCount > 0 ? in_causes[0] : ErrorNodePtr());
+		}
+	}
+}
+
+#endif
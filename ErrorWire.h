@@ -0,0 +1,589 @@
+// ErrorWire.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_ERRORWIRE_H_
+#define _IC_ERRORWIRE_H_
+
+#include "Result.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace IC
+{
+	/// The errors which can occur when reading an error chain in the wire format.
+	///
+	enum class ErrorWireError
+	{
+		k_success,
+		k_truncated,
+		k_invalidHeader,
+		k_unsupportedVersion,
+		k_malformed
+	};
+
+	/// The error type given to received errors whose type doesn't match the error type
+	/// of the result they're converted to. See ErrorWireView::toResult(). The values are
+	/// the original error codes.
+	///
+	enum class ReceivedError : std::int64_t
+	{
+		k_success = std::numeric_limits<std::int64_t>::min()
+	};
+
+	namespace Detail
+	{
+		constexpr std::uint32_t k_errorWireMagic = 0x52454349;
+		constexpr std::uint16_t k_errorWireVersion = 1;
+
+		/// The header at the start of an error chain in the wire format. Every field is
+		/// written in the byte order of the writer; a reader with a different byte order
+		/// will fail to match the magic number.
+		///
+		struct ErrorWireHeader final
+		{
+			std::uint32_t m_magic;
+			std::uint16_t m_version;
+			std::uint16_t m_reserved;
+			std::uint32_t m_size;
+			std::uint32_t m_nodeCount;
+		};
+
+		/// The record for each error in the chain, in pre-order from the first error, so
+		/// each error is followed by its causes and then their own causes in turn. A chain
+		/// of single causes is therefore in order from the first error to the last cause.
+		/// Each is directly followed by its message and then, if it's the first error of
+		/// its type in the chain, the name of the type. Later errors of the same type refer
+		/// back to the first name. Offsets are from the start of the header.
+		///
+		struct ErrorWireNode final
+		{
+			std::int64_t m_errorCode;
+			std::uint32_t m_typeOffset;
+			std::uint32_t m_typeLength;
+			std::uint32_t m_messageLength;
+			std::uint32_t m_causeCount;
+		};
+
+		/// Writes an error chain to a buffer in the wire format in a single pass. The header
+		/// is written first, and the node count and size are filled in by finish().
+		///
+		class ErrorWireWriter final
+		{
+		public:
+			/// @param io_buffer - The buffer to append to.
+			///
+			explicit ErrorWireWriter(std::vector<unsigned char>& io_buffer) noexcept
+				: m_buffer(io_buffer), m_start(io_buffer.size())
+			{
+				ErrorWireHeader header = { k_errorWireMagic, k_errorWireVersion, 0, 0, 0 };
+				append(&header, sizeof(header));
+			}
+
+			ErrorWireWriter(const ErrorWireWriter&) = delete;
+			ErrorWireWriter& operator=(const ErrorWireWriter&) = delete;
+
+			/// @param in_errorType - Identifies the type of the error.
+			/// @param in_errorCode - The error value, converted to an integer.
+			/// @param in_errorMessage - The message describing the error.
+			/// @param in_causeCount - The number of errors which directly caused this one,
+			/// which must follow it.
+			///
+			void writeNode(ErrorTypeNameGetter in_errorType, std::int64_t in_errorCode, std::string_view in_errorMessage, std::size_t in_causeCount) noexcept
+			{
+				// Looking up the type name isn't free, so it's only done for new types.
+				const WrittenType* writtenType = nullptr;
+				for (std::size_t i = 0; i < m_typeCount; ++i)
+				{
+					if (m_types[i].m_errorType == in_errorType)
+					{
+						writtenType = &m_types[i];
+						break;
+					}
+				}
+
+				std::string_view typeName;
+				auto typeOffset = m_buffer.size() - m_start + sizeof(ErrorWireNode) + in_errorMessage.size();
+				auto typeLength = std::size_t(0);
+				if (writtenType)
+				{
+					typeOffset = writtenType->m_offset;
+					typeLength = writtenType->m_length;
+				}
+				else
+				{
+					typeName = in_errorType();
+					typeLength = typeName.size();
+					if (m_typeCount < k_maxTypes)
+					{
+						m_types[m_typeCount++] = { in_errorType, static_cast<std::uint32_t>(typeOffset), static_cast<std::uint32_t>(typeLength) };
+					}
+				}
+
+				ErrorWireNode node = { in_errorCode, static_cast<std::uint32_t>(typeOffset), static_cast<std::uint32_t>(typeLength), static_cast<std::uint32_t>(in_errorMessage.size()), static_cast<std::uint32_t>(in_causeCount) };
+				append(&node, sizeof(node));
+				append(in_errorMessage.data(), in_errorMessage.size());
+				if (!writtenType)
+				{
+					append(typeName.data(), typeName.size());
+				}
+
+				++m_nodeCount;
+			}
+
+			/// Fills in the header. No more nodes may be written afterwards.
+			///
+			void finish() noexcept
+			{
+				ErrorWireHeader header = { k_errorWireMagic, k_errorWireVersion, 0, static_cast<std::uint32_t>(m_buffer.size() - m_start), m_nodeCount };
+				std::memcpy(m_buffer.data() + m_start, &header, sizeof(header));
+			}
+
+		private:
+			static constexpr std::size_t k_maxTypes = 8;
+
+			struct WrittenType final
+			{
+				ErrorTypeNameGetter m_errorType;
+				std::uint32_t m_offset;
+				std::uint32_t m_length;
+			};
+
+			//-----------------------------------------------------------------------------
+			void append(const void* in_data, std::size_t in_size) noexcept
+			{
+				auto bytes = static_cast<const unsigned char*>(in_data);
+				m_buffer.insert(m_buffer.end(), bytes, bytes + in_size);
+			}
+
+			std::vector<unsigned char>& m_buffer;
+			const std::size_t m_start;
+			std::uint32_t m_nodeCount = 0;
+			std::size_t m_typeCount = 0;
+			WrittenType m_types[k_maxTypes];
+		};
+	}
+
+	/// Appends a failed result and its whole cause chain to the buffer in a compact
+	/// binary wire format, so that it can be passed to another process, for example
+	/// through shared memory or a pipe. The error values, error type names, messages and
+	/// the structure of the chain, including errors with several causes, are all written
+	/// in a single pass, into one contiguous block. The buffer isn't cleared first, so
+	/// reusing a buffer avoids allocating.
+	///
+	/// Use ErrorWireView to read the chain. It must be read by a process with the same
+	/// byte order.
+	///
+	/// @param in_failure - The failed result.
+	/// @param io_buffer - The buffer to append to.
+	///
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> void writeErrorWire(const Result<TValue, TError, TErrorSuccess, TPolicy>& in_failure, std::vector<unsigned char>& io_buffer) noexcept
+	{
+		assert(!in_failure.wasSuccessful());
+
+		Detail::ErrorWireWriter writer(io_buffer);
+		writer.writeNode(&Detail::getErrorTypeName<TError>, static_cast<std::int64_t>(in_failure.getError()), in_failure.getErrorMessage(), in_failure.getCauses().getSize());
+		for (auto& cause : in_failure.getCauses())
+		{
+			for (auto entry : cause.getErrorTree())
+			{
+				writer.writeNode(entry.m_node->getDescriptor().m_getErrorType, entry.m_node->getErrorCode(), entry.m_node->getErrorMessage(), entry.m_node->getCauses().getSize());
+			}
+		}
+		writer.finish();
+	}
+
+	/// Appends an error node and its whole cause chain to the buffer in the wire format.
+	/// See writeErrorWire() for results.
+	///
+	/// @param in_error - The error node.
+	/// @param io_buffer - The buffer to append to.
+	///
+	inline void writeErrorWire(const ErrorNode& in_error, std::vector<unsigned char>& io_buffer) noexcept
+	{
+		Detail::ErrorWireWriter writer(io_buffer);
+		for (auto entry : in_error.getErrorTree())
+		{
+			writer.writeNode(entry.m_node->getDescriptor().m_getErrorType, entry.m_node->getErrorCode(), entry.m_node->getErrorMessage(), entry.m_node->getCauses().getSize());
+		}
+		writer.finish();
+	}
+
+	/// A view of a single error in a chain written by writeErrorWire(), which reads
+	/// directly from the buffer. Walking the chain and reading messages makes no
+	/// allocation or copy, so the buffer must outlive the view. When ownership of the
+	/// error is needed, it can be converted to a Result with toResult().
+	///
+	///     auto view = IC::ErrorWireView::read(buffer.data(), buffer.size());
+	///     for (auto error = std::optional<IC::ErrorWireView>(view.getValue()); error; error = error->getCausedBy())
+	///     {
+	///         log(error->getErrorType(), error->getErrorCode(), error->getErrorMessage());
+	///     }
+	///
+	/// getCausedBy() returns the first cause of an error with several, and the others
+	/// can be read with getCause().
+	///
+	class ErrorWireView final
+	{
+	public:
+		/// The size of the header at the start of a chain, which is enough to read its
+		/// total size with readSize().
+		///
+		static constexpr std::size_t k_headerSize = sizeof(Detail::ErrorWireHeader);
+
+		/// Reads the total size of a chain from its header, so that the rest of it can be
+		/// read from a stream.
+		///
+		/// @param in_data - The start of the chain.
+		/// @param in_size - The number of bytes available, which must be at least
+		/// k_headerSize.
+		///
+		/// @return The total size of the chain, including the header.
+		///
+		static Result<std::size_t, ErrorWireError> readSize(const void* in_data, std::size_t in_size) noexcept
+		{
+			if (in_size < k_headerSize)
+			{
+				return Result<std::size_t, ErrorWireError>(ErrorWireError::k_truncated, StaticMessage("The error chain header is truncated."));
+			}
+
+			Detail::ErrorWireHeader header;
+			std::memcpy(&header, in_data, sizeof(header));
+			if (header.m_magic != Detail::k_errorWireMagic)
+			{
+				return Result<std::size_t, ErrorWireError>(ErrorWireError::k_invalidHeader, StaticMessage("The data isn't an error chain, or was written with a different byte order."));
+			}
+			if (header.m_version != Detail::k_errorWireVersion)
+			{
+				return Result<std::size_t, ErrorWireError>(ErrorWireError::k_unsupportedVersion, StaticMessage("The error chain was written with an unsupported version."));
+			}
+			if (header.m_size < k_headerSize)
+			{
+				return Result<std::size_t, ErrorWireError>(ErrorWireError::k_invalidHeader, StaticMessage("The error chain header has an invalid size."));
+			}
+
+			return Result<std::size_t, ErrorWireError>(std::size_t(header.m_size));
+		}
+
+		/// Validates a chain, and returns a view of the first error in it. Every record is
+		/// bounds checked, so this is safe to use on data received from another process.
+		///
+		/// @param in_data - The start of the chain.
+		/// @param in_size - The number of bytes available.
+		///
+		/// @return A view of the first error in the chain.
+		///
+		static Result<ErrorWireView, ErrorWireError> read(const void* in_data, std::size_t in_size) noexcept
+		{
+			auto size = readSize(in_data, in_size);
+			if (!size)
+			{
+				return Result<ErrorWireView, ErrorWireError>(size);
+			}
+			if (size.getValue() > in_size)
+			{
+				return Result<ErrorWireView, ErrorWireError>(ErrorWireError::k_truncated, StaticMessage("The error chain is truncated."));
+			}
+
+			auto data = static_cast<const unsigned char*>(in_data);
+			Detail::ErrorWireHeader header;
+			std::memcpy(&header, data, sizeof(header));
+
+			// Each record is one of the errors still expected, and adds its causes to them.
+			// A valid tree expects exactly as many records as there are.
+			std::size_t offset = k_headerSize;
+			std::uint64_t expected = 1;
+			for (std::uint32_t i = 0; i < header.m_nodeCount; ++i)
+			{
+				if (header.m_size - offset < sizeof(Detail::ErrorWireNode))
+				{
+					return Result<ErrorWireView, ErrorWireError>(ErrorWireError::k_malformed, StaticMessage("An error record is out of bounds."));
+				}
+
+				Detail::ErrorWireNode node;
+				std::memcpy(&node, data + offset, sizeof(node));
+				auto messageOffset = offset + sizeof(node);
+				if (node.m_messageLength > header.m_size - messageOffset || node.m_typeOffset > header.m_size || node.m_typeLength > header.m_size - node.m_typeOffset || expected == 0)
+				{
+					return Result<ErrorWireView, ErrorWireError>(ErrorWireError::k_malformed, StaticMessage("An error record is malformed."));
+				}
+
+				expected = expected - 1 + node.m_causeCount;
+				offset = getNextOffset(offset, node);
+			}
+
+			if (header.m_nodeCount == 0 || offset != header.m_size || expected != 0)
+			{
+				return Result<ErrorWireView, ErrorWireError>(ErrorWireError::k_malformed, StaticMessage("The error chain is malformed."));
+			}
+
+			return Result<ErrorWireView, ErrorWireError>(ErrorWireView(data, k_headerSize));
+		}
+
+		/// @return The error value, converted to an integer.
+		///
+		std::int64_t getErrorCode() const noexcept
+		{
+			return getNode().m_errorCode;
+		}
+
+		/// @return The name of the error type, as reported by the compiler of the writer.
+		///
+		std::string_view getErrorType() const noexcept
+		{
+			auto node = getNode();
+			return std::string_view(reinterpret_cast<const char*>(m_data + node.m_typeOffset), node.m_typeLength);
+		}
+
+		/// @return The message describing the error.
+		///
+		std::string_view getErrorMessage() const noexcept
+		{
+			auto node = getNode();
+			return std::string_view(reinterpret_cast<const char*>(m_data + m_offset + sizeof(Detail::ErrorWireNode)), node.m_messageLength);
+		}
+
+		/// @return The error which caused this one, or the first of them if there were
+		/// several, if any.
+		///
+		std::optional<ErrorWireView> getCausedBy() const noexcept
+		{
+			auto node = getNode();
+			if (node.m_causeCount == 0)
+			{
+				return std::nullopt;
+			}
+
+			return ErrorWireView(m_data, getNextOffset(m_offset, node));
+		}
+
+		/// @return The number of errors which directly caused this one.
+		///
+		std::uint32_t getCauseCount() const noexcept
+		{
+			return getNode().m_causeCount;
+		}
+
+		/// Finding a cause skips over the records of every cause before it, so it takes
+		/// time proportional to their size.
+		///
+		/// @param in_index - The index of the cause, which must be less than
+		/// getCauseCount().
+		///
+		/// @return The error which directly caused this one with the given index.
+		///
+		ErrorWireView getCause(std::uint32_t in_index) const noexcept
+		{
+			assert(in_index < getCauseCount());
+
+			auto offset = getNextOffset(m_offset, getNode());
+			for (std::uint32_t i = 0; i < in_index; ++i)
+			{
+				offset = getTreeEnd(offset);
+			}
+			return ErrorWireView(m_data, offset);
+		}
+
+		/// @return A message describing this error and any errors which caused this error
+		/// to occur. See writeFullErrorMessage().
+		///
+		std::string getFullErrorMessage() const noexcept
+		{
+			std::string errorMessage;
+			StringErrorSink sink(errorMessage);
+			writeFullErrorMessage(sink);
+			return errorMessage;
+		}
+
+		/// Writes a message describing this error and any errors which caused this error
+		/// to occur into the given sink, in the same form as Result::writeFullErrorMessage()
+		/// with ErrorMessageFormat::k_chain.
+		///
+		/// @param io_sink - The sink to write to.
+		///
+		template <typename TSink> void writeFullErrorMessage(TSink& io_sink) const noexcept
+		{
+			auto end = getTreeEnd(m_offset);
+			auto length = getErrorMessage().size();
+			for (auto offset = getNextOffset(m_offset, getNode()); offset != end; offset = getNextOffset(offset, getNode(offset)))
+			{
+				length += Detail::k_causedBySeparator.size() + ErrorWireView(m_data, offset).getErrorMessage().size();
+			}
+
+			io_sink.reserve(length);
+			io_sink.append(getErrorMessage());
+			for (auto offset = getNextOffset(m_offset, getNode()); offset != end; offset = getNextOffset(offset, getNode(offset)))
+			{
+				io_sink.append(Detail::k_causedBySeparator);
+				io_sink.append(ErrorWireView(m_data, offset).getErrorMessage());
+			}
+		}
+
+		/// Copies the error and its causes into a Result which owns them. The first error
+		/// takes the error type of the Result. Each cause with the same error type name
+		/// also takes TError; as the receiver may not have the types of the other causes,
+		/// they use ReceivedError instead. Errors with several causes keep all of them.
+		///
+		/// As read() doesn't know the error types, it can't check that no error has the
+		/// success value of the type it's given here, so this is checked instead.
+		///
+		/// @return A failed result describing the chain, or a failure if an error has the
+		/// success value of its type.
+		///
+		template <typename TError, TError TErrorSuccess = TError(), typename TPolicy = DefaultResultPolicy> Result<Result<void, TError, TErrorSuccess, TPolicy>, ErrorWireError> toResult() const noexcept
+		{
+			using Received = Result<void, TError, TErrorSuccess, TPolicy>;
+
+			auto isSuccess = [](const ErrorWireView& in_error, bool in_isTError) noexcept
+			{
+				if (in_isTError)
+				{
+					return static_cast<TError>(in_error.getErrorCode()) == TErrorSuccess;
+				}
+				return static_cast<ReceivedError>(in_error.getErrorCode()) == ReceivedError::k_success;
+			};
+
+			if (isSuccess(*this, true))
+			{
+				return Result<Received, ErrorWireError>(ErrorWireError::k_malformed, StaticMessage("An error record has the success value of its error type."));
+			}
+
+			std::vector<std::size_t> offsets;
+			auto end = getTreeEnd(m_offset);
+			for (auto offset = getNextOffset(m_offset, getNode()); offset != end; offset = getNextOffset(offset, getNode(offset)))
+			{
+				ErrorWireView cause(m_data, offset);
+				if (isSuccess(cause, cause.getErrorType() == Detail::getErrorTypeName<TError>()))
+				{
+					return Result<Received, ErrorWireError>(ErrorWireError::k_malformed, StaticMessage("An error record has the success value of its error type."));
+				}
+				offsets.push_back(offset);
+			}
+
+			// Building the errors in reverse pre-order means each error's causes have
+			// already been built, and are on top of the stack with the first cause last.
+			std::vector<ErrorNodePtr> built;
+			auto takeCauses = [&built](std::uint32_t in_causeCount)
+			{
+				std::reverse(built.end() - in_causeCount, built.end());
+				return built.data() + built.size() - in_causeCount;
+			};
+
+			for (auto offset = offsets.rbegin(); offset != offsets.rend(); ++offset)
+			{
+				ErrorWireView cause(m_data, *offset);
+				auto causeCount = cause.getCauseCount();
+				auto causes = takeCauses(causeCount);
+
+				ErrorNodePtr node;
+				if (cause.getErrorType() == Detail::getErrorTypeName<TError>())
+				{
+					node = Detail::makeErrorTreeNode<TError, TErrorSuccess, TPolicy>(static_cast<TError>(cause.getErrorCode()), cause.getErrorMessage(), causes, causeCount);
+				}
+				else
+				{
+					node = Detail::makeErrorTreeNode<ReceivedError, ReceivedError::k_success, TPolicy>(static_cast<ReceivedError>(cause.getErrorCode()), cause.getErrorMessage(), causes, causeCount);
+				}
+
+				built.resize(built.size() - causeCount);
+				built.push_back(std::move(node));
+			}
+
+			auto error = static_cast<TError>(getErrorCode());
+			if (built.empty())
+			{
+				return Result<Received, ErrorWireError>(Received(error, getErrorMessage()));
+			}
+
+			ErrorCauses causes;
+			causes.reserve(built.size());
+			for (auto cause = built.rbegin(); cause != built.rend(); ++cause)
+			{
+				causes.add(std::move(*cause));
+			}
+			return Result<Received, ErrorWireError>(Received(error, getErrorMessage(), causes));
+		}
+
+	private:
+		//-----------------------------------------------------------------------------
+		ErrorWireView(const unsigned char* in_data, std::size_t in_offset) noexcept
+			: m_data(in_data), m_offset(in_offset)
+		{
+		}
+
+		/// @param in_offset - The offset of a record.
+		/// @param in_node - The record.
+		///
+		/// @return The offset of the record which follows it.
+		///
+		static std::size_t getNextOffset(std::size_t in_offset, const Detail::ErrorWireNode& in_node) noexcept
+		{
+			auto next = in_offset + sizeof(Detail::ErrorWireNode) + in_node.m_messageLength;
+			return in_node.m_typeOffset == next ? next + in_node.m_typeLength : next;
+		}
+
+		/// @param in_offset - The offset of a record.
+		///
+		/// @return The offset of the first record after the record and all of its causes.
+		///
+		std::size_t getTreeEnd(std::size_t in_offset) const noexcept
+		{
+			std::uint64_t expected = 1;
+			while (expected > 0)
+			{
+				auto node = getNode(in_offset);
+				expected = expected - 1 + node.m_causeCount;
+				in_offset = getNextOffset(in_offset, node);
+			}
+			return in_offset;
+		}
+
+		//-----------------------------------------------------------------------------
+		Detail::ErrorWireNode getNode(std::size_t in_offset) const noexcept
+		{
+			Detail::ErrorWireNode node;
+			std::memcpy(&node, m_data + in_offset, sizeof(node));
+			return node;
+		}
+
+		//-----------------------------------------------------------------------------
+		Detail::ErrorWireNode getNode() const noexcept
+		{
+			return getNode(m_offset);
+		}
+
+		const unsigned char* m_data;
+		std::size_t m_offset;
+	};
+}
+
+#endif
@@ -0,0 +1,261 @@
+// LeanResult.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_LEANRESULT_H_
+#define _IC_LEANRESULT_H_
+
+#include "Result.h"
+
+#include <assert.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace IC
+{
+	namespace Detail
+	{
+		/// The storage for a LeanResult. This is specialised on whether TValue is trivially
+		/// copyable and destructible, so that the LeanResult is too. The value is stored
+		/// before the error to match the layout of std::pair<TValue, TError>.
+		///
+		template <typename TValue, typename TError, TError TErrorSuccess, bool TTrivial = std::is_trivially_copyable<TValue>::value && std::is_trivially_destructible<TValue>::value> class LeanResultStorage
+		{
+		public:
+			//-----------------------------------------------------------------------------
+			constexpr LeanResultStorage(const TValue& in_value) noexcept(std::is_nothrow_copy_constructible<TValue>::value)
+				: m_value(in_value), m_error(TErrorSuccess)
+			{
+			}
+
+			//-----------------------------------------------------------------------------
+			constexpr explicit LeanResultStorage(TError in_error) noexcept
+				: m_empty(), m_error(in_error)
+			{
+			}
+
+		protected:
+			union
+			{
+				char m_empty;
+				TValue m_value;
+			};
+			TError m_error;
+		};
+
+		//-----------------------------------------------------------------------------
+		template <typename TValue, typename TError, TError TErrorSuccess> class LeanResultStorage<TValue, TError, TErrorSuccess, false>
+		{
+		public:
+			//-----------------------------------------------------------------------------
+			LeanResultStorage(const TValue& in_value) noexcept(std::is_nothrow_copy_constructible<TValue>::value)
+				: m_value(in_value), m_error(TErrorSuccess)
+			{
+			}
+
+			//-----------------------------------------------------------------------------
+			LeanResultStorage(TValue&& in_value) noexcept(std::is_nothrow_move_constructible<TValue>::value)
+				: m_value(std::move(in_value)), m_error(TErrorSuccess)
+			{
+			}
+
+			//-----------------------------------------------------------------------------
+			explicit LeanResultStorage(TError in_error) noexcept
+				: m_empty(), m_error(in_error)
+			{
+			}
+
+			//-----------------------------------------------------------------------------
+			LeanResultStorage(const LeanResultStorage& in_toCopy) noexcept(std::is_nothrow_copy_constructible<TValue>::value)
+				: m_empty(), m_error(in_toCopy.m_error)
+			{
+				if (m_error == TErrorSuccess)
+				{
+					new (&m_value) TValue(in_toCopy.m_value);
+				}
+			}
+
+			//-----------------------------------------------------------------------------
+			LeanResultStorage(LeanResultStorage&& in_toMove) noexcept(std::is_nothrow_move_constructible<TValue>::value)
+				: m_empty(), m_error(in_toMove.m_error)
+			{
+				if (m_error == TErrorSuccess)
+				{
+					new (&m_value) TValue(std::move(in_toMove.m_value));
+				}
+			}
+
+			//-----------------------------------------------------------------------------
+			LeanResultStorage& operator=(const LeanResultStorage& in_toCopy) noexcept(std::is_nothrow_copy_constructible<TValue>::value)
+			{
+				if (this != &in_toCopy)
+				{
+					destroy();
+
+					m_error = in_toCopy.m_error;
+					if (m_error == TErrorSuccess)
+					{
+						new (&m_value) TValue(in_toCopy.m_value);
+					}
+				}
+
+				return *this;
+			}
+
+			//-----------------------------------------------------------------------------
+			LeanResultStorage& operator=(LeanResultStorage&& in_toMove) noexcept(std::is_nothrow_move_constructible<TValue>::value)
+			{
+				if (this != &in_toMove)
+				{
+					destroy();
+
+					m_error = in_toMove.m_error;
+					if (m_error == TErrorSuccess)
+					{
+						new (&m_value) TValue(std::move(in_toMove.m_value));
+					}
+				}
+
+				return *this;
+			}
+
+			//-----------------------------------------------------------------------------
+			~LeanResultStorage() noexcept
+			{
+				destroy();
+			}
+
+		protected:
+			//-----------------------------------------------------------------------------
+			void destroy() noexcept
+			{
+				if (m_error == TErrorSuccess)
+				{
+					m_value.~TValue();
+				}
+			}
+
+			union
+			{
+				char m_empty;
+				TValue m_value;
+			};
+			TError m_error;
+		};
+	}
+
+	/// A minimal alternative to Result for the tightest inner loops, such as parsers and
+	/// decoders, which hold only the value or the error: there is no message, no cause
+	/// and no virtual interface. When TValue and TError are trivially copyable and
+	/// destructible, so is the LeanResult, which allows it to be returned in registers
+	/// in the same way as a std::pair<TValue, TError>. It can also be used in constant
+	/// expressions.
+	///
+	///     IC::LeanResult<std::uint32_t, ParseError> tryParseDigit(char in_char);
+	///
+	/// Where context is needed further up, a LeanResult converts to the equivalent
+	/// Result, which can then be used as the cause of a more descriptive error:
+	///
+	///     IC::Result<std::uint32_t, ParseError> digit = tryParseDigit(c);
+	///     if (!digit)
+	///     {
+	///         return IC::BoolResult<Header>(false, "Could not parse the header.", digit);
+	///     }
+	///
+	/// When converted, the message of a failure is looked up in the ErrorCatalog for
+	/// TError if there is one, otherwise it is empty.
+	///
+	template <typename TValue, typename TError, TError TErrorSuccess = TError()> class LeanResult final : public Detail::LeanResultStorage<TValue, TError, TErrorSuccess>
+	{
+	public:
+		/// Creates a successful result with the given value, or a failed result with the
+		/// given error.
+		///
+		using Detail::LeanResultStorage<TValue, TError, TErrorSuccess>::LeanResultStorage;
+
+		/// Allows the result to be treated as a bool, for example:
+		///
+		///     if (result) {...}
+		///
+		/// @return Whether or not the result was successful.
+		///
+		constexpr explicit operator bool() const noexcept
+		{
+			return wasSuccessful();
+		}
+
+		/// @return Whether or not the result was successful. This must be checked prior to
+		/// getting the value.
+		///
+		constexpr bool wasSuccessful() const noexcept
+		{
+			return this->m_error == TErrorSuccess;
+		}
+
+		/// Before calling this wasSuccessful() should be checked to ensure the result was
+		/// successful therefore has a value.
+		///
+		/// @return The value.
+		///
+		constexpr const TValue& getValue() const noexcept
+		{
+			assert(wasSuccessful());
+
+			return this->m_value;
+		}
+
+		/// @return The error that occurred. If no error occurred this will return
+		/// TErrorSuccess.
+		///
+		constexpr TError getError() const noexcept
+		{
+			return this->m_error;
+		}
+
+		/// @return The equivalent Result, with any policy.
+		///
+		template <typename TPolicy> operator Result<TValue, TError, TErrorSuccess, TPolicy>() const
+		{
+			if (wasSuccessful())
+			{
+				return Result<TValue, TError, TErrorSuccess, TPolicy>(this->m_value);
+			}
+
+			if constexpr (HasErrorCatalog<TError>::value)
+			{
+				return Result<TValue, TError, TErrorSuccess, TPolicy>(this->m_error);
+			}
+			else
+			{
+				return Result<TValue, TError, TErrorSuccess, TPolicy>(this->m_error, StaticMessage(""));
+			}
+		}
+	};
+
+	/// A convenience typedef for lean results which use a boolean error value.
+	///
+	template <typename TValue> using LeanBoolResult = LeanResult<TValue, bool, true>;
+}
+
+#endif
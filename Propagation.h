@@ -0,0 +1,393 @@
+// Propagation.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_PROPAGATION_H_
+#define _IC_PROPAGATION_H_
+
+#include "Result.h"
+
+#include <assert.h>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define IC_RESULT_HAS_COROUTINES 1
+#endif
+
+#define IC_RESULT_CONCAT_IMPL(in_a, in_b) in_a##in_b
+#define IC_RESULT_CONCAT(in_a, in_b) IC_RESULT_CONCAT_IMPL(in_a, in_b)
+
+/// Evaluates an expression which returns a Result. If it failed, the failure is
+/// returned from the enclosing function unchanged, without being wrapped, so nothing is
+/// allocated and the cause chain isn't copied. The enclosing function must return a
+/// Result with the same error type and policy, but the value type may differ:
+///
+///     IC_TRY(tryOpen(path));
+///
+#define IC_TRY(in_expression) \
+	do \
+	{ \
+		auto icTryResult = (in_expression); \
+		if (!icTryResult) \
+		{ \
+			return IC::forwardFailure(std::move(icTryResult)); \
+		} \
+	} while (false)
+
+/// As IC_TRY(), but if the expression succeeded its value is assigned to the given
+/// declaration, which is declared in the enclosing scope:
+///
+///     IC_TRY_ASSIGN(auto header, tryReadHeader(file));
+///
+#define IC_TRY_ASSIGN(in_declaration, in_expression) \
+	auto IC_RESULT_CONCAT(icTryResult, __LINE__) = (in_expression); \
+	if (!IC_RESULT_CONCAT(icTryResult, __LINE__)) \
+	{ \
+		return IC::forwardFailure(std::move(IC_RESULT_CONCAT(icTryResult, __LINE__))); \
+	} \
+	in_declaration = std::move(IC_RESULT_CONCAT(icTryResult, __LINE__)).getValue()
+
+#if defined(__GNUC__) || defined(__clang__)
+
+/// As IC_TRY(), but evaluates to the value if the expression succeeded, so it can be
+/// used within an expression. This uses statement expressions, so is only available
+/// with GCC and Clang. The value is always returned by value; use IC_TRY_ASSIGN() for
+/// results which refer to a value.
+///
+///     auto size = IC_TRY_VALUE(tryReadHeader(file)).m_size;
+///
+#define IC_TRY_VALUE(in_expression) \
+	(__extension__ ({ \
+		auto icTryResult = (in_expression); \
+		if (!icTryResult) \
+		{ \
+			return IC::forwardFailure(std::move(icTryResult)); \
+		} \
+		std::move(icTryResult).getValue(); \
+	}))
+
+#endif
+
+namespace IC
+{
+	namespace Detail
+	{
+		/// Returned by forwardFailure(). Converts to a failed result with any value type,
+		/// as long as the error type and policy match, by moving the error into it.
+		///
+		template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> class ForwardedFailure final
+		{
+		public:
+			/// @param in_failure - The failed result which should be forwarded.
+			///
+			explicit ForwardedFailure(Result<TValue, TError, TErrorSuccess, TPolicy>& in_failure) noexcept
+				: m_failure(in_failure)
+			{
+			}
+
+			ForwardedFailure(const ForwardedFailure&) = delete;
+			ForwardedFailure& operator=(const ForwardedFailure&) = delete;
+
+			/// @return A failed result with the forwarded error.
+			///
+			template <typename TOtherValue> operator Result<TOtherValue, TError, TErrorSuccess, TPolicy>() && noexcept
+			{
+				return Result<TOtherValue, TError, TErrorSuccess, TPolicy>(std::move(m_failure));
+			}
+
+		private:
+			Result<TValue, TError, TErrorSuccess, TPolicy>& m_failure;
+		};
+	}
+
+	/// Passes a failure on to the caller unchanged. The returned object converts to a
+	/// failed result with any value type, so it can be returned directly:
+	///
+	///     auto header = tryReadHeader(file);
+	///     if (!header)
+	///     {
+	///         return IC::forwardFailure(std::move(header));
+	///     }
+	///
+	/// The error node is moved rather than copied or wrapped, so this makes no
+	/// allocation and doesn't touch the node's reference count. To add context instead,
+	/// wrap the failure as the cause of a new error.
+	///
+	/// @param in_failure - The failed result. This still reports the same error
+	/// afterwards, but if the error had a node its message becomes
+	/// Detail::k_movedFromMessage.
+	///
+	/// @return An object which converts to the failed result.
+	///
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Detail::ForwardedFailure<TValue, TError, TErrorSuccess, TPolicy> forwardFailure(Result<TValue, TError, TErrorSuccess, TPolicy>&& in_failure) noexcept
+	{
+		assert(!in_failure.wasSuccessful());
+
+		return Detail::ForwardedFailure<TValue, TError, TErrorSuccess, TPolicy>(in_failure);
+	}
+}
+
+#ifdef IC_RESULT_HAS_COROUTINES
+
+namespace IC
+{
+	namespace Detail
+	{
+		template <typename TResult> class ResultPromise;
+
+		/// The object returned by the promise of a coroutine which returns a Result, from
+		/// which the Result is then constructed. Compilers may do this either before the
+		/// body of the coroutine runs or after it completes, so both are handled. In the
+		/// first case the promise is redirected to construct its result directly in the
+		/// returned Result. In the second the result is constructed here, then moved.
+		///
+		template <typename TResult> class ResultCoroutineReturn final
+		{
+		public:
+			/// @param io_promise - The promise of the coroutine.
+			///
+			explicit ResultCoroutineReturn(ResultPromise<TResult>& io_promise) noexcept
+				: m_promise(&io_promise)
+			{
+				io_promise.m_result = reinterpret_cast<TResult*>(m_storage);
+				io_promise.m_return = this;
+			}
+
+			ResultCoroutineReturn(const ResultCoroutineReturn&) = delete;
+			ResultCoroutineReturn& operator=(const ResultCoroutineReturn&) = delete;
+
+			/// @return Whether the coroutine has completed, and its result is held here.
+			///
+			bool isComplete() const noexcept
+			{
+				return m_isComplete;
+			}
+
+			/// This should only be called if the coroutine has completed.
+			///
+			/// @return The result of the coroutine.
+			///
+			TResult& getResult() noexcept
+			{
+				assert(m_isComplete);
+
+				return *std::launder(reinterpret_cast<TResult*>(m_storage));
+			}
+
+			/// Redirects the promise to construct its result in the given storage when the
+			/// coroutine completes. This should only be called if it hasn't completed yet.
+			///
+			/// @param out_result - The uninitialised result.
+			///
+			void redirect(TResult* out_result) noexcept
+			{
+				assert(!m_isComplete);
+
+				m_promise->m_result = out_result;
+				m_promise->m_return = nullptr;
+			}
+
+			//-----------------------------------------------------------------------------
+			~ResultCoroutineReturn() noexcept
+			{
+				if (m_isComplete)
+				{
+					getResult().~TResult();
+				}
+			}
+
+		private:
+			friend class ResultPromise<TResult>;
+
+			ResultPromise<TResult>* m_promise;
+			bool m_isComplete = false;
+			alignas(TResult) unsigned char m_storage[sizeof(TResult)];
+		};
+
+		/// Awaits a result within a coroutine which returns a Result. If the awaited result
+		/// succeeded, the coroutine continues with its value. Otherwise the failure is moved
+		/// into the result of the coroutine, which is then destroyed without resuming.
+		///
+		template <typename TAwaited, typename TResult> class ResultAwaiter final
+		{
+		public:
+			/// @param in_awaited - The result being awaited.
+			///
+			explicit ResultAwaiter(TAwaited&& in_awaited) noexcept
+				: m_awaited(std::move(in_awaited))
+			{
+			}
+
+			/// @return Whether the coroutine should continue.
+			///
+			bool await_ready() const noexcept
+			{
+				return m_awaited.wasSuccessful();
+			}
+
+			/// Completes the coroutine with the failure, and destroys it. As this destroys
+			/// the awaiter, no members may be used after the coroutine is destroyed.
+			///
+			/// @param in_coroutine - The awaiting coroutine.
+			///
+			void await_suspend(std::coroutine_handle<ResultPromise<TResult>> in_coroutine) noexcept
+			{
+				in_coroutine.promise().complete(TResult(std::move(m_awaited)));
+				in_coroutine.destroy();
+			}
+
+			/// @return The value of the awaited result, if it has one.
+			///
+			decltype(auto) await_resume() noexcept
+			{
+				if constexpr (!std::is_void<decltype(std::move(m_awaited).getValue())>::value)
+				{
+					return std::move(m_awaited).getValue();
+				}
+			}
+
+		private:
+			TAwaited m_awaited;
+		};
+
+		/// The promise type of coroutines which return a Result. A Result can be awaited
+		/// with co_await as long as its error type and policy match; if it failed the
+		/// failure is returned from the coroutine unchanged, as with IC_TRY(). The
+		/// coroutine itself completes with co_return.
+		///
+		/// The coroutine never suspends, so it always completes before returning. The
+		/// frame is allocated through the Allocator of the policy so, with the default
+		/// pool allocator, the global heap isn't used once the pool is warm.
+		///
+		template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> class ResultPromise<Result<TValue, TError, TErrorSuccess, TPolicy>> final
+		{
+		public:
+			using ResultType = Result<TValue, TError, TErrorSuccess, TPolicy>;
+
+			/// Frames are too large for the emergency error reserve, so failing to allocate
+			/// one is reported as it would be by the global operator new.
+			///
+			/// @param in_size - The size of the coroutine frame.
+			///
+			/// @return Memory for the coroutine frame.
+			///
+			static void* operator new(std::size_t in_size)
+			{
+				auto memory = TPolicy::Allocator::allocate(in_size);
+				if (!memory)
+				{
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+					throw std::bad_alloc();
+#else
+					std::terminate();
+#endif
+				}
+				return memory;
+			}
+
+			/// @param in_memory - The coroutine frame.
+			/// @param in_size - The size of the coroutine frame.
+			///
+			static void operator delete(void* in_memory, std::size_t in_size) noexcept
+			{
+				TPolicy::Allocator::deallocate(in_memory, in_size);
+			}
+
+			/// @return The object the result of the coroutine is constructed from.
+			///
+			ResultCoroutineReturn<ResultType> get_return_object() noexcept
+			{
+				return ResultCoroutineReturn<ResultType>(*this);
+			}
+
+			//-----------------------------------------------------------------------------
+			std::suspend_never initial_suspend() const noexcept
+			{
+				return {};
+			}
+
+			//-----------------------------------------------------------------------------
+			std::suspend_never final_suspend() const noexcept
+			{
+				return {};
+			}
+
+			/// @param in_result - The result of the coroutine.
+			///
+			void return_value(ResultType in_result) noexcept
+			{
+				complete(std::move(in_result));
+			}
+
+			//-----------------------------------------------------------------------------
+			void unhandled_exception() const noexcept
+			{
+				std::terminate();
+			}
+
+			/// @param in_awaited - The result being awaited.
+			///
+			/// @return The awaiter for the result.
+			///
+			template <typename TOtherValue> ResultAwaiter<Result<TOtherValue, TError, TErrorSuccess, TPolicy>, ResultType> await_transform(Result<TOtherValue, TError, TErrorSuccess, TPolicy> in_awaited) noexcept
+			{
+				return ResultAwaiter<Result<TOtherValue, TError, TErrorSuccess, TPolicy>, ResultType>(std::move(in_awaited));
+			}
+
+			/// Constructs the result of the coroutine. This can only be called once.
+			///
+			/// @param in_result - The result of the coroutine.
+			///
+			void complete(ResultType&& in_result) noexcept
+			{
+				new (m_result) ResultType(std::move(in_result));
+				if (m_return)
+				{
+					m_return->m_isComplete = true;
+				}
+			}
+
+		private:
+			friend class ResultCoroutineReturn<ResultType>;
+
+			ResultType* m_result = nullptr;
+			ResultCoroutineReturn<ResultType>* m_return = nullptr;
+		};
+	}
+}
+
+/// Allows functions which return a Result to be coroutines. See ResultPromise.
+///
+template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy, typename... TArgs> struct std::coroutine_traits<IC::Result<TValue, TError, TErrorSuccess, TPolicy>, TArgs...>
+{
+	using promise_type = IC::Detail::ResultPromise<IC::Result<TValue, TError, TErrorSuccess, TPolicy>>;
+};
+
+#endif
+
+#endif
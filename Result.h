@@ -26,10 +26,24 @@
 #ifndef _IC_RESULT_H_
 #define _IC_RESULT_H_
 
-#include "IResult.h"
+#include "DeferredMessage.h"
+#include "ErrorCatalog.h"
+#include "ErrorNode.h"
+#include "ErrorPayload.h"
+#include "ErrorSink.h"
+#include "ErrorTelemetry.h"
+#include "ResultPolicy.h"
+
+#include <type_traits>
+#include <utility>
 
 namespace IC
 {
+	namespace Detail
+	{
+		template <typename TResult> class ResultCoroutineReturn;
+	}
+
 	/// A simple alternate to checked exceptions for applications where exceptions would not
 	/// be appropriate. 
 	/// 
@@ -66,47 +80,184 @@ namespace IC
 	///		Error<ErrorEnum> tryGetValue();
 	///		BoolError tryGetValue();
 	///
-	template <typename TValue, typename TError, TError TErrorSuccess = TError()> class Result final : public IResult
+	/// Internally the value and the error description share storage: a successful result
+	/// holds only the value, while a failed result holds a pointer to the error message and
+	/// cause, which are allocated out of line. As such TValue is never constructed for
+	/// failed results and does not need to be default constructible. Failures described
+	/// by a StaticMessage, or by the ErrorCatalog for TError, store only a pointer to the
+	/// message and make no allocation.
+	///
+	/// Results can also refer to a value owned elsewhere, such as an object found in a
+	/// cache, by using a reference type for TValue. Only a pointer is stored:
+	///
+	///     Result<const Texture&, ErrorEnum> tryFindTexture(const std::string& name);
+	///
+	/// The error description is an immutable, reference counted node. Copying a failed
+	/// result, or wrapping it as the cause of another, shares the node rather than cloning
+	/// the cause chain. Nodes are type erased through a static ErrorDescriptor rather than
+	/// a vtable, so results with different template parameters can be chained as causes
+	/// while Result itself has no virtual functions; checking a result is a plain inline
+	/// comparison. The reference counting, along with other implementation details,
+	/// can be configured through the policy; see DefaultResultPolicy.
+	///
+	/// As releasing the error node makes the destructor non-trivial, a Result is always
+	/// returned through memory rather than in registers. Hot paths which need a register
+	/// return should use LeanResult instead.
+	///
+	template <typename TValue, typename TError, TError TErrorSuccess = TError(), typename TPolicy = DefaultResultPolicy> class Result final
 	{
 	public:
 		/// Creates a successful result with the given value.
 		/// 
 		/// @param in_value - The output value.
 		///
-		Result(const TValue& in_value) noexcept;
+		Result(const TValue& in_value) noexcept(std::is_nothrow_copy_constructible<TValue>::value);
+
+		/// Creates a successful result, moving the given value into it.
+		///
+		/// @param in_value - The output value.
+		///
+		Result(TValue&& in_value) noexcept(std::is_nothrow_move_constructible<TValue>::value);
+
+		/// Creates a successful result, constructing the value in place from the given
+		/// arguments. This avoids even a move, and allows values which can be neither
+		/// copied nor moved to be returned:
+		///
+		///     return IC::BoolResult<std::vector<char>>(std::in_place, size, '\0');
+		///
+		/// @param in_args - The arguments passed to the constructor of TValue.
+		///
+		template <typename... TArgs> explicit Result(std::in_place_t, TArgs&&... in_args) noexcept(std::is_nothrow_constructible<TValue, TArgs...>::value);
+
+		/// Creates a failed result described only by the error. The message is looked up
+		/// in the ErrorCatalog for TError when it is read, so this makes no allocation.
+		/// This is only available if an ErrorCatalog has been provided for TError.
+		///
+		/// @param in_error - The error that occurred.
+		/// @param in_location - Where the error occurred. This should be left as the default.
+		///
+		template <typename TCatalogError = TError, typename = typename std::enable_if<HasErrorCatalog<TCatalogError>::value>::type> explicit Result(TError in_error, SourceLocation in_location = SourceLocation::current()) noexcept;
+
+		/// Creates a failed result with the given error and message. The message is copied
+		/// into a single allocation along with the rest of the error description, unless
+		/// it fits in the inline message capacity of the policy, in which case it is
+		/// stored in the result and no allocation is made.
+		///
+		/// @param in_error - The error that occurred.
+		/// @param in_errorMessage - A description of the error that occurred.
+		/// @param in_location - Where the error occurred. This should be left as the default.
+		///
+		Result(TError in_error, std::string_view in_errorMessage, SourceLocation in_location = SourceLocation::current()) noexcept;
 
-		/// Creates a failed result with the given error and message.
+		/// Creates a failed result with the given error and static message. Only a pointer
+		/// to the message is stored, so this makes no allocation.
 		///
 		/// @param in_error - The error that occurred.
 		/// @param in_errorMessage - A description of the error that occurred.
+		/// @param in_location - Where the error occurred. This should be left as the default.
 		///
-		Result(TError in_error, const std::string& in_errorMessage) noexcept;
+		Result(TError in_error, StaticMessage in_errorMessage, SourceLocation in_location = SourceLocation::current()) noexcept;
 
 		/// Creates a failed result with the given error, message and the result that caused the error.
+		/// The cause can be a failed Result with any template parameters, or an ErrorNode
+		/// from a cause chain.
 		///
 		/// @param in_error - The error that occurred.
 		/// @param in_errorMessage - A description of the error that occurred.
+		/// @param in_causedBy - The result which caused the error.
+		/// @param in_location - Where the error occurred. This should be left as the default.
+		///
+		template <typename TCause> Result(TError in_error, std::string_view in_errorMessage, const TCause& in_causedBy, SourceLocation in_location = SourceLocation::current()) noexcept;
+
+		/// Creates a failed result with the given error, static message and the result that
+		/// caused the error.
+		///
+		/// @param in_error - The error that occurred.
+		/// @param in_errorMessage - A description of the error that occurred.
+		/// @param in_causedBy - The result which caused the error.
+		/// @param in_location - Where the error occurred. This should be left as the default.
+		///
+		template <typename TCause> Result(TError in_error, StaticMessage in_errorMessage, const TCause& in_causedBy, SourceLocation in_location = SourceLocation::current()) noexcept;
+
+		/// Creates a failed result with the given error and a message which will only be
+		/// formatted if it is read. See deferMessage().
+		///
+		/// @param in_error - The error that occurred.
+		/// @param in_errorMessage - A deferred description of the error that occurred.
+		/// @param in_location - Where the error occurred. This should be left as the default.
+		///
+		template <typename... TArgs> Result(TError in_error, DeferredMessage<TArgs...> in_errorMessage, SourceLocation in_location = SourceLocation::current()) noexcept;
+
+		/// Creates a failed result with the given error, a message which will only be
+		/// formatted if it is read, and the result that caused the error.
+		///
+		/// @param in_error - The error that occurred.
+		/// @param in_errorMessage - A deferred description of the error that occurred.
+		/// @param in_causedBy - The result which caused the error.
+		/// @param in_location - Where the error occurred. This should be left as the default.
+		///
+		template <typename TCause, typename... TArgs> Result(TError in_error, DeferredMessage<TArgs...> in_errorMessage, const TCause& in_causedBy, SourceLocation in_location = SourceLocation::current()) noexcept;
+
+		/// Creates a failed result with the same error as a failed result with a different
+		/// value type, so that a failure can be passed on without being wrapped. The error
+		/// description is shared or copied in the same way as when copying a result, so
+		/// this makes no allocation.
+		///
+		/// @param in_failure - The failed result.
+		///
+		template <typename TOtherValue, typename = typename std::enable_if<!std::is_same<TOtherValue, TValue>::value>::type> explicit Result(const Result<TOtherValue, TError, TErrorSuccess, TPolicy>& in_failure) noexcept;
+
+		/// Creates a failed result by moving the error out of a failed result with a
+		/// different value type. Unlike copying, this doesn't touch the reference count of
+		/// the error node. See forwardFailure().
+		///
+		/// @param in_failure - The failed result. This still reports the same error
+		/// afterwards, but if the error had a node its message becomes
+		/// Detail::k_movedFromMessage and its causes are no longer available.
 		///
-		Result(TError in_error, const std::string& in_errorMessage, const IResult& in_causedBy) noexcept;
+		template <typename TOtherValue, typename = typename std::enable_if<!std::is_same<TOtherValue, TValue>::value>::type> explicit Result(Result<TOtherValue, TError, TErrorSuccess, TPolicy>&& in_failure) noexcept;
+
+		/// Used by the coroutine support in Propagation.h to construct the result of a
+		/// coroutine, and therefore shouldn't be called by the user of the class.
+		///
+		/// @param in_return - The object returned by the promise of the coroutine.
+		///
+		Result(Detail::ResultCoroutineReturn<Result<TValue, TError, TErrorSuccess, TPolicy>>&& in_return) noexcept;
 
 		/// @param in_toCopy - The result which should be copied.
 		///
-		Result(const Result<TValue, TError, TErrorSuccess>& in_toCopy) noexcept;
+		Result(const Result<TValue, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept(std::is_nothrow_copy_constructible<TValue>::value);
 
+		/// A moved from failure still reports the same error, but if the error had a node
+		/// its message becomes Detail::k_movedFromMessage and its causes are no longer
+		/// available. The same applies to move assignment.
+		///
 		/// @param in_toMove - The result which should be moved into this.
 		///
-		Result(Result<TValue, TError, TErrorSuccess>&& in_toMove) noexcept;
+		Result(Result<TValue, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept(std::is_nothrow_move_constructible<TValue>::value);
 
+		/// If copying the value throws, this result is left unchanged.
+		///
 		/// @param in_toCopy - The result which should be copied.
 		///
-		Result<TValue, TError, TErrorSuccess>& operator=(const Result<TValue, TError, TErrorSuccess>& in_toCopy) noexcept;
+		Result<TValue, TError, TErrorSuccess, TPolicy>& operator=(const Result<TValue, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept(k_isNothrowCopyAssignable);
 
 		/// @param in_toMove - The result which should be moved into this.
 		///
-		Result<TValue, TError, TErrorSuccess>& operator=(Result<TValue, TError, TErrorSuccess>&& in_toMove) noexcept;
+		Result<TValue, TError, TErrorSuccess, TPolicy>& operator=(Result<TValue, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept(k_isNothrowMoveAssignable);
+
+		~Result() noexcept;
+
+		/// Bool conversion operator. Allows validity queries in the form:
+		///
+		///     if (result) {...}
+		///
+		/// @return Whether or not the result was successful.
+		///
+		explicit operator bool() const noexcept;
 
 		/// Whether or not the result describes an error case. Typically this isn't called 
-		/// directly, instead the IResult can be treated as a boolean, for example: 
+		/// directly, instead the result can be treated as a boolean, for example: 
 		///
 		///     if (result) {...}
 		///
@@ -114,14 +265,26 @@ namespace IC
 		///
 		/// @return Whether or not the result describes an error case. 
 		///
-		bool wasSuccessful() const noexcept override;
+		bool wasSuccessful() const noexcept;
 
 		/// Before calling this wasSuccessful() should be checked to ensure the result was
 		/// successful therefore has a value.
 		///
 		/// @return The value.
 		///
-		const TValue& getValue() const noexcept;
+		const TValue& getValue() const & noexcept;
+
+		/// Moves the value out of a result which is no longer needed, for example:
+		///
+		///     std::vector<char> buffer = tryLoadFile(path).getValue();
+		///     std::vector<char> buffer = std::move(result).getValue();
+		///
+		/// Before calling this wasSuccessful() should be checked to ensure the result was
+		/// successful therefore has a value.
+		///
+		/// @return The value.
+		///
+		TValue getValue() && noexcept(std::is_nothrow_move_constructible<TValue>::value);
 
 		/// @return The error that occurred. If no error occurred this will return 
 		/// TErrorSuccess
@@ -129,45 +292,119 @@ namespace IC
 		TError getError() const noexcept;
 
 		/// @return A message describing the error. This should not  be called if no error 
-		/// occurred.
+		/// occurred. The message remains valid for as long as this result, or any result
+		/// it is the cause of, exists.
 		///
-		const std::string& getErrorMessage() const noexcept override;
+		std::string_view getErrorMessage() const noexcept;
 
+		/// @param in_format - How the causes should be laid out. With k_tree, each cause
+		/// is indented beneath the error it caused.
+		///
 		/// @return A message describing this error and any errors which caused this error
 		/// to occur. In other words, the output contains the error message for this and
-		/// appends the full error message of the output from getCausedBy(). This should not
+		/// appends the full error message of each of its causes. This should not
 		/// be called if no error occurred. This will be evaluated each time the method is 
-		/// called. This is to avoid upfront cost if it isn't used.
+		/// called. This is to avoid upfront cost if it isn't used. This is a wrapper around
+		/// writeFullErrorMessage() with a StringErrorSink.
 		///
-		std::string getFullErrorMessage() const noexcept override;
+		std::string getFullErrorMessage(ErrorMessageFormat in_format = ErrorMessageFormat::k_chain) const noexcept;
 
-		/// @return A pointer to the error which caused this one to occur. If this  wasn't
-		/// caused by another this will return null.  This should not be called if no error
-		/// occurred.
+		/// Writes a message describing this error and any errors which caused it into the
+		/// given sink, without building any intermediate strings. The cause chain is
+		/// walked iteratively, first to size the sink and then to write the message. For
+		/// example, to reuse a single buffer when logging many errors:
+		///
+		///     buffer.clear();
+		///     IC::StringErrorSink sink(buffer);
+		///     result.writeFullErrorMessage(sink);
+		///
+		/// This should not be called if no error occurred.
 		///
-		const IResult* getCausedBy() const noexcept override;
+		/// @param io_sink - The sink to write to, for example a StringErrorSink,
+		/// StreamErrorSink or FixedBufferErrorSink.
+		/// @param in_format - How the causes should be laid out.
+		///
+		template <typename TSink> void writeFullErrorMessage(TSink& io_sink, ErrorMessageFormat in_format = ErrorMessageFormat::k_chain) const noexcept;
+
+		/// @return A pointer to the error which caused this one to occur, or the first of
+		/// them if there were several. If this  wasn't caused by another this will return
+		/// null.  This should not be called if no error occurred.
+		///
+		const ErrorNode* getCausedBy() const noexcept;
 
-		/// This is used internally to allow different derrived classes to clone another
-		/// and therefore should be called rarely by the user of the class.  This should 
+		/// @return The errors which directly caused this one, in the order they were
+		/// given. Use ErrorNode::getErrorTree() on each to visit every error beneath
+		/// them. This should not be called if no error occurred.
+		///
+		ErrorCauseRange getCauses() const noexcept;
+
+		/// @return A hash of the error type, error value and message template of this
+		/// error and each error that caused it, which identifies repeats of the same
+		/// failure without formatting the message. See ErrorNode::getFingerprint(). This
+		/// should not be called if no error occurred.
+		///
+		std::uint64_t getFingerprint() const noexcept;
+
+		/// @return Where the failure was created, or an empty location if the policy
+		/// doesn't capture source locations. A failure passed on with IC_TRY, or converted
+		/// from a result with another value type, keeps its original location. This should
 		/// not be called if no error occurred.
 		///
-		std::unique_ptr<const IResult> cloneError() const noexcept override;
+		SourceLocation getSourceLocation() const noexcept;
+
+		/// This is used internally to allow a result with different template parameters
+		/// to store this as its cause, and therefore should be called rarely by the user
+		/// of the class. This is O(1) as the error node is shared rather than copied. This
+		/// should not be called if no error occurred.
+		///
+		/// @return A shared pointer to the node describing this error.
+		///
+		ErrorNodePtr shareError() const noexcept;
 
 	private:
-		TValue m_value;
+		template <typename TOtherValue, typename TOtherError, TOtherError TOtherErrorSuccess, typename TOtherPolicy> friend class Result;
+
+		static constexpr bool k_isNothrowCopyAssignable = std::is_nothrow_copy_constructible<TValue>::value && std::is_nothrow_copy_assignable<TValue>::value && std::is_nothrow_move_constructible<TValue>::value;
+		static constexpr bool k_isNothrowMoveAssignable = std::is_nothrow_move_constructible<TValue>::value && std::is_nothrow_move_assignable<TValue>::value;
+
+		using ErrorPayload = Detail::ErrorPayload<TError, TErrorSuccess, TPolicy>;
+
+		/// Constructs either the value or the error payload from the given result,
+		/// depending on which it holds. The union must be uninitialised.
+		///
+		/// @param in_toCopy - The result to copy.
+		///
+		void construct(const Result<TValue, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept(std::is_nothrow_copy_constructible<TValue>::value);
+
+		/// Constructs either the value or the error payload from the given result,
+		/// depending on which it holds. The union must be uninitialised.
+		///
+		/// @param in_toMove - The result to move from.
+		///
+		void construct(Result<TValue, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept(std::is_nothrow_move_constructible<TValue>::value);
+
+		/// Destroys either the value or the error payload, depending on which is currently
+		/// held. This leaves the union uninitialised.
+		///
+		void destroy() noexcept;
+
 		TError m_error;
-		std::string m_errorMessage;
-		std::unique_ptr<const IResult> m_causedBy;
+		Detail::ErrorStorage m_errorStorage;
+		union
+		{
+			TValue m_value;
+			ErrorPayload m_errorPayload;
+		};
 	};
 
 	/// A convenience typedef for results which use a boolean error value.
 	///
-	template <typename TValue> using BoolResult = Result<TValue, bool, true>;
+	template <typename TValue, typename TPolicy = DefaultResultPolicy> using BoolResult = Result<TValue, bool, true, TPolicy>;
 
 	/// A convenience typedef for results that contain no value only an information on an
 	/// error.
 	///
-	template <typename TError, TError TErrorSuccess = TError()> using Error = Result<void, TError, TErrorSuccess>;
+	template <typename TError, TError TErrorSuccess = TError(), typename TPolicy = DefaultResultPolicy> using Error = Result<void, TError, TErrorSuccess, TPolicy>;
 
 	/// A convenience typedef for results that contain no value only an information on an
 	/// boolean error.
@@ -176,5 +413,6 @@ namespace IC
 }
 
 #include "ResultImpl.h"
+#include "Propagation.h"
 
 #endif
\ No newline at end of file
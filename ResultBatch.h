@@ -0,0 +1,440 @@
+// ResultBatch.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_RESULTBATCH_H_
+#define _IC_RESULTBATCH_H_
+
+#include "Result.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace IC
+{
+	/// A batch of results stored as a structure of arrays, for bulk operations such as
+	/// validating or converting a column of values. The values are stored in a dense
+	/// array, which of them failed in a bitmask, and the errors in a sparse table sorted
+	/// by index, so a batch where most elements succeed costs little more than the
+	/// values themselves, and checking for failures never touches the values at all.
+	///
+	///     IC::ResultBatch<std::uint32_t, ParseError> digits;
+	///     digits.reserve(text.size());
+	///     for (auto c : text)
+	///     {
+	///         digits.add(tryParseDigit(c));
+	///     }
+	///
+	///     if (!digits.allSucceeded())
+	///     {
+	///         return IC::BoolError(false, "Could not parse the digits.", digits.getResult(digits.getFirstFailure()));
+	///     }
+	///
+	/// The elements of failed results hold a default constructed value, so TValue must
+	/// be default constructible.
+	///
+	template <typename TValue, typename TError, TError TErrorSuccess = TError(), typename TPolicy = DefaultResultPolicy> class ResultBatch final
+	{
+		static_assert(std::is_default_constructible<TValue>::value, "The values of a ResultBatch must be default constructible.");
+
+	public:
+		using ErrorType = Result<void, TError, TErrorSuccess, TPolicy>;
+
+		/// An entry in the sparse error table.
+		///
+		struct Failure final
+		{
+			std::size_t m_index;
+			ErrorType m_error;
+		};
+
+		ResultBatch() noexcept = default;
+
+		/// Creates a batch of the given size in which every element succeeded with a
+		/// default constructed value. The values can then be written through getValues(),
+		/// and failures recorded with setFailure().
+		///
+		/// @param in_size - The number of elements.
+		///
+		explicit ResultBatch(std::size_t in_size) noexcept
+			: m_values(in_size), m_failureMask(getWordCount(in_size), 0)
+		{
+		}
+
+		/// @param in_size - The number of elements to reserve space for.
+		///
+		void reserve(std::size_t in_size) noexcept
+		{
+			m_values.reserve(in_size);
+			m_failureMask.reserve(getWordCount(in_size));
+		}
+
+		/// @return The number of elements.
+		///
+		std::size_t size() const noexcept
+		{
+			return m_values.size();
+		}
+
+		/// @return Whether or not the batch has no elements.
+		///
+		bool empty() const noexcept
+		{
+			return m_values.empty();
+		}
+
+		/// Removes every element.
+		///
+		void clear() noexcept
+		{
+			m_values.clear();
+			m_failureMask.clear();
+			m_failures.clear();
+		}
+
+		/// Adds a successful element.
+		///
+		/// @param in_value - The value.
+		///
+		void addValue(TValue in_value) noexcept
+		{
+			addElement();
+			m_values.push_back(std::move(in_value));
+		}
+
+		/// Adds a failed element.
+		///
+		/// @param in_error - The failed result describing the error.
+		///
+		void addFailure(ErrorType in_error) noexcept
+		{
+			assert(!in_error.wasSuccessful());
+
+			auto index = addElement();
+			m_values.emplace_back();
+			setFailureBit(index);
+			m_failures.push_back(Failure{ index, std::move(in_error) });
+		}
+
+		/// Adds an element with the value or error of the given result.
+		///
+		/// @param in_result - The result to add.
+		///
+		void add(const Result<TValue, TError, TErrorSuccess, TPolicy>& in_result) noexcept
+		{
+			if (in_result.wasSuccessful())
+			{
+				addValue(in_result.getValue());
+			}
+			else
+			{
+				addFailure(ErrorType(in_result));
+			}
+		}
+
+		/// Sets an element to succeed with the given value, removing its error if it had
+		/// failed.
+		///
+		/// @param in_index - The index of the element.
+		/// @param in_value - The value.
+		///
+		void setValue(std::size_t in_index, TValue in_value) noexcept
+		{
+			assert(in_index < size());
+
+			m_values[in_index] = std::move(in_value);
+			if (!wasSuccessful(in_index))
+			{
+				m_failureMask[in_index / k_bitsPerWord] &= ~getBit(in_index);
+				m_failures.erase(findFailure(in_index));
+			}
+		}
+
+		/// Sets an element to fail with the given error. Setting failures in increasing
+		/// order of index appends to the error table; setting them out of order inserts
+		/// into it.
+		///
+		/// @param in_index - The index of the element.
+		/// @param in_error - The failed result describing the error.
+		///
+		void setFailure(std::size_t in_index, ErrorType in_error) noexcept
+		{
+			assert(in_index < size());
+			assert(!in_error.wasSuccessful());
+
+			m_values[in_index] = TValue();
+			if (!wasSuccessful(in_index))
+			{
+				findFailure(in_index)->m_error = std::move(in_error);
+				return;
+			}
+
+			setFailureBit(in_index);
+			auto position = m_failures.empty() || m_failures.back().m_index < in_index ? m_failures.end() : std::lower_bound(m_failures.begin(), m_failures.end(), in_index, compareIndex);
+			m_failures.insert(position, Failure{ in_index, std::move(in_error) });
+		}
+
+		/// @param in_index - The index of the element.
+		///
+		/// @return Whether or not the element succeeded.
+		///
+		bool wasSuccessful(std::size_t in_index) const noexcept
+		{
+			assert(in_index < size());
+
+			return (m_failureMask[in_index / k_bitsPerWord] & getBit(in_index)) == 0;
+		}
+
+		/// @param in_index - The index of the element. This must have succeeded.
+		///
+		/// @return The value of the element.
+		///
+		const TValue& getValue(std::size_t in_index) const noexcept
+		{
+			assert(wasSuccessful(in_index));
+
+			return m_values[in_index];
+		}
+
+		/// @return The dense array of values. Elements which failed hold a default
+		/// constructed value.
+		///
+		TValue* getValues() noexcept
+		{
+			return m_values.data();
+		}
+
+		/// @return The dense array of values. Elements which failed hold a default
+		/// constructed value.
+		///
+		const TValue* getValues() const noexcept
+		{
+			return m_values.data();
+		}
+
+		/// @param in_index - The index of the element.
+		///
+		/// @return The error of the element, or TErrorSuccess if it succeeded.
+		///
+		TError getError(std::size_t in_index) const noexcept
+		{
+			return wasSuccessful(in_index) ? TErrorSuccess : findFailure(in_index)->m_error.getError();
+		}
+
+		/// @param in_index - The index of the element.
+		///
+		/// @return The element as a Result, which refers to the value in the batch if the
+		/// element succeeded and shares the error description if it failed.
+		///
+		Result<const TValue&, TError, TErrorSuccess, TPolicy> getResult(std::size_t in_index) const noexcept
+		{
+			if (wasSuccessful(in_index))
+			{
+				return Result<const TValue&, TError, TErrorSuccess, TPolicy>(m_values[in_index]);
+			}
+
+			return Result<const TValue&, TError, TErrorSuccess, TPolicy>(findFailure(in_index)->m_error);
+		}
+
+		/// @return Whether or not every element succeeded.
+		///
+		bool allSucceeded() const noexcept
+		{
+			return m_failures.empty();
+		}
+
+		/// @return The number of elements which failed.
+		///
+		std::size_t countFailures() const noexcept
+		{
+			return m_failures.size();
+		}
+
+		/// @return The index of the first element which failed, or size() if every
+		/// element succeeded.
+		///
+		std::size_t getFirstFailure() const noexcept
+		{
+			return m_failures.empty() ? size() : m_failures.front().m_index;
+		}
+
+		/// @return The sparse error table, sorted by index.
+		///
+		const std::vector<Failure>& getFailures() const noexcept
+		{
+			return m_failures;
+		}
+
+		/// Copies the values of the elements which succeeded, in order, and lists the
+		/// indices of those which failed. Only the set bits of the bitmask are visited,
+		/// and the runs of successful values between them are copied in bulk.
+		///
+		/// @param out_values - The vector the successful values are appended to.
+		/// @param out_failedIndices - The vector the indices of failures are appended to.
+		///
+		void partition(std::vector<TValue>& out_values, std::vector<std::size_t>& out_failedIndices) const noexcept
+		{
+			out_values.reserve(out_values.size() + size() - countFailures());
+			out_failedIndices.reserve(out_failedIndices.size() + countFailures());
+
+			std::size_t runStart = 0;
+			for (std::size_t word = 0; word < m_failureMask.size(); ++word)
+			{
+				for (auto mask = m_failureMask[word]; mask != 0; mask &= mask - 1)
+				{
+					auto index = word * k_bitsPerWord + getLowestBit(mask);
+					out_values.insert(out_values.end(), m_values.begin() + runStart, m_values.begin() + index);
+					out_failedIndices.push_back(index);
+					runStart = index + 1;
+				}
+			}
+			out_values.insert(out_values.end(), m_values.begin() + runStart, m_values.end());
+		}
+
+		/// Removes every failed element, moving the successful values down so they remain
+		/// in order.
+		///
+		/// @return The removed failures, with the indices they had before compaction.
+		///
+		std::vector<Failure> compact() noexcept
+		{
+			if (m_failures.empty())
+			{
+				return std::vector<Failure>();
+			}
+
+			auto output = m_values.begin() + m_failures.front().m_index;
+			auto runStart = output;
+			for (std::size_t word = m_failures.front().m_index / k_bitsPerWord; word < m_failureMask.size(); ++word)
+			{
+				for (auto mask = m_failureMask[word]; mask != 0; mask &= mask - 1)
+				{
+					auto failure = m_values.begin() + word * k_bitsPerWord + getLowestBit(mask);
+					output = std::move(runStart, failure, output);
+					runStart = failure + 1;
+				}
+			}
+			output = std::move(runStart, m_values.end(), output);
+
+			m_values.erase(output, m_values.end());
+			m_failureMask.assign(getWordCount(m_values.size()), 0);
+
+			std::vector<Failure> failures;
+			failures.swap(m_failures);
+			return failures;
+		}
+
+	private:
+		static constexpr std::size_t k_bitsPerWord = 64;
+
+		//-----------------------------------------------------------------------------
+		static constexpr std::size_t getWordCount(std::size_t in_size) noexcept
+		{
+			return (in_size + k_bitsPerWord - 1) / k_bitsPerWord;
+		}
+
+		//-----------------------------------------------------------------------------
+		static constexpr std::uint64_t getBit(std::size_t in_index) noexcept
+		{
+			return std::uint64_t(1) << (in_index % k_bitsPerWord);
+		}
+
+		/// @param in_mask - A mask with at least one bit set.
+		///
+		/// @return The index of the lowest set bit.
+		///
+		static std::size_t getLowestBit(std::uint64_t in_mask) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<std::size_t>(__builtin_ctzll(in_mask));
+#else
+			std::size_t bit = 0;
+			while ((in_mask & 1) == 0)
+			{
+				in_mask >>= 1;
+				++bit;
+			}
+			return bit;
+#endif
+		}
+
+		//-----------------------------------------------------------------------------
+		static bool compareIndex(const Failure& in_failure, std::size_t in_index) noexcept
+		{
+			return in_failure.m_index < in_index;
+		}
+
+		/// Grows the bitmask for a new element, if needed.
+		///
+		/// @return The index of the new element.
+		///
+		std::size_t addElement() noexcept
+		{
+			auto index = size();
+			if (index % k_bitsPerWord == 0)
+			{
+				m_failureMask.push_back(0);
+			}
+			return index;
+		}
+
+		//-----------------------------------------------------------------------------
+		void setFailureBit(std::size_t in_index) noexcept
+		{
+			m_failureMask[in_index / k_bitsPerWord] |= getBit(in_index);
+		}
+
+		/// @param in_index - The index of a failed element.
+		///
+		/// @return The entry for the element in the error table.
+		///
+		typename std::vector<Failure>::iterator findFailure(std::size_t in_index) noexcept
+		{
+			auto failure = std::lower_bound(m_failures.begin(), m_failures.end(), in_index, compareIndex);
+			assert(failure != m_failures.end() && failure->m_index == in_index);
+			return failure;
+		}
+
+		/// @param in_index - The index of a failed element.
+		///
+		/// @return The entry for the element in the error table.
+		///
+		typename std::vector<Failure>::const_iterator findFailure(std::size_t in_index) const noexcept
+		{
+			auto failure = std::lower_bound(m_failures.begin(), m_failures.end(), in_index, compareIndex);
+			assert(failure != m_failures.end() && failure->m_index == in_index);
+			return failure;
+		}
+
+		std::vector<TValue> m_values;
+		std::vector<std::uint64_t> m_failureMask;
+		std::vector<Failure> m_failures;
+	};
+}
+
+#endif
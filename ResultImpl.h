@@ -27,72 +27,196 @@
 #define _IC_RESULTIMPL_H_
 
 #include <assert.h>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 #include "Result.h"
 
 namespace IC
 {
-	template <typename TError, TError TErrorSuccess> class Result<void, TError, TErrorSuccess> final : public IResult
+	template <typename TError, TError TErrorSuccess, typename TPolicy> class Result<void, TError, TErrorSuccess, TPolicy> final
 	{
 	public:
 		//-----------------------------------------------------------------------------
 		Result() noexcept
-			: m_error(TErrorSuccess)
+			: m_error(TErrorSuccess), m_errorStorage(Detail::ErrorStorage::k_staticMessage)
 		{
 		}
 
 		//-----------------------------------------------------------------------------
-		Result(TError in_error, const std::string& in_errorMessage) noexcept
-			: m_error(in_error), m_errorMessage(in_errorMessage)
+		template <typename TCatalogError = TError, typename = typename std::enable_if<HasErrorCatalog<TCatalogError>::value>::type> explicit Result(TError in_error, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(ErrorPayload::k_staticStorage)
 		{
 			assert(!wasSuccessful());
+
+			new (&m_errorPayload) ErrorPayload(in_error, StaticMessage(nullptr), in_location);
 		}
 
 		//-----------------------------------------------------------------------------
-		Result(TError in_error, const std::string& in_errorMessage, const IResult& in_causedBy) noexcept
-			: m_errorMessage(in_errorMessage), m_causedBy(in_causedBy.cloneError())
+		Result(TError in_error, std::string_view in_errorMessage, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(ErrorPayload::getStorage(in_errorMessage))
 		{
 			assert(!wasSuccessful());
-			assert(!m_causedBy);
+
+			new (&m_errorPayload) ErrorPayload(m_errorStorage, in_error, in_errorMessage, in_location);
 		}
 
 		//-----------------------------------------------------------------------------
-		Result(const Result<void, TError, TErrorSuccess>& in_toCopy) noexcept
-			: m_error(in_toCopy.m_error), m_errorMessage(in_toCopy.m_errorMessage), m_causedBy(in_toCopy.m_causedBy->cloneError())
+		Result(TError in_error, StaticMessage in_errorMessage, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(ErrorPayload::k_staticStorage)
 		{
+			assert(!wasSuccessful());
+
+			new (&m_errorPayload) ErrorPayload(in_error, in_errorMessage, in_location);
 		}
 
 		//-----------------------------------------------------------------------------
-		Result(Result<void, TError, TErrorSuccess>&& in_toMove) noexcept
-			: m_error(in_toMove.m_error), m_errorMessage(in_toMove.m_errorMessage), m_causedBy(std::move(in_toMove.m_causedBy))
+		template <typename... TArgs> Result(TError in_error, DeferredMessage<TArgs...> in_errorMessage, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node)
 		{
-			in_toMove.m_errorMessage = "";
+			assert(!wasSuccessful());
+
+			new (&m_errorPayload) ErrorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage)), in_location);
 		}
 
 		//-----------------------------------------------------------------------------
-		Result<void, TError, TErrorSuccess>& operator=(const Result<void, TError, TErrorSuccess>& in_toCopy) noexcept
+		template <typename TCause> Result(TError in_error, std::string_view in_errorMessage, const TCause& in_causedBy, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node)
 		{
-			m_error = in_toCopy.m_error;
-			m_errorMessage = in_toCopy.m_errorMessage;
-			m_causedBy = in_toCopy.m_causedBy->clone();
+			assert(!wasSuccessful());
+			assert(!in_causedBy.wasSuccessful());
 
-			return *this;
+			new (&m_errorPayload) ErrorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, in_errorMessage, in_causedBy), in_location);
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TCause> Result(TError in_error, StaticMessage in_errorMessage, const TCause& in_causedBy, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node)
+		{
+			assert(!wasSuccessful());
+			assert(!in_causedBy.wasSuccessful());
+
+			new (&m_errorPayload) ErrorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, in_errorMessage, in_causedBy), in_location);
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TCause, typename... TArgs> Result(TError in_error, DeferredMessage<TArgs...> in_errorMessage, const TCause& in_causedBy, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node)
+		{
+			assert(!wasSuccessful());
+			assert(!in_causedBy.wasSuccessful());
+
+			new (&m_errorPayload) ErrorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage), in_causedBy), in_location);
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TOtherValue, typename = typename std::enable_if<!std::is_same<TOtherValue, void>::value>::type> explicit Result(const Result<TOtherValue, TError, TErrorSuccess, TPolicy>& in_failure) noexcept
+			: m_error(in_failure.m_error), m_errorStorage(in_failure.m_errorStorage)
+		{
+			assert(!wasSuccessful());
+
+			new (&m_errorPayload) ErrorPayload(m_errorStorage, in_failure.m_errorPayload);
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TOtherValue, typename = typename std::enable_if<!std::is_same<TOtherValue, void>::value>::type> explicit Result(Result<TOtherValue, TError, TErrorSuccess, TPolicy>&& in_failure) noexcept
+			: m_error(in_failure.m_error), m_errorStorage(in_failure.m_errorStorage)
+		{
+			assert(!wasSuccessful());
+
+			new (&m_errorPayload) ErrorPayload(m_errorStorage, std::move(in_failure.m_errorPayload), in_failure.m_errorStorage);
+		}
+
+		//-----------------------------------------------------------------------------
+		Result(Detail::ResultCoroutineReturn<Result<void, TError, TErrorSuccess, TPolicy>>&& in_return) noexcept
+		{
+			if (in_return.isComplete())
+			{
+				auto& completed = in_return.getResult();
+				m_error = completed.m_error;
+				m_errorStorage = completed.m_errorStorage;
+				if (!wasSuccessful())
+				{
+					new (&m_errorPayload) ErrorPayload(m_errorStorage, std::move(completed.m_errorPayload), completed.m_errorStorage);
+				}
+			}
+			else
+			{
+				in_return.redirect(this);
+			}
 		}
 
 		//-----------------------------------------------------------------------------
-		Result<void, TError, TErrorSuccess>& operator=(Result<void, TError, TErrorSuccess>&& in_toMove) noexcept
+		Result(const Result<void, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept
+			: m_error(in_toCopy.m_error), m_errorStorage(in_toCopy.m_errorStorage)
 		{
-			m_error = in_toMove.m_error;
-			m_errorMessage = in_toMove.m_errorMessage;
-			m_causedBy = std::move(in_toMove.m_causedBy);
+			if (!wasSuccessful())
+			{
+				new (&m_errorPayload) ErrorPayload(m_errorStorage, in_toCopy.m_errorPayload);
+			}
+		}
+
+		//-----------------------------------------------------------------------------
+		Result(Result<void, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept
+			: m_error(in_toMove.m_error), m_errorStorage(in_toMove.m_errorStorage)
+		{
+			if (!wasSuccessful())
+			{
+				new (&m_errorPayload) ErrorPayload(m_errorStorage, std::move(in_toMove.m_errorPayload), in_toMove.m_errorStorage);
+			}
+		}
 
-			in_toMove.m_errorMessage = "";
+		//-----------------------------------------------------------------------------
+		Result<void, TError, TErrorSuccess, TPolicy>& operator=(const Result<void, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept
+		{
+			if (this != &in_toCopy)
+			{
+				destroy();
+
+				m_error = in_toCopy.m_error;
+				m_errorStorage = in_toCopy.m_errorStorage;
+				if (!wasSuccessful())
+				{
+					new (&m_errorPayload) ErrorPayload(m_errorStorage, in_toCopy.m_errorPayload);
+				}
+			}
 
 			return *this;
 		}
 
 		//-----------------------------------------------------------------------------
-		bool wasSuccessful() const noexcept override
+		Result<void, TError, TErrorSuccess, TPolicy>& operator=(Result<void, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept
+		{
+			if (this != &in_toMove)
+			{
+				destroy();
+
+				m_error = in_toMove.m_error;
+				m_errorStorage = in_toMove.m_errorStorage;
+				if (!wasSuccessful())
+				{
+					new (&m_errorPayload) ErrorPayload(m_errorStorage, std::move(in_toMove.m_errorPayload), in_toMove.m_errorStorage);
+				}
+			}
+
+			return *this;
+		}
+
+		//-----------------------------------------------------------------------------
+		~Result() noexcept
+		{
+			destroy();
+		}
+
+		//-----------------------------------------------------------------------------
+		explicit operator bool() const noexcept
+		{
+			return wasSuccessful();
+		}
+
+		//-----------------------------------------------------------------------------
+		bool wasSuccessful() const noexcept
 		{
 			return m_error == TErrorSuccess;
 		}
@@ -100,7 +224,7 @@ namespace IC
 		//-----------------------------------------------------------------------------
 		void getValue() const noexcept
 		{
-			assert (false)
+			assert(false);
 		}
 
 		//-----------------------------------------------------------------------------
@@ -110,119 +234,611 @@ namespace IC
 		}
 
 		//-----------------------------------------------------------------------------
-		const std::string& getErrorMessage() const noexcept override
+		std::string_view getErrorMessage() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getErrorMessage(m_errorStorage, m_error);
+		}
+
+		//-----------------------------------------------------------------------------
+		std::string getFullErrorMessage(ErrorMessageFormat in_format = ErrorMessageFormat::k_chain) const noexcept
 		{
 			assert(!wasSuccessful());
 
-			return m_errorMessage;
+			return m_errorPayload.getFullErrorMessage(m_errorStorage, m_error, in_format);
 		}
 
 		//-----------------------------------------------------------------------------
-		std::string getFullErrorMessage() const noexcept override
+		template <typename TSink> void writeFullErrorMessage(TSink& io_sink, ErrorMessageFormat in_format = ErrorMessageFormat::k_chain) const noexcept
 		{
-			std::string errorMessage = m_errorMessage;
-			if (m_causedBy)
+			assert(!wasSuccessful());
+
+			m_errorPayload.writeFullErrorMessage(m_errorStorage, m_error, io_sink, in_format);
+		}
+
+		//-----------------------------------------------------------------------------
+		const ErrorNode* getCausedBy() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getCausedBy(m_errorStorage);
+		}
+
+		//-----------------------------------------------------------------------------
+		ErrorCauseRange getCauses() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getCauses(m_errorStorage);
+		}
+
+		//-----------------------------------------------------------------------------
+		std::uint64_t getFingerprint() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getFingerprint(m_errorStorage, m_error);
+		}
+
+		//-----------------------------------------------------------------------------
+		SourceLocation getSourceLocation() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getSourceLocation(m_errorStorage);
+		}
+
+		//-----------------------------------------------------------------------------
+		ErrorNodePtr shareError() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.shareError(m_errorStorage, m_error);
+		}
+
+	private:
+		template <typename TOtherValue, typename TOtherError, TOtherError TOtherErrorSuccess, typename TOtherPolicy> friend class Result;
+
+		using ErrorPayload = Detail::ErrorPayload<TError, TErrorSuccess, TPolicy>;
+
+		//-----------------------------------------------------------------------------
+		void destroy() noexcept
+		{
+			if (!wasSuccessful())
 			{
-				errorMessage += "\nCaused by:\n" + m_causedBy->getFullErrorMessage();
+				m_errorPayload.destroy(m_errorStorage);
+				m_errorPayload.~ErrorPayload();
 			}
-			return errorMessage;
+		}
+
+		TError m_error;
+		Detail::ErrorStorage m_errorStorage;
+		union
+		{
+			ErrorPayload m_errorPayload;
+		};
+	};
+
+	/// A specialisation for results which refer to a value owned elsewhere, for example an
+	/// object found in a cache or registry. Only a pointer to the value is stored, so no
+	/// copy is made. Both Result<T&, ...> and Result<const T&, ...> are supported. The
+	/// value must outlive the result.
+	///
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> class Result<TValue&, TError, TErrorSuccess, TPolicy> final
+	{
+	public:
+		//-----------------------------------------------------------------------------
+		Result(TValue& in_value) noexcept
+			: m_error(TErrorSuccess), m_errorStorage(Detail::ErrorStorage::k_staticMessage), m_value(&in_value)
+		{
+		}
+
+		/// Results cannot refer to temporaries, as they would be destroyed before the
+		/// result is used.
+		///
+		Result(TValue&& in_value) = delete;
+
+		//-----------------------------------------------------------------------------
+		template <typename TCatalogError = TError, typename = typename std::enable_if<HasErrorCatalog<TCatalogError>::value>::type> explicit Result(TError in_error, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(ErrorPayload::k_staticStorage), m_errorPayload(in_error, StaticMessage(nullptr), in_location)
+		{
+			assert(!wasSuccessful());
 		}
 
 		//-----------------------------------------------------------------------------
-		const IResult* getCausedBy() const noexcept override
+		Result(TError in_error, std::string_view in_errorMessage, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(ErrorPayload::getStorage(in_errorMessage)), m_errorPayload(m_errorStorage, in_error, in_errorMessage, in_location)
 		{
 			assert(!wasSuccessful());
+		}
 
-			return m_causedBy.get();
+		//-----------------------------------------------------------------------------
+		Result(TError in_error, StaticMessage in_errorMessage, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(ErrorPayload::k_staticStorage), m_errorPayload(in_error, in_errorMessage, in_location)
+		{
+			assert(!wasSuccessful());
 		}
 
 		//-----------------------------------------------------------------------------
-		std::unique_ptr<const IResult> cloneError() const noexcept override
+		template <typename... TArgs> Result(TError in_error, DeferredMessage<TArgs...> in_errorMessage, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node), m_errorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage)), in_location)
 		{
 			assert(!wasSuccessful());
+		}
 
-			if (m_causedBy)
+		//-----------------------------------------------------------------------------
+		template <typename TCause> Result(TError in_error, std::string_view in_errorMessage, const TCause& in_causedBy, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node), m_errorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, in_errorMessage, in_causedBy), in_location)
+		{
+			assert(!wasSuccessful());
+			assert(!in_causedBy.wasSuccessful());
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TCause> Result(TError in_error, StaticMessage in_errorMessage, const TCause& in_causedBy, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node), m_errorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, in_errorMessage, in_causedBy), in_location)
+		{
+			assert(!wasSuccessful());
+			assert(!in_causedBy.wasSuccessful());
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TCause, typename... TArgs> Result(TError in_error, DeferredMessage<TArgs...> in_errorMessage, const TCause& in_causedBy, SourceLocation in_location = SourceLocation::current()) noexcept
+			: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node), m_errorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage), in_causedBy), in_location)
+		{
+			assert(!wasSuccessful());
+			assert(!in_causedBy.wasSuccessful());
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TOtherValue, typename = typename std::enable_if<!std::is_same<TOtherValue, TValue&>::value>::type> explicit Result(const Result<TOtherValue, TError, TErrorSuccess, TPolicy>& in_failure) noexcept
+			: m_error(in_failure.m_error), m_errorStorage(in_failure.m_errorStorage)
+		{
+			assert(!wasSuccessful());
+
+			new (&m_errorPayload) ErrorPayload(m_errorStorage, in_failure.m_errorPayload);
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TOtherValue, typename = typename std::enable_if<!std::is_same<TOtherValue, TValue&>::value>::type> explicit Result(Result<TOtherValue, TError, TErrorSuccess, TPolicy>&& in_failure) noexcept
+			: m_error(in_failure.m_error), m_errorStorage(in_failure.m_errorStorage)
+		{
+			assert(!wasSuccessful());
+
+			new (&m_errorPayload) ErrorPayload(m_errorStorage, std::move(in_failure.m_errorPayload), in_failure.m_errorStorage);
+		}
+
+		//-----------------------------------------------------------------------------
+		Result(Detail::ResultCoroutineReturn<Result<TValue&, TError, TErrorSuccess, TPolicy>>&& in_return) noexcept
+		{
+			if (in_return.isComplete())
 			{
-				return std::unique_ptr<const IResult>(new Result<void, TError, TErrorSuccess>(m_error, m_errorMessage, *m_causedBy));
+				auto& completed = in_return.getResult();
+				m_error = completed.m_error;
+				m_errorStorage = completed.m_errorStorage;
+				construct(std::move(completed));
 			}
 			else
 			{
-				return std::unique_ptr<const IResult>(new Result<void, TError, TErrorSuccess>(m_error, m_errorMessage));
+				in_return.redirect(this);
 			}
 		}
 
+		//-----------------------------------------------------------------------------
+		Result(const Result<TValue&, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept
+			: m_error(in_toCopy.m_error), m_errorStorage(in_toCopy.m_errorStorage)
+		{
+			construct(in_toCopy);
+		}
+
+		//-----------------------------------------------------------------------------
+		Result(Result<TValue&, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept
+			: m_error(in_toMove.m_error), m_errorStorage(in_toMove.m_errorStorage)
+		{
+			construct(std::move(in_toMove));
+		}
+
+		//-----------------------------------------------------------------------------
+		Result<TValue&, TError, TErrorSuccess, TPolicy>& operator=(const Result<TValue&, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept
+		{
+			if (this != &in_toCopy)
+			{
+				destroy();
+
+				m_error = in_toCopy.m_error;
+				m_errorStorage = in_toCopy.m_errorStorage;
+				construct(in_toCopy);
+			}
+
+			return *this;
+		}
+
+		//-----------------------------------------------------------------------------
+		Result<TValue&, TError, TErrorSuccess, TPolicy>& operator=(Result<TValue&, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept
+		{
+			if (this != &in_toMove)
+			{
+				destroy();
+
+				m_error = in_toMove.m_error;
+				m_errorStorage = in_toMove.m_errorStorage;
+				construct(std::move(in_toMove));
+			}
+
+			return *this;
+		}
+
+		//-----------------------------------------------------------------------------
+		~Result() noexcept
+		{
+			destroy();
+		}
+
+		//-----------------------------------------------------------------------------
+		explicit operator bool() const noexcept
+		{
+			return wasSuccessful();
+		}
+
+		//-----------------------------------------------------------------------------
+		bool wasSuccessful() const noexcept
+		{
+			return m_error == TErrorSuccess;
+		}
+
+		/// Before calling this wasSuccessful() should be checked to ensure the result was
+		/// successful therefore has a value.
+		///
+		/// @return The value which the result refers to.
+		///
+		TValue& getValue() const noexcept
+		{
+			assert(wasSuccessful());
+
+			return *m_value;
+		}
+
+		//-----------------------------------------------------------------------------
+		TError getError() const noexcept
+		{
+			return m_error;
+		}
+
+		//-----------------------------------------------------------------------------
+		std::string_view getErrorMessage() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getErrorMessage(m_errorStorage, m_error);
+		}
+
+		//-----------------------------------------------------------------------------
+		std::string getFullErrorMessage(ErrorMessageFormat in_format = ErrorMessageFormat::k_chain) const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getFullErrorMessage(m_errorStorage, m_error, in_format);
+		}
+
+		//-----------------------------------------------------------------------------
+		template <typename TSink> void writeFullErrorMessage(TSink& io_sink, ErrorMessageFormat in_format = ErrorMessageFormat::k_chain) const noexcept
+		{
+			assert(!wasSuccessful());
+
+			m_errorPayload.writeFullErrorMessage(m_errorStorage, m_error, io_sink, in_format);
+		}
+
+		//-----------------------------------------------------------------------------
+		const ErrorNode* getCausedBy() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getCausedBy(m_errorStorage);
+		}
+
+		//-----------------------------------------------------------------------------
+		ErrorCauseRange getCauses() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getCauses(m_errorStorage);
+		}
+
+		//-----------------------------------------------------------------------------
+		std::uint64_t getFingerprint() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getFingerprint(m_errorStorage, m_error);
+		}
+
+		//-----------------------------------------------------------------------------
+		SourceLocation getSourceLocation() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.getSourceLocation(m_errorStorage);
+		}
+
+		//-----------------------------------------------------------------------------
+		ErrorNodePtr shareError() const noexcept
+		{
+			assert(!wasSuccessful());
+
+			return m_errorPayload.shareError(m_errorStorage, m_error);
+		}
+
 	private:
+		template <typename TOtherValue, typename TOtherError, TOtherError TOtherErrorSuccess, typename TOtherPolicy> friend class Result;
+
+		using ErrorPayload = Detail::ErrorPayload<TError, TErrorSuccess, TPolicy>;
+
+		//-----------------------------------------------------------------------------
+		void construct(const Result<TValue&, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept
+		{
+			if (wasSuccessful())
+			{
+				m_value = in_toCopy.m_value;
+			}
+			else
+			{
+				new (&m_errorPayload) ErrorPayload(m_errorStorage, in_toCopy.m_errorPayload);
+			}
+		}
+
+		//-----------------------------------------------------------------------------
+		void construct(Result<TValue&, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept
+		{
+			if (wasSuccessful())
+			{
+				m_value = in_toMove.m_value;
+			}
+			else
+			{
+				new (&m_errorPayload) ErrorPayload(m_errorStorage, std::move(in_toMove.m_errorPayload), in_toMove.m_errorStorage);
+			}
+		}
+
+		//-----------------------------------------------------------------------------
+		void destroy() noexcept
+		{
+			if (!wasSuccessful())
+			{
+				m_errorPayload.destroy(m_errorStorage);
+				m_errorPayload.~ErrorPayload();
+			}
+		}
+
 		TError m_error;
-		std::string m_errorMessage;
-		std::unique_ptr<const IResult> m_causedBy;
+		Detail::ErrorStorage m_errorStorage;
+		union
+		{
+			TValue* m_value;
+			ErrorPayload m_errorPayload;
+		};
 	};
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> Result<TValue, TError, TErrorSuccess>::Result(const TValue& in_value) noexcept
-		: m_value(in_value), m_error(TErrorSuccess)
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(const TValue& in_value) noexcept(std::is_nothrow_copy_constructible<TValue>::value)
+		: m_error(TErrorSuccess), m_errorStorage(Detail::ErrorStorage::k_staticMessage), m_value(in_value)
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(TValue&& in_value) noexcept(std::is_nothrow_move_constructible<TValue>::value)
+		: m_error(TErrorSuccess), m_errorStorage(Detail::ErrorStorage::k_staticMessage), m_value(std::move(in_value))
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> template <typename... TArgs> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(std::in_place_t, TArgs&&... in_args) noexcept(std::is_nothrow_constructible<TValue, TArgs...>::value)
+		: m_error(TErrorSuccess), m_errorStorage(Detail::ErrorStorage::k_staticMessage), m_value(std::forward<TArgs>(in_args)...)
+	{
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> template <typename TCatalogError, typename> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(TError in_error, SourceLocation in_location) noexcept
+		: m_error(in_error), m_errorStorage(ErrorPayload::k_staticStorage), m_errorPayload(in_error, StaticMessage(nullptr), in_location)
+	{
+		assert(!wasSuccessful());
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(TError in_error, std::string_view in_errorMessage, SourceLocation in_location) noexcept
+		: m_error(in_error), m_errorStorage(ErrorPayload::getStorage(in_errorMessage)), m_errorPayload(m_errorStorage, in_error, in_errorMessage, in_location)
+	{
+		assert(!wasSuccessful());
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(TError in_error, StaticMessage in_errorMessage, SourceLocation in_location) noexcept
+		: m_error(in_error), m_errorStorage(ErrorPayload::k_staticStorage), m_errorPayload(in_error, in_errorMessage, in_location)
+	{
+		assert(!wasSuccessful());
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> template <typename... TArgs> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(TError in_error, DeferredMessage<TArgs...> in_errorMessage, SourceLocation in_location) noexcept
+		: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node), m_errorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage)), in_location)
+	{
+		assert(!wasSuccessful());
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> template <typename TCause> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(TError in_error, std::string_view in_errorMessage, const TCause& in_causedBy, SourceLocation in_location) noexcept
+		: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node), m_errorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, in_errorMessage, in_causedBy), in_location)
+	{
+		assert(!wasSuccessful());
+		assert(!in_causedBy.wasSuccessful());
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> template <typename TCause> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(TError in_error, StaticMessage in_errorMessage, const TCause& in_causedBy, SourceLocation in_location) noexcept
+		: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node), m_errorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, in_errorMessage, in_causedBy), in_location)
+	{
+		assert(!wasSuccessful());
+		assert(!in_causedBy.wasSuccessful());
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> template <typename TCause, typename... TArgs> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(TError in_error, DeferredMessage<TArgs...> in_errorMessage, const TCause& in_causedBy, SourceLocation in_location) noexcept
+		: m_error(in_error), m_errorStorage(Detail::ErrorStorage::k_node), m_errorPayload(in_error, Detail::makeColdErrorNode<TError, TErrorSuccess, TPolicy>(in_error, std::move(in_errorMessage), in_causedBy), in_location)
 	{
+		assert(!wasSuccessful());
+		assert(!in_causedBy.wasSuccessful());
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> Result<TValue, TError, TErrorSuccess>::Result(TError in_error, const std::string& in_errorMessage) noexcept
-		: m_error(in_error), m_errorMessage(in_errorMessage)
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> template <typename TOtherValue, typename> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(const Result<TOtherValue, TError, TErrorSuccess, TPolicy>& in_failure) noexcept
+		: m_error(in_failure.m_error), m_errorStorage(in_failure.m_errorStorage)
 	{
 		assert(!wasSuccessful());
+
+		new (&m_errorPayload) ErrorPayload(m_errorStorage, in_failure.m_errorPayload);
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> Result<TValue, TError, TErrorSuccess>::Result(TError in_error, const std::string& in_errorMessage, const IResult& in_causedBy) noexcept
-		: m_error(in_error), m_errorMessage(in_errorMessage), m_causedBy(in_causedBy.cloneError())
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> template <typename TOtherValue, typename> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(Result<TOtherValue, TError, TErrorSuccess, TPolicy>&& in_failure) noexcept
+		: m_error(in_failure.m_error), m_errorStorage(in_failure.m_errorStorage)
 	{
 		assert(!wasSuccessful());
-		assert(!m_causedBy->wasSuccessful());
+
+		new (&m_errorPayload) ErrorPayload(m_errorStorage, std::move(in_failure.m_errorPayload), in_failure.m_errorStorage);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(Detail::ResultCoroutineReturn<Result<TValue, TError, TErrorSuccess, TPolicy>>&& in_return) noexcept
+	{
+		// If the coroutine has already completed the result is moved out of the return
+		// object, otherwise the promise constructs the result here when it completes.
+		if (in_return.isComplete())
+		{
+			auto& completed = in_return.getResult();
+			m_error = completed.m_error;
+			m_errorStorage = completed.m_errorStorage;
+			construct(std::move(completed));
+		}
+		else
+		{
+			in_return.redirect(this);
+		}
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> Result<TValue, TError, TErrorSuccess>::Result(const Result<TValue, TError, TErrorSuccess>& in_toCopy) noexcept
-		: m_value(in_toCopy.m_value), m_error(in_toCopy.m_error), m_errorMessage(in_toCopy.m_errorMessage), m_causedBy(in_toCopy.m_causedBy->cloneError())
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(const Result<TValue, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept(std::is_nothrow_copy_constructible<TValue>::value)
+		: m_error(in_toCopy.m_error), m_errorStorage(in_toCopy.m_errorStorage)
 	{
+		construct(in_toCopy);
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> Result<TValue, TError, TErrorSuccess>::Result(Result<TValue, TError, TErrorSuccess>&& in_toMove) noexcept
-		: m_value(in_toMove.m_value), m_error(in_toMove.m_error), m_errorMessage(in_toMove.m_errorMessage), m_causedBy(std::move(in_toMove.m_causedBy))
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>::Result(Result<TValue, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept(std::is_nothrow_move_constructible<TValue>::value)
+		: m_error(in_toMove.m_error), m_errorStorage(in_toMove.m_errorStorage)
 	{
-		in_toMove.m_errorMessage = "";
+		construct(std::move(in_toMove));
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> Result<TValue, TError, TErrorSuccess>& Result<TValue, TError, TErrorSuccess>::operator=(const Result<TValue, TError, TErrorSuccess>& in_toCopy) noexcept
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>& Result<TValue, TError, TErrorSuccess, TPolicy>::operator=(const Result<TValue, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept(k_isNothrowCopyAssignable)
 	{
-		m_value = in_toCopy.m_value;
-		m_error = in_toCopy.m_error;
-		m_errorMessage = in_toCopy.m_errorMessage;
-		m_causedBy = in_toCopy.m_causedBy->clone();
+		if (this == &in_toCopy)
+		{
+			return *this;
+		}
+
+		if constexpr (std::is_copy_assignable<TValue>::value)
+		{
+			if (wasSuccessful() && in_toCopy.wasSuccessful())
+			{
+				m_value = in_toCopy.m_value;
+				return *this;
+			}
+		}
+
+		if (in_toCopy.wasSuccessful())
+		{
+			TValue value(in_toCopy.m_value);
+			destroy();
+
+			m_error = in_toCopy.m_error;
+			m_errorStorage = in_toCopy.m_errorStorage;
+			new (&m_value) TValue(std::move(value));
+		}
+		else
+		{
+			destroy();
+
+			m_error = in_toCopy.m_error;
+			m_errorStorage = in_toCopy.m_errorStorage;
+			construct(in_toCopy);
+		}
 
 		return *this;
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> Result<TValue, TError, TErrorSuccess>& Result<TValue, TError, TErrorSuccess>::operator=(Result<TValue, TError, TErrorSuccess>&& in_toMove) noexcept
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>& Result<TValue, TError, TErrorSuccess, TPolicy>::operator=(Result<TValue, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept(k_isNothrowMoveAssignable)
 	{
-		m_value = in_toMove.m_value;
-		m_error = in_toMove.m_error;
-		m_errorMessage = in_toMove.m_errorMessage;
-		m_causedBy = std::move(in_toMove.m_causedBy);
+		if (this == &in_toMove)
+		{
+			return *this;
+		}
 
-		in_toMove.m_errorMessage = "";
+		if constexpr (std::is_move_assignable<TValue>::value)
+		{
+			if (wasSuccessful() && in_toMove.wasSuccessful())
+			{
+				m_value = std::move(in_toMove.m_value);
+				return *this;
+			}
+		}
+
+		if constexpr (!std::is_nothrow_move_constructible<TValue>::value)
+		{
+			// The value is moved out before this result is destroyed, so that if moving
+			// it throws this result is left unchanged.
+			if (in_toMove.wasSuccessful())
+			{
+				TValue value(std::move(in_toMove.m_value));
+				destroy();
+
+				m_error = in_toMove.m_error;
+				m_errorStorage = in_toMove.m_errorStorage;
+				new (&m_value) TValue(std::move(value));
+				return *this;
+			}
+		}
+
+		destroy();
+
+		m_error = in_toMove.m_error;
+		m_errorStorage = in_toMove.m_errorStorage;
+		construct(std::move(in_toMove));
 
 		return *this;
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> bool  Result<TValue, TError, TErrorSuccess>::wasSuccessful() const noexcept
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>::~Result() noexcept
+	{
+		destroy();
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> Result<TValue, TError, TErrorSuccess, TPolicy>::operator bool() const noexcept
+	{
+		return wasSuccessful();
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> bool  Result<TValue, TError, TErrorSuccess, TPolicy>::wasSuccessful() const noexcept
 	{
 		return m_error == TErrorSuccess;
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> const TValue&  Result<TValue, TError, TErrorSuccess>::getValue() const noexcept
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> const TValue&  Result<TValue, TError, TErrorSuccess, TPolicy>::getValue() const & noexcept
 	{
 		assert(wasSuccessful());
 
@@ -230,54 +846,122 @@ namespace IC
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> TError  Result<TValue, TError, TErrorSuccess>::getError() const noexcept
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> TValue  Result<TValue, TError, TErrorSuccess, TPolicy>::getValue() && noexcept(std::is_nothrow_move_constructible<TValue>::value)
+	{
+		assert(wasSuccessful());
+
+		return std::move(m_value);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> TError  Result<TValue, TError, TErrorSuccess, TPolicy>::getError() const noexcept
 	{
 		return m_error;
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> const std::string&  Result<TValue, TError, TErrorSuccess>::getErrorMessage() const noexcept
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> std::string_view  Result<TValue, TError, TErrorSuccess, TPolicy>::getErrorMessage() const noexcept
 	{
 		assert(!wasSuccessful());
 
-		return m_errorMessage;
+		return m_errorPayload.getErrorMessage(m_errorStorage, m_error);
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> std::string  Result<TValue, TError, TErrorSuccess>::getFullErrorMessage() const noexcept
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> std::string  Result<TValue, TError, TErrorSuccess, TPolicy>::getFullErrorMessage(ErrorMessageFormat in_format) const noexcept
 	{
 		assert(!wasSuccessful());
 
-		std::string errorMessage = m_errorMessage;
-		if (m_causedBy)
-		{
-			errorMessage += "\nCaused by:\n" + m_causedBy->getFullErrorMessage();
-		}
-		return errorMessage;
+		return m_errorPayload.getFullErrorMessage(m_errorStorage, m_error, in_format);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> template <typename TSink> void Result<TValue, TError, TErrorSuccess, TPolicy>::writeFullErrorMessage(TSink& io_sink, ErrorMessageFormat in_format) const noexcept
+	{
+		assert(!wasSuccessful());
+
+		m_errorPayload.writeFullErrorMessage(m_errorStorage, m_error, io_sink, in_format);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> const ErrorNode*  Result<TValue, TError, TErrorSuccess, TPolicy>::getCausedBy() const noexcept
+	{
+		assert(!wasSuccessful());
+
+		return m_errorPayload.getCausedBy(m_errorStorage);
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> const IResult*  Result<TValue, TError, TErrorSuccess>::getCausedBy() const noexcept
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> ErrorCauseRange  Result<TValue, TError, TErrorSuccess, TPolicy>::getCauses() const noexcept
 	{
 		assert(!wasSuccessful());
 
-		return m_causedBy.get();
+		return m_errorPayload.getCauses(m_errorStorage);
 	}
 
 	//-----------------------------------------------------------------------------
-	template <typename TValue, typename TError, TError TErrorSuccess> std::unique_ptr<const IResult>  Result<TValue, TError, TErrorSuccess>::cloneError() const noexcept
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> std::uint64_t  Result<TValue, TError, TErrorSuccess, TPolicy>::getFingerprint() const noexcept
 	{
 		assert(!wasSuccessful());
 
-		if (m_causedBy)
+		return m_errorPayload.getFingerprint(m_errorStorage, m_error);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> SourceLocation Result<TValue, TError, TErrorSuccess, TPolicy>::getSourceLocation() const noexcept
+	{
+		assert(!wasSuccessful());
+
+		return m_errorPayload.getSourceLocation(m_errorStorage);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> ErrorNodePtr  Result<TValue, TError, TErrorSuccess, TPolicy>::shareError() const noexcept
+	{
+		assert(!wasSuccessful());
+
+		return m_errorPayload.shareError(m_errorStorage, m_error);
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> void Result<TValue, TError, TErrorSuccess, TPolicy>::construct(const Result<TValue, TError, TErrorSuccess, TPolicy>& in_toCopy) noexcept(std::is_nothrow_copy_constructible<TValue>::value)
+	{
+		if (wasSuccessful())
+		{
+			new (&m_value) TValue(in_toCopy.m_value);
+		}
+		else
+		{
+			new (&m_errorPayload) ErrorPayload(m_errorStorage, in_toCopy.m_errorPayload);
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> void Result<TValue, TError, TErrorSuccess, TPolicy>::construct(Result<TValue, TError, TErrorSuccess, TPolicy>&& in_toMove) noexcept(std::is_nothrow_move_constructible<TValue>::value)
+	{
+		if (wasSuccessful())
+		{
+			new (&m_value) TValue(std::move(in_toMove.m_value));
+		}
+		else
+		{
+			new (&m_errorPayload) ErrorPayload(m_errorStorage, std::move(in_toMove.m_errorPayload), in_toMove.m_errorStorage);
+		}
+	}
+
+	//-----------------------------------------------------------------------------
+	template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> void Result<TValue, TError, TErrorSuccess, TPolicy>::destroy() noexcept
+	{
+		if (wasSuccessful())
 		{
-			return std::unique_ptr<const IResult>(new Result<void, TError, TErrorSuccess>(m_error, m_errorMessage, *m_causedBy));
+			m_value.~TValue();
 		}
 		else
 		{
-			return std::unique_ptr<const IResult>(new Result<void, TError, TErrorSuccess>(m_error, m_errorMessage));
+			m_errorPayload.destroy(m_errorStorage);
+			m_errorPayload.~ErrorPayload();
 		}
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
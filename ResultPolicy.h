@@ -0,0 +1,153 @@
+// ResultPolicy.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_RESULTPOLICY_H_
+#define _IC_RESULTPOLICY_H_
+
+#include "ErrorAllocator.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace IC
+{
+	/// A reference counting policy which is safe to use when error nodes are shared
+	/// between threads.
+	///
+	struct AtomicRefCount final
+	{
+		/// @param io_count - The reference count to increment.
+		///
+		static void increment(std::atomic<std::uint32_t>& io_count) noexcept
+		{
+			io_count.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/// @param io_count - The reference count to decrement.
+		///
+		/// @return Whether or not the last reference was removed.
+		///
+		static bool decrement(std::atomic<std::uint32_t>& io_count) noexcept
+		{
+			return io_count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+		}
+	};
+
+	/// A reference counting policy for errors which never leave the thread that created
+	/// them. The count is only ever loaded and stored, so no locked instructions are used.
+	///
+	struct NonAtomicRefCount final
+	{
+		/// @param io_count - The reference count to increment.
+		///
+		static void increment(std::atomic<std::uint32_t>& io_count) noexcept
+		{
+			io_count.store(io_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		/// @param io_count - The reference count to decrement.
+		///
+		/// @return Whether or not the last reference was removed.
+		///
+		static bool decrement(std::atomic<std::uint32_t>& io_count) noexcept
+		{
+			auto count = io_count.load(std::memory_order_relaxed) - 1;
+			io_count.store(count, std::memory_order_relaxed);
+			return count == 0;
+		}
+	};
+
+	/// The policy used by Result unless another is specified. Custom policies should
+	/// inherit from this and override the members they need to change, for example:
+	///
+	///     struct MyPolicy : IC::DefaultResultPolicy
+	///     {
+	///         using RefCount = IC::NonAtomicRefCount;
+	///     };
+	///
+	///     IC::Result<float, ErrorEnum, ErrorEnum::k_success, MyPolicy> tryGetValue();
+	///
+	struct DefaultResultPolicy
+	{
+		/// The reference counting used by the shared, immutable error nodes which store
+		/// the message and cause of a failed result.
+		///
+		using RefCount = AtomicRefCount;
+
+		/// The allocator used for error nodes. See GlobalErrorAllocator for the
+		/// requirements of an allocator.
+		///
+		using Allocator = PoolErrorAllocator;
+
+		/// The number of bytes of message which a failed result can store inline, rather
+		/// than in an error node. Messages up to this length, for failures which have no
+		/// cause, make no allocation at all. This increases the size of every result with
+		/// this policy, so is disabled by default. The maximum is 255.
+		///
+		static constexpr std::size_t k_inlineMessageCapacity = 0;
+
+		/// Whether or not failed results record the file, line and function which created
+		/// them, and a sampled backtrace. See setErrorBacktraceSampleRate(). The location
+		/// is stored in the error node, so with this enabled every failure allocates a
+		/// node, including those with static, catalog or short messages, and inline
+		/// messages are disabled. Only pointers to static strings are stored, so this
+		/// makes no additional allocation. This is disabled by default.
+		///
+		static constexpr bool k_captureSourceLocation = false;
+	};
+
+	/// A policy which stores messages of up to the given number of bytes inline in the
+	/// result. See DefaultResultPolicy::k_inlineMessageCapacity.
+	///
+	template <std::size_t TCapacity> struct InlineMessageResultPolicy : DefaultResultPolicy
+	{
+		static constexpr std::size_t k_inlineMessageCapacity = TCapacity;
+	};
+
+	/// A policy for results which record where each failure was created. See
+	/// DefaultResultPolicy::k_captureSourceLocation.
+	///
+	struct DiagnosticResultPolicy : DefaultResultPolicy
+	{
+		static constexpr bool k_captureSourceLocation = true;
+	};
+
+	/// A policy for results which are never shared between threads.
+	///
+	struct SingleThreadedResultPolicy : DefaultResultPolicy
+	{
+		using RefCount = NonAtomicRefCount;
+	};
+
+	/// A policy for results whose error nodes are allocated from the current ErrorArena
+	/// of the calling thread, and released in bulk when the arena is reset.
+	///
+	struct ArenaResultPolicy : DefaultResultPolicy
+	{
+		using Allocator = ArenaErrorAllocator;
+	};
+}
+
+#endif
@@ -0,0 +1,285 @@
+// ThreadPool.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_THREADPOOL_H_
+#define _IC_THREADPOOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace IC
+{
+	/// A pool of worker threads which run chunks of a range in parallel, used by
+	/// traverse(). Each worker has its own queue; a worker takes chunks from the front
+	/// of its own queue, so a range is processed roughly in order, and when its queue
+	/// is empty it steals from the back of another's. The thread which starts the work
+	/// also takes part, so a pool can be used from within one of its own workers.
+	///
+	class ThreadPool final
+	{
+	public:
+		/// @return The number of workers used by default: one fewer than the number of
+		/// hardware threads, as the calling thread also takes part, but at least one.
+		///
+		static std::size_t getDefaultThreadCount() noexcept
+		{
+			auto hardwareThreads = static_cast<std::size_t>(std::thread::hardware_concurrency());
+			return hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		/// @param in_threadCount - The number of worker threads to create.
+		///
+		explicit ThreadPool(std::size_t in_threadCount = getDefaultThreadCount()) noexcept
+		{
+			in_threadCount = std::max<std::size_t>(1, in_threadCount);
+			for (std::size_t thread = 0; thread < in_threadCount; ++thread)
+			{
+				m_queues.push_back(std::make_unique<Queue>());
+			}
+
+			for (std::size_t thread = 0; thread < in_threadCount; ++thread)
+			{
+				m_threads.emplace_back([this, thread]()
+				{
+					runWorker(thread);
+				});
+			}
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/// Waits for the workers to finish their current chunk and stops them. No work
+		/// may be running when the pool is destroyed.
+		///
+		~ThreadPool() noexcept
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_sleepMutex);
+				m_stopping = true;
+			}
+			m_sleepCondition.notify_all();
+
+			for (auto& thread : m_threads)
+			{
+				thread.join();
+			}
+		}
+
+		/// @return The number of worker threads.
+		///
+		std::size_t getThreadCount() const noexcept
+		{
+			return m_threads.size();
+		}
+
+		/// Calls the function for consecutive chunks of the range [0, in_count), each of
+		/// at most in_grainSize elements, on the workers and the calling thread, returning
+		/// once every chunk has completed.
+		///
+		/// @param in_count - The number of elements in the range.
+		/// @param in_grainSize - The maximum number of elements in each chunk.
+		/// @param in_function - The function to call with the beginning and end of each
+		/// chunk. This is called concurrently.
+		///
+		template <typename TFunction> void parallelFor(std::size_t in_count, std::size_t in_grainSize, TFunction& in_function) noexcept
+		{
+			if (in_count == 0)
+			{
+				return;
+			}
+
+			in_grainSize = std::max<std::size_t>(1, in_grainSize);
+			auto chunkCount = (in_count + in_grainSize - 1) / in_grainSize;
+
+			TaskGroup group;
+			group.m_remaining = chunkCount;
+
+			{
+				std::lock_guard<std::mutex> lock(m_sleepMutex);
+				m_queuedTasks += chunkCount;
+			}
+
+			for (std::size_t chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				auto begin = chunk * in_grainSize;
+				auto end = std::min(begin + in_grainSize, in_count);
+				Task task = { &runChunk<TFunction>, &in_function, begin, end, &group };
+
+				// Consecutive chunks are given to each worker in turn, so every worker
+				// starts at the beginning of the range.
+				auto& queue = *m_queues[chunk % m_queues.size()];
+				std::lock_guard<std::mutex> lock(queue.m_mutex);
+				queue.m_tasks.push_back(task);
+			}
+
+			m_sleepCondition.notify_all();
+
+			Task task;
+			while (group.m_remaining.load(std::memory_order_acquire) != 0)
+			{
+				if (stealTask(0, task))
+				{
+					runTask(task);
+				}
+				else
+				{
+					std::unique_lock<std::mutex> lock(group.m_mutex);
+					group.m_condition.wait(lock, [&group]()
+					{
+						return group.m_remaining.load(std::memory_order_acquire) == 0;
+					});
+				}
+			}
+
+			// The last task notifies while holding the lock, so taking it here ensures
+			// that it has finished with the group before the group is destroyed.
+			std::lock_guard<std::mutex> lock(group.m_mutex);
+		}
+
+	private:
+		/// Tracks the completion of the chunks started by a single call to parallelFor().
+		///
+		struct TaskGroup final
+		{
+			std::atomic<std::size_t> m_remaining{0};
+			std::mutex m_mutex;
+			std::condition_variable m_condition;
+		};
+
+		/// A single chunk of a range.
+		///
+		struct Task final
+		{
+			void (*m_run)(void* in_function, std::size_t in_begin, std::size_t in_end) noexcept;
+			void* m_function;
+			std::size_t m_begin;
+			std::size_t m_end;
+			TaskGroup* m_group;
+		};
+
+		/// The queue of a single worker, padded to its own cache line.
+		///
+		struct alignas(64) Queue final
+		{
+			std::mutex m_mutex;
+			std::deque<Task> m_tasks;
+		};
+
+		//-----------------------------------------------------------------------------
+		template <typename TFunction> static void runChunk(void* in_function, std::size_t in_begin, std::size_t in_end) noexcept
+		{
+			(*static_cast<TFunction*>(in_function))(in_begin, in_end);
+		}
+
+		//-----------------------------------------------------------------------------
+		static void runTask(const Task& in_task) noexcept
+		{
+			in_task.m_run(in_task.m_function, in_task.m_begin, in_task.m_end);
+
+			auto& group = *in_task.m_group;
+			std::lock_guard<std::mutex> lock(group.m_mutex);
+			if (group.m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				group.m_condition.notify_all();
+			}
+		}
+
+		/// Takes a task from the front of the given worker's queue or, if it's empty,
+		/// from the back of another worker's.
+		///
+		/// @param in_worker - The index of the worker.
+		/// @param out_task - The task which was taken.
+		///
+		/// @return Whether or not a task was taken.
+		///
+		bool stealTask(std::size_t in_worker, Task& out_task) noexcept
+		{
+			for (std::size_t offset = 0; offset < m_queues.size(); ++offset)
+			{
+				auto& queue = *m_queues[(in_worker + offset) % m_queues.size()];
+				std::lock_guard<std::mutex> lock(queue.m_mutex);
+				if (!queue.m_tasks.empty())
+				{
+					if (offset == 0)
+					{
+						out_task = queue.m_tasks.front();
+						queue.m_tasks.pop_front();
+					}
+					else
+					{
+						out_task = queue.m_tasks.back();
+						queue.m_tasks.pop_back();
+					}
+
+					m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		//-----------------------------------------------------------------------------
+		void runWorker(std::size_t in_worker) noexcept
+		{
+			Task task;
+			while (true)
+			{
+				if (stealTask(in_worker, task))
+				{
+					runTask(task);
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(m_sleepMutex);
+				m_sleepCondition.wait(lock, [this]()
+				{
+					return m_stopping || m_queuedTasks.load(std::memory_order_relaxed) != 0;
+				});
+
+				if (m_stopping)
+				{
+					return;
+				}
+			}
+		}
+
+		std::vector<std::unique_ptr<Queue>> m_queues;
+		std::vector<std::thread> m_threads;
+		std::mutex m_sleepMutex;
+		std::condition_variable m_sleepCondition;
+		std::atomic<std::size_t> m_queuedTasks{0};
+		bool m_stopping = false;
+	};
+}
+
+#endif
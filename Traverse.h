@@ -0,0 +1,308 @@
+// Traverse.h
+//
+// The MIT License(MIT)
+// 
+// Copyright(c) 2015 Ian Copland
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _IC_TRAVERSE_H_
+#define _IC_TRAVERSE_H_
+
+#include "Result.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace IC
+{
+	/// Describes how traverse() handles failures.
+	///
+	enum class TraverseMode
+	{
+		/// Cancel the remaining items after the first failure, and return it.
+		///
+		k_firstError,
+
+		/// Run every item, and return a failure describing every item which failed.
+		///
+		k_allErrors
+	};
+
+	/// Allows a function run by traverse() to check whether another item has failed,
+	/// so that long running items can stop early.
+	///
+	class CancellationToken final
+	{
+	public:
+		/// @param in_cancelled - The flag which is set when the work is cancelled.
+		///
+		explicit CancellationToken(const std::atomic<bool>& in_cancelled) noexcept
+			: m_cancelled(in_cancelled)
+		{
+		}
+
+		/// @return Whether or not the work has been cancelled.
+		///
+		bool isCancelled() const noexcept
+		{
+			return m_cancelled.load(std::memory_order_relaxed);
+		}
+
+	private:
+		const std::atomic<bool>& m_cancelled;
+	};
+
+	namespace Detail
+	{
+		/// Provides the template parameters of a Result type.
+		///
+		template <typename TResult> struct ResultTraits;
+
+		//-----------------------------------------------------------------------------
+		template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> struct ResultTraits<Result<TValue, TError, TErrorSuccess, TPolicy>>
+		{
+			using Value = TValue;
+			using Values = std::vector<std::optional<TValue>>;
+			using Error = Result<void, TError, TErrorSuccess, TPolicy>;
+			using Collected = Result<std::vector<TValue>, TError, TErrorSuccess, TPolicy>;
+		};
+
+		/// References can't be stored in a std::vector or std::optional, so they are
+		/// collected as std::reference_wrapper instead.
+		///
+		template <typename TValue, typename TError, TError TErrorSuccess, typename TPolicy> struct ResultTraits<Result<TValue&, TError, TErrorSuccess, TPolicy>>
+		{
+			using Value = std::reference_wrapper<TValue>;
+			using Values = std::vector<std::optional<std::reference_wrapper<TValue>>>;
+			using Error = Result<void, TError, TErrorSuccess, TPolicy>;
+			using Collected = Result<std::vector<std::reference_wrapper<TValue>>, TError, TErrorSuccess, TPolicy>;
+		};
+
+		/// Functions which return no value only need their failures collected, so nothing
+		/// is stored for each item.
+		///
+		template <typename TError, TError TErrorSuccess, typename TPolicy> struct ResultTraits<Result<void, TError, TErrorSuccess, TPolicy>>
+		{
+			using Value = void;
+			using Values = std::nullptr_t;
+			using Error = Result<void, TError, TErrorSuccess, TPolicy>;
+			using Collected = Result<void, TError, TErrorSuccess, TPolicy>;
+		};
+
+		/// The number of chunks traverse() splits a range into for each thread, when no
+		/// grain size is given. Several chunks per thread allow threads which finish early
+		/// to steal work from the others when items take uneven amounts of time, while
+		/// keeping the number of tasks, and so the scheduling overhead, small.
+		///
+		constexpr std::size_t k_traverseChunksPerThread = 8;
+
+		/// Calls the function for an item, passing the cancellation token if the function
+		/// accepts one.
+		///
+		template <typename TFunction, typename TItem> decltype(auto) invokeTraverseFunction(TFunction& in_function, TItem&& in_item, const CancellationToken& in_token) noexcept
+		{
+			if constexpr (std::is_invocable<TFunction&, TItem, const CancellationToken&>::value)
+			{
+				return in_function(std::forward<TItem>(in_item), in_token);
+			}
+			else
+			{
+				return in_function(std::forward<TItem>(in_item));
+			}
+		}
+
+		/// @return The type of Result returned by the function for an item.
+		///
+		template <typename TFunction, typename TItem> using TraverseResult = typename std::decay<decltype(invokeTraverseFunction(std::declval<TFunction&>(), std::declval<TItem>(), std::declval<const CancellationToken&>()))>::type;
+	}
+
+	/// Runs a function which returns a Result for every item in a range, in parallel on
+	/// the given pool, and collects the values in order. For example:
+	///
+	///     IC::Result<std::vector<Image>, LoadError> images = IC::traverse(pool, paths.begin(), paths.end(), [](const std::string& in_path)
+	///     {
+	///         return tryLoadImage(in_path);
+	///     });
+	///
+	/// In k_firstError mode, the first failure to occur cancels the traversal: items
+	/// which haven't started are skipped, and the function may also accept a
+	/// CancellationToken as a second argument to stop items which are in progress. The
+	/// failure is returned as is.
+	///
+	/// In k_allErrors mode every item is run, and a failure with the error of the first
+	/// failed item is returned. It has one cause for each failed item, in order, which
+	/// gives the index of the item and is caused by the item's own failure, so every
+	/// failure keeps its own causes. See ErrorCauses.
+	///
+	/// If the function returns a reference, the values are collected as
+	/// std::reference_wrapper. If it returns no value, such as when validating each
+	/// item, only the failures are collected and the result also has no value.
+	///
+	/// The range is split into chunks of consecutive items, each run as one task.
+	/// Cancellation is checked before every item, so the size of the chunks only affects
+	/// load balancing and scheduling overhead. By default there are
+	/// k_traverseChunksPerThread chunks for each thread, including the calling thread,
+	/// which suits items of similar cost. If the cost of items varies greatly, a smaller
+	/// grain size can be given.
+	///
+	/// @param io_pool - The pool to run the function on.
+	/// @param in_first - The beginning of the range of items. This must be a random
+	/// access iterator.
+	/// @param in_last - The end of the range of items.
+	/// @param in_function - The function to run for each item. This is called
+	/// concurrently.
+	/// @param in_mode - How failures should be handled.
+	/// @param in_grainSize - The maximum number of items in each chunk, or 0 to choose
+	/// it from the number of threads.
+	///
+	/// @return The values of every item, or the failure.
+	///
+	template <typename TIterator, typename TFunction> auto traverse(ThreadPool& io_pool, TIterator in_first, TIterator in_last, TFunction&& in_function, TraverseMode in_mode = TraverseMode::k_firstError, std::size_t in_grainSize = 0) noexcept
+		-> typename Detail::ResultTraits<Detail::TraverseResult<TFunction, decltype(*in_first)>>::Collected
+	{
+		static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<TIterator>::iterator_category>::value, "traverse() requires random access iterators.");
+
+		using Traits = Detail::ResultTraits<Detail::TraverseResult<TFunction, decltype(*in_first)>>;
+		using Value = typename Traits::Value;
+		using Error = typename Traits::Error;
+		using Collected = typename Traits::Collected;
+
+		auto count = static_cast<std::size_t>(in_last - in_first);
+		typename Traits::Values values{};
+		if constexpr (!std::is_void<Value>::value)
+		{
+			values.resize(count);
+		}
+
+		std::atomic<bool> cancelled(false);
+		CancellationToken token(cancelled);
+		std::mutex failureMutex;
+		std::vector<std::pair<std::size_t, Error>> failures;
+
+		auto runChunk = [&](std::size_t in_begin, std::size_t in_end) noexcept
+		{
+			for (auto index = in_begin; index < in_end; ++index)
+			{
+				if (cancelled.load(std::memory_order_relaxed))
+				{
+					return;
+				}
+
+				auto result = Detail::invokeTraverseFunction(in_function, in_first[index], token);
+				if (result)
+				{
+					if constexpr (!std::is_void<Value>::value)
+					{
+						values[index].emplace(std::move(result).getValue());
+					}
+				}
+				else if (in_mode == TraverseMode::k_allErrors)
+				{
+					std::lock_guard<std::mutex> lock(failureMutex);
+					failures.emplace_back(index, Error(result));
+				}
+				else if (!cancelled.exchange(true, std::memory_order_relaxed))
+				{
+					std::lock_guard<std::mutex> lock(failureMutex);
+					failures.emplace_back(index, Error(result));
+				}
+			}
+		};
+
+		auto grainSize = in_grainSize > 0 ? in_grainSize : std::max<std::size_t>(1, count / ((io_pool.getThreadCount() + 1) * Detail::k_traverseChunksPerThread));
+		io_pool.parallelFor(count, grainSize, runChunk);
+
+		if (failures.empty())
+		{
+			if constexpr (std::is_void<Value>::value)
+			{
+				return Collected();
+			}
+			else
+			{
+				std::vector<Value> collected;
+				collected.reserve(count);
+				for (auto& value : values)
+				{
+					collected.push_back(std::move(*value));
+				}
+				return Collected(std::move(collected));
+			}
+		}
+
+		if (in_mode == TraverseMode::k_firstError)
+		{
+			return Collected(failures.front().second);
+		}
+
+		// The failures are recorded in the order they occurred, so they're put in item
+		// order through a permutation rather than by moving the results around.
+		std::vector<std::size_t> order(failures.size());
+		for (std::size_t position = 0; position < order.size(); ++position)
+		{
+			order[position] = position;
+		}
+		std::sort(order.begin(), order.end(), [&failures](std::size_t in_a, std::size_t in_b)
+		{
+			return failures[in_a].first < failures[in_b].first;
+		});
+
+		ErrorCauses causes;
+		causes.reserve(failures.size());
+		for (auto position : order)
+		{
+			auto& failure = failures[position];
+			causes.add(Error(failure.second.getError(), deferMessage("Item {} failed.", failure.first), failure.second));
+		}
+
+		return Collected(failures[order.front()].second.getError(), deferMessage("{} of {} items failed.", failures.size(), count), causes);
+	}
+
+	/// Runs a function which returns a Result for every item in a container, in
+	/// parallel on the given pool, and collects the values in order. See the iterator
+	/// overload.
+	///
+	/// @param io_pool - The pool to run the function on.
+	/// @param in_items - The items. The container must provide random access iterators.
+	/// @param in_function - The function to run for each item. This is called
+	/// concurrently.
+	/// @param in_mode - How failures should be handled.
+	/// @param in_grainSize - The maximum number of items in each chunk, or 0 to choose
+	/// it from the number of threads.
+	///
+	/// @return The values of every item, or the failure.
+	///
+	template <typename TContainer, typename TFunction> auto traverse(ThreadPool& io_pool, const TContainer& in_items, TFunction&& in_function, TraverseMode in_mode = TraverseMode::k_firstError, std::size_t in_grainSize = 0) noexcept
+	{
+		return traverse(io_pool, std::begin(in_items), std::end(in_items), std::forward<TFunction>(in_function), in_mode, in_grainSize);
+	}
+}
+
+#endif